@@ -0,0 +1,610 @@
+#ifndef BLOCK_MINIMIZER_HPP
+#define BLOCK_MINIMIZER_HPP
+
+#include "digest/digester.hpp"
+#include "digest/mod_minimizer.hpp"
+#include "digest/window_minimizer.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace digest {
+
+/**
+ * @brief Child class of Digester that finds the same minimizers as
+ * WindowMin<P, ds::Adaptive, K>, a block of k-mers at a time instead of one
+ * k-mer at a time. The hashes of a block are produced with roll_hashes(), then
+ * the minimum of every large window in the block is found with the van Herk /
+ * Gil-Werman algorithm: the block is cut into runs of large_window k-mers, and
+ * the minimum of a large window is the smaller of the suffix minimum of the
+ * run it starts in and the prefix minimum of the run it ends in. That is 3
+ * comparisons per k-mer without branches, no matter the large window size or
+ * the order of the hashes. Parameters without a description are the same as
+ * the parameters in the Digester parent class. They are simply passed up to
+ * the parent constructor.
+ *
+ * Like ds::Adaptive, it compares the lower 32 bits of the hashes, and the
+ * rightmost index wins in ties. Since a whole block is hashed before its
+ * minimizers are passed on, get_pos() and get_is_valid_hash() are up to BLOCK
+ * k-mers ahead of the last minimizer returned.
+ *
+ * @tparam P
+ * @tparam K
+ */
+template <BadCharPolicy P, unsigned K = 0>
+class BlockWindowMin : public Digester<P, K> {
+  public:
+	/**
+	 * @brief number of k-mers hashed at a time
+	 */
+	static constexpr size_t BLOCK = 4096;
+
+	/**
+	 * @param seq
+	 * @param len
+	 * @param k
+	 * @param large_window the number of kmers in the large window, i.e. the
+	 * number of kmers to be considered during the range minimum query.
+	 * @param start
+	 * @param minimized_h
+	 *
+	 * @throws BadWindowException thrown when large_window is passed in as 0
+	 */
+	BlockWindowMin(const char *seq, size_t len, unsigned k,
+				   unsigned large_window, size_t start = 0,
+				   MinimizedHashType minimized_h = MinimizedHashType::CANON)
+		: Digester<P, K>(seq, len, k, start, minimized_h),
+		  large_window(large_window) {
+		init();
+	}
+
+	/**
+	 * @param seq
+	 * @param k
+	 * @param large_window the number of kmers in the large window, i.e. the
+	 * number of kmers to be considered during the range minimum query.
+	 * @param start
+	 * @param minimized_h
+	 *
+	 * @throws BadWindowException thrown when large_window is passed in as 0
+	 */
+	BlockWindowMin(const std::string &seq, unsigned k, unsigned large_window,
+				   size_t start = 0,
+				   MinimizedHashType minimized_h = MinimizedHashType::CANON)
+		: BlockWindowMin<P, K>(seq.c_str(), seq.size(), k, large_window, start,
+							   minimized_h) {}
+
+	/**
+	 * @param packed
+	 * @param len
+	 * @param n_intervals
+	 * @param k
+	 * @param large_window the number of kmers in the large window, i.e. the
+	 * number of kmers to be considered during the range minimum query.
+	 * @param start
+	 * @param minimized_h
+	 *
+	 * @throws BadWindowException thrown when large_window is passed in as 0
+	 */
+	BlockWindowMin(const uint8_t *packed, size_t len,
+				   const NIntervals &n_intervals, unsigned k,
+				   unsigned large_window, size_t start = 0,
+				   MinimizedHashType minimized_h = MinimizedHashType::CANON)
+		: Digester<P, K>(packed, len, n_intervals, k, start, minimized_h),
+		  large_window(large_window) {
+		init();
+	}
+
+	/**
+	 * @brief adds up to amount of positions of minimizers into vec. Here a
+	 * k-mer is considered a minimizer if its hash is the smallest in the large
+	 * window. Rightmost index wins in ties
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void roll_minimizer(unsigned amount, std::vector<uint32_t> &vec) override {
+		auto sink = [&vec](uint32_t pos) { vec.emplace_back(pos); };
+		roll_block(amount, sink);
+	}
+
+	/**
+	 * @brief adds up to amount of positions and hashes of minimizers into vec.
+	 * Here a k-mer is considered a minimizer if its hash is the smallest in the
+	 * large window. Rightmost index wins in ties
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void
+	roll_minimizer(unsigned amount,
+				   std::vector<std::pair<uint32_t, uint32_t>> &vec) override {
+		auto sink = [&vec](uint32_t pos, uint32_t hash) {
+			vec.emplace_back(pos, hash);
+		};
+		roll_block(amount, sink);
+	}
+
+	/**
+	 * @brief adds up to amount of positions of minimizers into vec, without
+	 * truncating them to 32 bits. Here a k-mer is considered a minimizer if
+	 * its hash is the smallest in the large window. Rightmost index wins in
+	 * ties
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void roll_minimizer(unsigned amount, std::vector<uint64_t> &vec) override {
+		auto sink = [&vec](uint64_t pos) { vec.emplace_back(pos); };
+		roll_block(amount, sink);
+	}
+
+	/**
+	 * @brief adds up to amount of positions and hashes of minimizers into vec,
+	 * without truncating the positions to 32 bits. The hashes are the 32 bits
+	 * that were compared. Here a k-mer is considered a minimizer if its hash
+	 * is the smallest in the large window. Rightmost index wins in ties
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void
+	roll_minimizer(unsigned amount,
+				   std::vector<std::pair<uint64_t, uint64_t>> &vec) override {
+		auto sink = [&vec](uint64_t pos, uint64_t hash) {
+			vec.emplace_back(pos, hash);
+		};
+		roll_block(amount, sink);
+	}
+
+	/**
+	 * @brief passes up to amount minimizers, the same ones the other
+	 * roll_minimizer functions would add to a vector, to sink, so they can go
+	 * straight into an index or a stream without being stored first. sink is
+	 * called as sink(position) if it accepts that, and as sink(position, hash)
+	 * otherwise. The position is a size_t, and the hash is the uint32_t that
+	 * was compared. If it returns bool, returning false stops rolling after
+	 * that minimizer, e.g. when a fixed size buffer is full, and the next call
+	 * continues from there.
+	 *
+	 * @param amount
+	 * @param sink
+	 *
+	 * @return size_t, the number of minimizers passed to sink
+	 */
+	template <class Sink> size_t roll_minimizer(unsigned amount, Sink &&sink) {
+		return roll_block(amount, sink);
+	}
+
+	void new_seq(const char *seq, size_t len, size_t start) override {
+		reset();
+		Digester<P, K>::new_seq(seq, len, start);
+	}
+
+	void new_seq(const std::string &seq, size_t pos) override {
+		reset();
+		Digester<P, K>::new_seq(seq.c_str(), seq.size(), pos);
+	}
+
+	void new_seq(const uint8_t *packed, size_t len,
+				 const NIntervals &n_intervals, size_t start) override {
+		reset();
+		Digester<P, K>::new_seq(packed, len, n_intervals, start);
+	}
+
+	/**
+	 *
+	 * @return unsigned, the value of large_window
+	 */
+	unsigned get_large_wind_kmer_am() { return large_window; }
+
+  private:
+	uint32_t large_window;
+
+	// (uint64_t)~hash << 32 | index of the k-mers of the current block,
+	// after the last large_window - 1 k-mers of the previous one, so the
+	// maximum is the minimal hash with the rightmost index, like in ds
+	std::vector<uint64_t> keys;
+
+	// maxima of keys from the start of its run, then, from large_window - 1
+	// on, the maximum of the large window ending there
+	std::vector<uint64_t> prefix;
+
+	// maxima of keys up to the end of its run
+	std::vector<uint64_t> suffix;
+
+	// output of roll_hashes() for the current block
+	std::vector<uint64_t> hashes;
+	std::vector<uint32_t> positions;
+
+	// number of keys in the current block, and the last k-mer of the next
+	// large window to check
+	size_t filled = 0, next = 0;
+
+	// position of the first k-mer hashed for the current block, restores the
+	// bits of the positions that were cut off at 32 bits
+	size_t block_pos = 0;
+
+	// whether a minimizer was found yet, and the index of the last one, the
+	// lower 32 bits like the indices of ds::Adaptive
+	bool is_minimized = false;
+	uint32_t prev_mini = 0;
+
+	void init() {
+		if (large_window == 0) {
+			throw BadWindowSizeException();
+		}
+		keys.resize(large_window - 1 + BLOCK);
+		prefix.resize(keys.size());
+		suffix.resize(keys.size());
+		hashes.resize(BLOCK);
+		positions.resize(BLOCK);
+		reset();
+	}
+
+	void reset() {
+		filled = 0;
+		next = large_window - 1;
+		is_minimized = false;
+	}
+
+	/**
+	 * @brief hashes the next block after the last large_window - 1 k-mers of
+	 * the current one, and finds the minimum of every large window ending in
+	 * it
+	 *
+	 * @return bool, false if there were no k-mers left to hash
+	 */
+	bool refill() {
+		if (!this->is_valid_hash) {
+			return false;
+		}
+		size_t carry = std::min(filled, (size_t)large_window - 1);
+		std::copy(keys.begin() + (filled - carry), keys.begin() + filled,
+				  keys.begin());
+		block_pos = this->get_pos();
+		size_t n = this->roll_hashes(BLOCK, hashes.data(), positions.data());
+		for (size_t i = 0; i < n; i++) {
+			keys[carry + i] =
+				(uint64_t)~(uint32_t)hashes[i] << 32 | positions[i];
+		}
+		filled = carry + n;
+		next = large_window - 1;
+
+		for (size_t run = 0; run < filled; run += large_window) {
+			size_t end = std::min(run + large_window, filled);
+			prefix[run] = keys[run];
+			for (size_t i = run + 1; i < end; i++) {
+				prefix[i] = std::max(prefix[i - 1], keys[i]);
+			}
+			suffix[end - 1] = keys[end - 1];
+			for (size_t i = end - 1; i-- > run;) {
+				suffix[i] = std::max(suffix[i + 1], keys[i]);
+			}
+		}
+		// a large window either is a whole run, or starts in one run and
+		// ends in the next
+		for (size_t i = large_window - 1; i < filled; i++) {
+			prefix[i] = std::max(suffix[i + 1 - large_window], prefix[i]);
+		}
+		return n > 0;
+	}
+
+	template <class Sink> size_t roll_block(unsigned amount, Sink &sink) {
+		size_t n = 0;
+		bool more = true;
+		while (n < amount and more) {
+			if (next >= filled and !refill()) {
+				break;
+			}
+			for (; next < filled and n < amount and more; next++) {
+				uint64_t key = prefix[next];
+				// a minimizer is only a new minimizer if it is different
+				// from the previous one
+				if (is_minimized and (uint32_t)key == prev_mini) {
+					continue;
+				}
+				is_minimized = true;
+				prev_mini = key;
+				n++;
+
+				// restore the bits of the index cut off at 32 bits, like
+				// WindowMin::widen(), from the last k-mer of the large window
+				size_t pos = block_pos + (uint32_t)((uint32_t)keys[next] -
+													(uint32_t)block_pos);
+				pos -= (uint32_t)((uint32_t)pos - prev_mini);
+				more = this->emit(sink, pos,
+								  [key] { return ~(uint32_t)(key >> 32); });
+			}
+		}
+		return n;
+	}
+};
+
+/**
+ * @brief Child class of Digester that finds the same minimizers as
+ * ModMin<P, K>, a block of k-mers at a time instead of one k-mer at a time.
+ * The hashes of a block are produced with roll_hashes(), then the k-mers whose
+ * hash is congruent to congruence are packed into a buffer with
+ * select_congruent(), which tests a vector of hashes at a time with AVX-512 or
+ * AVX2 if the CPU supports them. The minimizers are then passed on from the
+ * buffer, so there is no branch per k-mer on whether it is a minimizer,
+ * which is taken about once every mod k-mers and hard to predict. Parameters
+ * without a description are the same as the parameters in the Digester
+ * parent class. They are simply passed up to the parent constructor.
+ *
+ * Since a whole block is hashed before its minimizers are passed on,
+ * get_pos() and get_is_valid_hash() are up to BLOCK k-mers ahead of the last
+ * minimizer returned.
+ *
+ * As with ModMin, the amount given to the vector versions of
+ * roll_minimizer() is the size the vector may reach, counting what is already
+ * in it, and the amount given with a sink counts the minimizers of that call.
+ * A vector that is already full is left as it is, where ModMin still rolls
+ * one k-mer and adds it if it is a minimizer.
+ *
+ * @tparam P
+ * @tparam K
+ */
+template <BadCharPolicy P, unsigned K = 0>
+class BlockModMin : public Digester<P, K> {
+  public:
+	/**
+	 * @brief number of k-mers hashed at a time
+	 */
+	static constexpr size_t BLOCK = 4096;
+
+	/**
+	 * @param seq
+	 * @param len
+	 * @param k
+	 * @param mod mod space to be used to calculate universal minimizers
+	 * @param congruence value we want minimizer hashes to be congruent to in
+	 * the mod space
+	 * @param start
+	 * @param minimized_h
+	 *
+	 * @throws BadModException Thrown when congruence is greater or equal to mod
+	 */
+	BlockModMin(const char *seq, size_t len, unsigned k, uint32_t mod,
+				uint32_t congruence = 0, size_t start = 0,
+				MinimizedHashType minimized_h = MinimizedHashType::CANON)
+		: Digester<P, K>(seq, len, k, start, minimized_h), mod(mod),
+		  congruence(congruence), test(mod, congruence) {
+		init();
+	}
+
+	/**
+	 * @param seq
+	 * @param k
+	 * @param mod mod space to be used to calculate universal minimizers
+	 * @param congruence value we want minimizer hashes to be congruent to in
+	 * the mod space
+	 * @param start
+	 * @param minimized_h
+	 *
+	 * @throws BadModException Thrown when congruence is greater or equal to mod
+	 */
+	BlockModMin(const std::string &seq, unsigned k, uint32_t mod,
+				uint32_t congruence = 0, size_t start = 0,
+				MinimizedHashType minimized_h = MinimizedHashType::CANON)
+		: BlockModMin<P, K>(seq.c_str(), seq.size(), k, mod, congruence, start,
+							minimized_h) {}
+
+	/**
+	 * @param packed
+	 * @param len
+	 * @param n_intervals
+	 * @param k
+	 * @param mod mod space to be used to calculate universal minimizers
+	 * @param congruence value we want minimizer hashes to be congruent to in
+	 * the mod space
+	 * @param start
+	 * @param minimized_h
+	 *
+	 * @throws BadModException Thrown when congruence is greater or equal to mod
+	 */
+	BlockModMin(const uint8_t *packed, size_t len,
+				const NIntervals &n_intervals, unsigned k, uint32_t mod,
+				uint32_t congruence = 0, size_t start = 0,
+				MinimizedHashType minimized_h = MinimizedHashType::CANON)
+		: Digester<P, K>(packed, len, n_intervals, k, start, minimized_h),
+		  mod(mod), congruence(congruence), test(mod, congruence) {
+		init();
+	}
+
+	/**
+	 * @brief adds up to amount of positions of minimizers into vec. Here a
+	 * k-mer is considered a minimizer if its hash is congruent to congruence in
+	 * the mod space. The positions are copied from the buffer in bulk.
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void roll_minimizer(unsigned amount, std::vector<uint32_t> &vec) override {
+		while (vec.size() < amount) {
+			if (next >= selected and !refill()) {
+				break;
+			}
+			size_t take = std::min(selected - next, amount - vec.size());
+			vec.insert(vec.end(), out_pos.begin() + next,
+					   out_pos.begin() + next + take);
+			next += take;
+		}
+	}
+
+	/**
+	 * @brief adds up to amount of positions and hashes of minimizers into vec.
+	 * Here a k-mer is considered a minimizer if its hash is congruent to
+	 * congruence in the mod space.
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void
+	roll_minimizer(unsigned amount,
+				   std::vector<std::pair<uint32_t, uint32_t>> &vec) override {
+		auto sink = [&vec](uint32_t pos, uint32_t hash) {
+			vec.emplace_back(pos, hash);
+		};
+		roll_block(room(amount, vec), sink);
+	}
+
+	/**
+	 * @brief adds up to amount of positions of minimizers into vec, without
+	 * truncating them to 32 bits. Here a k-mer is considered a minimizer if
+	 * its hash is congruent to congruence in the mod space.
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void roll_minimizer(unsigned amount, std::vector<uint64_t> &vec) override {
+		auto sink = [&vec](uint64_t pos) { vec.emplace_back(pos); };
+		roll_block(room(amount, vec), sink);
+	}
+
+	/**
+	 * @brief adds up to amount of positions and hashes of minimizers into vec.
+	 * Neither is truncated to 32 bits, the hash is the full 64-bit hash of the
+	 * k-mer, while the congruence is still checked on its lower 32 bits, like
+	 * ModMin.
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void
+	roll_minimizer(unsigned amount,
+				   std::vector<std::pair<uint64_t, uint64_t>> &vec) override {
+		auto sink = [&vec](uint64_t pos, uint64_t hash) {
+			vec.emplace_back(pos, hash);
+		};
+		roll_block(room(amount, vec), sink);
+	}
+
+	/**
+	 * @brief passes up to amount minimizers, the same ones the other
+	 * roll_minimizer functions would add to a vector, to sink, so they can go
+	 * straight into an index or a stream without being stored first. sink is
+	 * called as sink(position) if it accepts that, and as sink(position, hash)
+	 * otherwise. The position is a size_t, and the hash is the full 64-bit hash
+	 * of the k-mer. If it returns bool, returning false stops rolling after
+	 * that minimizer, e.g. when a fixed size buffer is full, and the next call
+	 * continues from there.
+	 *
+	 * @param amount
+	 * @param sink
+	 *
+	 * @return size_t, the number of minimizers passed to sink
+	 */
+	template <class Sink> size_t roll_minimizer(unsigned amount, Sink &&sink) {
+		return roll_block(amount, sink);
+	}
+
+	void new_seq(const char *seq, size_t len, size_t start) override {
+		reset();
+		Digester<P, K>::new_seq(seq, len, start);
+	}
+
+	void new_seq(const std::string &seq, size_t pos) override {
+		reset();
+		Digester<P, K>::new_seq(seq.c_str(), seq.size(), pos);
+	}
+
+	void new_seq(const uint8_t *packed, size_t len,
+				 const NIntervals &n_intervals, size_t start) override {
+		reset();
+		Digester<P, K>::new_seq(packed, len, n_intervals, start);
+	}
+
+	/**
+	 * @return uint32_t, the mod space being used
+	 */
+	uint32_t get_mod() { return mod; }
+
+	/**
+	 * @return uint32_t, the value the minimized hash must be congruent to
+	 */
+	uint32_t get_congruence() { return congruence; }
+
+  private:
+	uint32_t mod;
+	uint32_t congruence;
+	CongruenceTest test;
+
+	// output of roll_hashes() for the current block
+	std::vector<uint64_t> hashes;
+	std::vector<uint32_t> positions;
+
+	// positions and hashes of the minimizers of the current block, the
+	// number of them, and the next one to pass on
+	std::vector<uint32_t> out_pos;
+	std::vector<uint64_t> out_hash;
+	size_t selected = 0, next = 0;
+
+	// position of the first k-mer hashed for the current block, restores the
+	// bits of the positions that were cut off at 32 bits
+	size_t block_pos = 0;
+
+	void init() {
+		if (congruence >= mod) {
+			throw BadModException();
+		}
+		hashes.resize(BLOCK);
+		positions.resize(BLOCK);
+		out_pos.resize(BLOCK);
+		out_hash.resize(BLOCK);
+		reset();
+	}
+
+	void reset() { selected = next = 0; }
+
+	/**
+	 * @return unsigned, how many minimizers can be added to vec before it
+	 * holds amount
+	 */
+	template <class V>
+	static unsigned room(unsigned amount, const std::vector<V> &vec) {
+		return vec.size() < amount ? amount - vec.size() : 0;
+	}
+
+	/**
+	 * @brief hashes the next block and packs its minimizers
+	 *
+	 * @return bool, false if there were no k-mers left to hash
+	 */
+	bool refill() {
+		if (!this->is_valid_hash) {
+			return false;
+		}
+		block_pos = this->get_pos();
+		size_t n = this->roll_hashes(BLOCK, hashes.data(), positions.data());
+		selected = select_congruent(hashes.data(), positions.data(), n, test,
+									out_pos.data(), out_hash.data());
+		next = 0;
+		return n > 0;
+	}
+
+	template <class Sink> size_t roll_block(unsigned amount, Sink &sink) {
+		size_t n = 0;
+		bool more = true;
+		while (n < amount and more) {
+			if (next >= selected and !refill()) {
+				break;
+			}
+			for (; next < selected and n < amount and more; next++) {
+				n++;
+				// restore the bits of the position cut off at 32 bits
+				size_t pos = block_pos + (uint32_t)(out_pos[next] -
+													(uint32_t)block_pos);
+				uint64_t hash = out_hash[next];
+				more = this->emit(sink, pos, [hash] { return hash; });
+			}
+		}
+		return n;
+	}
+};
+
+} // namespace digest
+
+#endif // BLOCK_MINIMIZER_HPP
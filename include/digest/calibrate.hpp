@@ -0,0 +1,236 @@
+#ifndef CALIBRATE_HPP
+#define CALIBRATE_HPP
+
+#include "digest/data_structure.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Measures on the host CPU at which large window sizes ds::Adaptive
+ * should switch between scanning the window (Naive), remembering the minimum
+ * (Naive2) and a MonoQueue, and configures it with the result. The crossovers
+ * depend on the CPU, the defaults in ds::AdaptiveThresholds come from one
+ * machine.
+ *
+ * Naive, Naive2 and SegmentTree with the large window as a template parameter
+ * are not measured, they can't be picked at runtime, see factory.hpp for
+ * those.
+ *
+ * @par Usage:
+ * call configure_adaptive() once at startup, before constructing any
+ * digesters, and log Calibration::to_string() if needed. Pass it a cache path
+ * to only measure on the first run.
+ */
+namespace digest::ds {
+
+/**
+ * @brief The time per k-mer of every strategy of Adaptive for each large
+ * window measured, and the thresholds picked from them.
+ */
+struct Calibration {
+	/** the large windows measured, in increasing order */
+	std::vector<uint32_t> windows;
+	/** nanoseconds per k-mer scanning the window, one entry per window */
+	std::vector<double> naive;
+	/** nanoseconds per k-mer remembering the minimum, one entry per window */
+	std::vector<double> naive2;
+	/** nanoseconds per k-mer with a MonoQueue, one entry per window */
+	std::vector<double> mono;
+	AdaptiveThresholds thresholds;
+
+	/**
+	 * @return std::string, the thresholds and a table of the measurements,
+	 * for logging. This is also the format of the cache file.
+	 */
+	std::string to_string() const {
+		std::ostringstream out;
+		out << "digest calibration v1\n";
+		out << "naive2_from " << thresholds.naive2_from << "\n";
+		out << "mono_from " << thresholds.mono_from << "\n";
+		out << "window naive naive2 mono (ns per k-mer)\n";
+		for (size_t j = 0; j < windows.size(); j++) {
+			out << windows[j] << " " << naive[j] << " " << naive2[j] << " "
+				<< mono[j] << "\n";
+		}
+		return out.str();
+	}
+
+	/**
+	 * @brief parses the output of to_string()
+	 *
+	 * @param str
+	 *
+	 * @return bool, false if str is not a calibration, in which case this is
+	 * left unchanged
+	 */
+	bool from_string(const std::string &str) {
+		std::istringstream in(str);
+		std::string line, name;
+		Calibration cal;
+		if (!std::getline(in, line) || line != "digest calibration v1") {
+			return false;
+		}
+		if (!(in >> name >> cal.thresholds.naive2_from) ||
+			name != "naive2_from") {
+			return false;
+		}
+		if (!(in >> name >> cal.thresholds.mono_from) || name != "mono_from") {
+			return false;
+		}
+		std::getline(in, line);
+		if (!std::getline(in, line)) {
+			return false;
+		}
+		uint32_t w;
+		double a, b, c;
+		while (in >> w >> a >> b >> c) {
+			cal.windows.push_back(w);
+			cal.naive.push_back(a);
+			cal.naive2.push_back(b);
+			cal.mono.push_back(c);
+		}
+		if (!in.eof()) {
+			return false;
+		}
+		*this = cal;
+		return true;
+	}
+};
+
+/**
+ * @brief times inserting every hash into an Adaptive and querying its
+ * minimum, the fastest of reps runs
+ *
+ * @param hashes
+ * @param large_window
+ * @param thresholds picks the strategy of the Adaptive
+ * @param reps
+ *
+ * @return double, nanoseconds per k-mer
+ */
+inline double time_adaptive(const std::vector<uint32_t> &hashes,
+							uint32_t large_window,
+							const AdaptiveThresholds &thresholds,
+							int reps = 3) {
+	double best = 0;
+	for (int r = 0; r < reps; r++) {
+		Adaptive ds(large_window, thresholds);
+		uint32_t sum = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (uint32_t j = 0; j < hashes.size(); j++) {
+			ds.insert(j, hashes[j]);
+			sum += ds.min();
+		}
+		auto end = std::chrono::steady_clock::now();
+		// keeps the queries from being optimized out
+		volatile uint32_t sink = sum;
+		(void)sink;
+
+		double ns = std::chrono::duration<double, std::nano>(end - start)
+						.count() /
+					hashes.size();
+		if (r == 0 || ns < best) {
+			best = ns;
+		}
+	}
+	return best;
+}
+
+/**
+ * @brief measures every strategy of Adaptive on hashes, and picks the
+ * thresholds from the measurements. A strategy takes over from the window
+ * from which it is the fastest for every larger window measured, the
+ * windows in between keep the strategy of the smaller window.
+ *
+ * @param hashes hashes to insert, random ones favor Naive2, hashes of a
+ * repetitive sequence, with long runs of increasing hashes, favor MonoQueue
+ * @param windows large windows to measure, in increasing order
+ *
+ * @return Calibration
+ */
+inline Calibration calibrate(const std::vector<uint32_t> &hashes,
+							 const std::vector<uint32_t> &windows) {
+	Calibration cal;
+	cal.windows = windows;
+	for (uint32_t w : windows) {
+		cal.naive.push_back(time_adaptive(hashes, w, {UINT32_MAX, UINT32_MAX}));
+		cal.naive2.push_back(time_adaptive(hashes, w, {0, UINT32_MAX}));
+		cal.mono.push_back(time_adaptive(hashes, w, {0, 0}));
+	}
+
+	// scan from the largest window down, a strategy takes over where it
+	// stops being the fastest
+	cal.thresholds = {UINT32_MAX, UINT32_MAX};
+	bool naive2 = true, mono = true;
+	for (size_t j = windows.size(); j-- > 0;) {
+		double rest = std::min(cal.naive[j], cal.naive2[j]);
+		mono = mono && cal.mono[j] < rest;
+		if (mono) {
+			cal.thresholds.mono_from = windows[j];
+		}
+		naive2 = naive2 && cal.naive2[j] <= cal.naive[j];
+		if (naive2) {
+			cal.thresholds.naive2_from = windows[j];
+		}
+	}
+	if (cal.thresholds.naive2_from == UINT32_MAX && !windows.empty()) {
+		// scanning won at the largest window measured, it still loses
+		// eventually, its queries are O(large_window)
+		cal.thresholds.naive2_from = windows.back() + 1;
+	}
+	return cal;
+}
+
+/**
+ * @brief same as the other calibrate, with 2^18 random hashes and large
+ * windows from 4 to 64
+ *
+ * @return Calibration
+ */
+inline Calibration calibrate() {
+	std::mt19937 gen(1);
+	std::vector<uint32_t> hashes(1 << 18);
+	for (uint32_t &hash : hashes) {
+		hash = gen();
+	}
+	return calibrate(hashes,
+					 {4, 6, 8, 10, 12, 14, 16, 20, 24, 32, 40, 48, 56, 64});
+}
+
+/**
+ * @brief calibrates, or reads the calibration from cache_path if it holds
+ * one, and sets adaptive_thresholds() from it. A new calibration is written
+ * to cache_path.
+ *
+ * @param cache_path empty to always calibrate and not write anything
+ *
+ * @return Calibration, the calibration in use, e.g. to log it
+ */
+inline Calibration configure_adaptive(const std::string &cache_path = "") {
+	Calibration cal;
+	bool cached = false;
+	if (!cache_path.empty()) {
+		std::ifstream in(cache_path);
+		std::stringstream str;
+		str << in.rdbuf();
+		cached = in && cal.from_string(str.str());
+	}
+	if (!cached) {
+		cal = calibrate();
+		if (!cache_path.empty()) {
+			std::ofstream(cache_path) << cal.to_string();
+		}
+	}
+	adaptive_thresholds() = cal.thresholds;
+	return cal;
+}
+
+} // namespace digest::ds
+
+#endif // CALIBRATE_HPP
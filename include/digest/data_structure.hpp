@@ -1,14 +1,20 @@
 #ifndef DATA_STRUCTURE_HPP
 #define DATA_STRUCTURE_HPP
 
+#include "digest/isa.hpp"
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <stdint.h>
 #include <type_traits>
 #include <utility>
 #include <vector>
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+	(defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#endif
 
 /**
  * Data structures for minimum hash queries on a window.
@@ -21,31 +27,264 @@
  * * for `large_window` > 16 use Naive2
  *
  * Adaptive performs at worst about 10% slower than best
- * Adaptive64 performs at worst about 100% slower than best
+ * Adaptive64 performs about as well as Adaptive, with 64-bit hashes
+ *
+ * Naive, Naive2, SegmentTree and MonoQueue take the type of the hashes and of
+ * the indices as template parameters, e.g. Naive<8, uint64_t> compares full
+ * 64-bit hashes and keeps 64-bit indices, and Naive<8, uint64_t, uint32_t>
+ * keeps 32-bit indices. Naive, Naive2 and SegmentTree pack both into a
+ * uint64_t for 32-bit hashes and indices and into a __uint128_t otherwise,
+ * whose rescans in Naive2 are not vectorized.
+ * The crossovers differ between CPUs, calibrate.hpp measures the ones of
+ * Adaptive on the host CPU and configures it with them.
+ *
+ * Naive2 and Adaptive rescan the whole window whenever the minimum leaves it,
+ * which happens on every insert for runs of increasing hashes. The rescans
+ * of windows of at least SIMD_MIN_WINDOW k-mers use AVX2 or AVX-512 when the
+ * CPU has them, which makes them about 2.5x faster for `large_window` >= 128,
+ * but leaves random hashes and the crossover points above as they were, the
+ * minimum rarely leaves the window there. MonoQueue is amortized O(1) for any
+ * order of the hashes, at about 4x the cost of Naive2 on random hashes, so
+ * prefer it for large windows on sequences where such runs are common.
  */
 
 namespace digest::ds {
 
 /**
  * All data_structures must follow this interface. Add the min_syncmer functions
- * for syncmer support.
+ * for syncmer support. T is the type of the hashes and I the type of the
+ * indices. Structures with 32-bit indices are the fast path, the digesters
+ * restore the upper bits of the positions for sequences longer than 2^32
+ * bases. The only difference is in ties between k-mers on both sides of a
+ * multiple of 2^32, where the rightmost index by its lower 32 bits wins, use a
+ * structure with 64-bit indices if that matters.
  */
-template <typename T> struct Interface {
+template <typename T, typename I = uint32_t> struct Interface {
 	static_assert(std::is_same<T, uint32_t>() || std::is_same<T, uint64_t>(),
 				  "T must be either uint32_t or uint64_t");
+	static_assert(std::is_same<I, uint32_t>() || std::is_same<I, uint64_t>(),
+				  "I must be either uint32_t or uint64_t");
 
 	/** constructor must accept uint32_t large_window */
 	Interface(uint32_t);
 
 	/** returns the index of the minimum hash */
-	virtual uint32_t min();
+	virtual I min();
 	/** returns the minimum hash */
 	virtual T min_hash();
 
 	/** appends minimum if syncmer */
-	virtual void min_syncmer(std::vector<uint32_t> &vec);
+	virtual void min_syncmer(std::vector<I> &vec);
 	/** appends (left syncmer index, right syncmer index) */
-	virtual void min_syncmer(std::vector<std::pair<uint32_t, T>> &vec);
+	virtual void min_syncmer(std::vector<std::pair<I, T>> &vec);
+
+	/**
+	 * inserts n k-mers, e.g. a block from Digester::roll_hashes(), and calls
+	 * out(j, min(), min_hash()) after inserting k-mer j whenever the index of
+	 * the minimum differs from the one before it. Same as calling insert()
+	 * for each of them, but structures can keep state in registers across the
+	 * block and skip the queries that find nothing new.
+	 */
+	template <class Out>
+	void insert_many(const uint32_t *index, const uint64_t *hash, size_t n,
+					 Out &&out);
+};
+
+//------------- ARGMAX KERNELS ----------------
+
+/**
+ * @brief Window sizes below this are scanned with scalar code even when SIMD
+ * is available. A rescan reads the slot that was just written by a scalar
+ * store, and the vector loads have to wait for it, which costs more than the
+ * whole scalar loop for small windows.
+ */
+constexpr uint32_t SIMD_MIN_WINDOW = 32;
+
+/**
+ * @brief scalar version of max_slot()
+ */
+inline uint32_t max_slot_scalar(const uint64_t *arr, uint32_t n) {
+	uint32_t slot = n - 1;
+	uint64_t max = arr[slot];
+	for (int j = n - 2; j >= 0; j--) {
+		if (arr[j] > max) {
+			max = arr[j];
+			slot = j;
+		}
+	}
+	return slot;
+}
+
+/**
+ * @brief scalar version of max_slot() for 128-bit keys
+ */
+inline uint32_t max_slot_scalar(const __uint128_t *arr, uint32_t n) {
+	uint32_t slot = n - 1;
+	for (int j = n - 2; j >= 0; j--) {
+		if (arr[j] > arr[slot]) {
+			slot = j;
+		}
+	}
+	return slot;
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+	(defined(__GNUC__) || defined(__clang__))
+/**
+ * @brief AVX2 version of max_slot(). AVX2 only has signed 64-bit compares, so
+ * the sign bits are flipped to compare unsigned values.
+ */
+__attribute__((target("avx2"))) inline uint32_t
+max_slot_avx2(const uint64_t *arr, uint32_t n) {
+	const __m256i flip = _mm256_set1_epi64x(INT64_MIN);
+	__m256i best = flip;
+	uint32_t j = 0;
+	for (; j + 4 <= n; j += 4) {
+		__m256i v = _mm256_xor_si256(
+			_mm256_loadu_si256((const __m256i *)(arr + j)), flip);
+		best = _mm256_blendv_epi8(best, v, _mm256_cmpgt_epi64(v, best));
+	}
+	__m128i lo = _mm256_castsi256_si128(best);
+	__m128i hi = _mm256_extracti128_si256(best, 1);
+	lo = _mm_blendv_epi8(lo, hi, _mm_cmpgt_epi64(hi, lo));
+	hi = _mm_unpackhi_epi64(lo, lo);
+	lo = _mm_blendv_epi8(lo, hi, _mm_cmpgt_epi64(hi, lo));
+	uint64_t max = _mm_cvtsi128_si64(lo) ^ INT64_MIN;
+	for (uint32_t l = j; l < n; l++) {
+		max = std::max(max, arr[l]);
+	}
+
+	// the index recovery step, finds the rightmost slot holding max
+	const __m256i target = _mm256_set1_epi64x(max);
+	uint32_t slot = 0;
+	for (j = 0; j + 4 <= n; j += 4) {
+		int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(
+			_mm256_loadu_si256((const __m256i *)(arr + j)), target)));
+		slot = mask ? j + 31 - __builtin_clz(mask) : slot;
+	}
+	for (; j < n; j++) {
+		slot = arr[j] == max ? j : slot;
+	}
+	return slot;
+}
+
+// the unmasked max and reduce intrinsics trip -Wuninitialized in GCC 12
+__attribute__((target("avx512f"))) inline uint64_t
+reduce_max_avx512(__m512i v) {
+	alignas(64) uint64_t lanes[8];
+	_mm512_store_si512(lanes, v);
+	return *std::max_element(lanes, lanes + 8);
+}
+
+/**
+ * @brief AVX-512 version of max_slot()
+ */
+__attribute__((target("avx512f"))) inline uint32_t
+max_slot_avx512(const uint64_t *arr, uint32_t n) {
+	__m512i best = _mm512_setzero_si512();
+	uint32_t j = 0;
+	for (; j + 8 <= n; j += 8) {
+		best = _mm512_mask_max_epu64(best, 0xFF, best,
+									 _mm512_loadu_si512(arr + j));
+	}
+	__mmask8 tail = (1u << (n - j)) - 1;
+	best = _mm512_mask_max_epu64(best, tail, best,
+								 _mm512_maskz_loadu_epi64(tail, arr + j));
+	uint64_t max = reduce_max_avx512(best);
+
+	// the index recovery step, finds the rightmost slot holding max
+	const __m512i target = _mm512_set1_epi64(max);
+	uint32_t slot = 0;
+	for (j = 0; j + 8 <= n; j += 8) {
+		unsigned mask =
+			_mm512_cmpeq_epu64_mask(_mm512_loadu_si512(arr + j), target);
+		slot = mask ? j + 31 - __builtin_clz(mask) : slot;
+	}
+	unsigned mask = _mm512_mask_cmpeq_epu64_mask(
+		tail, _mm512_maskz_loadu_epi64(tail, arr + j), target);
+	return mask ? j + 31 - __builtin_clz(mask) : slot;
+}
+
+#endif
+
+/**
+ * @brief finds the slot of the largest of the n packed (~hash, index) values
+ * in arr, i.e. the slot of the minimal hash with ties going to the rightmost
+ * index, the same one the scalar loops of the data structures find. The
+ * kernel is picked once at runtime from the instruction sets the CPU
+ * supports, AVX-512, AVX2 or scalar code, so the same binary runs on any
+ * x86-64 CPU.
+ *
+ * @param arr
+ * @param n must be at least 1
+ *
+ * @return uint32_t, the slot of the maximum
+ */
+inline uint32_t max_slot(const uint64_t *arr, uint32_t n) {
+	typedef uint32_t (*Kernel)(const uint64_t *, uint32_t);
+	static const Kernel kernel = []() -> Kernel {
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+	(defined(__GNUC__) || defined(__clang__))
+		switch (get_isa()) {
+		case Isa::AVX512:
+			return max_slot_avx512;
+		case Isa::AVX2:
+			return max_slot_avx2;
+		default:
+			break;
+		}
+#endif
+		return max_slot_scalar;
+	}();
+	return n < SIMD_MIN_WINDOW ? max_slot_scalar(arr, n) : kernel(arr, n);
+}
+
+/**
+ * @brief same as the other max_slot, for the 128-bit keys of 64-bit hashes or
+ * indices, always with scalar code
+ */
+inline uint32_t max_slot(const __uint128_t *arr, uint32_t n) {
+	return max_slot_scalar(arr, n);
+}
+
+/**
+ * @return uint32_t, the smallest power of 2 that is at least w
+ */
+constexpr uint32_t ceil_pow2(uint32_t w) {
+	uint32_t cap = 1;
+	while (cap < w)
+		cap <<= 1;
+	return cap;
+}
+
+/**
+ * @brief Packs a hash and an index into one key, ~hash above the index, so the
+ * maximum key is the minimal hash, with ties broken by the rightmost index.
+ * The key is a uint64_t for 32-bit hashes and indices, and a __uint128_t
+ * otherwise.
+ *
+ * @tparam T type of the hashes
+ * @tparam I type of the indices
+ */
+template <class T, class I> struct Packing {
+	static_assert(std::is_same<T, uint32_t>() || std::is_same<T, uint64_t>(),
+				  "T must be either uint32_t or uint64_t");
+	static_assert(std::is_same<I, uint32_t>() || std::is_same<I, uint64_t>(),
+				  "I must be either uint32_t or uint64_t");
+
+	typedef std::conditional_t<sizeof(T) + sizeof(I) == 8, uint64_t,
+							   __uint128_t>
+		Key;
+	static constexpr int SHIFT = 8 * sizeof(I);
+
+	static Key pack(I index, T hash) { return (Key)(T)~hash << SHIFT | index; }
+
+	static I index(Key key) { return (I)key; }
+
+	// the negated hash, compares like the key
+	static T neg_hash(Key key) { return (T)(key >> SHIFT); }
+
+	static T hash(Key key) { return ~neg_hash(key); }
 };
 
 // Based on a template taken from USACO.guide and then modified by me (for
@@ -57,117 +296,200 @@ template <typename T> struct Interface {
 
 /**
  * @brief Segment Tree data structure. Supports log(n) point updates and range
- * minimum queries.
+ * minimum queries. The leaves are padded to a power of 2, so every update
+ * walks up the same number of levels, and the padding never wins.
  *
- * @tparam k large window size
+ * @tparam k large window size, 0 to take it from the constructor at runtime
+ * @tparam T type of the hashes, uint64_t compares full 64-bit hashes
+ * @tparam I type of the indices, uint64_t keeps 64-bit indices, see
+ * SegmentTree64
  */
-template <int k> struct SegmentTree {
-	int i = k;
-	std::array<uint64_t, 2 * k> segtree = {};
-
-	constexpr int log2() { return std::ceil(std::log2(k)); }
+template <int k = 0, class T = uint32_t, class I = T> struct SegmentTree {
+	typedef Packing<T, I> Pack;
+	typedef typename Pack::Key Key;
+
+	static constexpr uint32_t log2(uint32_t n) {
+		uint32_t depth = 0;
+		while ((1u << depth) < n)
+			depth++;
+		return depth;
+	}
 
-	SegmentTree(uint32_t) {}
+	// number of leaves and levels above them, for k == 0 they are cached
+	// instead of computed on every insert
+	uint32_t w, leaves, depth, i;
+	std::conditional_t<k == 0, std::vector<Key>,
+					   std::array<Key, 2 * ceil_pow2(k ? k : 1)>>
+		segtree{};
+
+	SegmentTree(uint32_t large_window)
+		: w(k ? k : large_window), leaves(ceil_pow2(w)), depth(log2(leaves)),
+		  i(leaves) {
+		if constexpr (k == 0) {
+			segtree.resize(2 * leaves);
+		}
+	}
 	SegmentTree(const SegmentTree &other) = default;
 	SegmentTree &operator=(const SegmentTree &other) = default;
 
-	void insert(uint32_t index, uint32_t hash) {
-		int ind = i;
-		if (++i == 2 * k)
-			i = k;
+	// the window and the depth, constants when k is known at compile time
+	uint32_t window() const { return k ? k : w; }
+	uint32_t first() const { return k ? ceil_pow2(k) : leaves; }
+	uint32_t levels() const { return k ? log2(ceil_pow2(k)) : depth; }
+
+	void insert(I index, T hash) {
+		uint32_t ind = i;
+		if (++i == first() + window())
+			i = first();
 
 		// negate so we can use max so that ties are broken by rightmost
-		segtree[ind] = (uint64_t)~hash << 32 | index;
-		for (int rep = 0; rep < log2(); rep++) {
+		segtree[ind] = Pack::pack(index, hash);
+		for (uint32_t rep = 0; rep < levels(); rep++) {
 			segtree[ind >> 1] = std::max(segtree[ind], segtree[ind ^ 1]);
 			ind >>= 1;
 		}
 	}
 
-	uint32_t min() { return segtree[1]; }
+	template <class Out>
+	void insert_many(const uint32_t *index, const uint64_t *hash, size_t n,
+					 Out &&out) {
+		I prev = min();
+		for (size_t j = 0; j < n; j++) {
+			insert(index[j], hash[j]);
+			if (min() != prev) {
+				prev = min();
+				out(j, prev, min_hash());
+			}
+		}
+	}
+
+	I min() { return Pack::index(segtree[1]); }
 
-	uint32_t min_hash() { return ~(segtree[1] >> 32); }
+	T min_hash() { return Pack::hash(segtree[1]); }
 
-	void min_syncmer(std::vector<uint32_t> &vec) {
-		if (segtree[1] >> 32 ==
-			std::max(uint32_t(segtree[i] >> 32),
-					 uint32_t(segtree[i == k ? 2 * k - 1 : i - 1] >> 32))) {
-			vec.emplace_back(segtree[i]);
+	void min_syncmer(std::vector<I> &vec) {
+		if (is_syncmer()) {
+			vec.emplace_back(Pack::index(segtree[i]));
 		}
 	}
 
-	void min_syncmer(std::vector<std::pair<uint32_t, uint32_t>> &vec) {
-		if (segtree[1] >> 32 ==
-			std::max(uint32_t(segtree[i] >> 32),
-					 uint32_t(segtree[i == k ? 2 * k - 1 : i - 1] >> 32))) {
-			vec.emplace_back(segtree[i], ~(segtree[1] >> 32));
+	void min_syncmer(std::vector<std::pair<I, T>> &vec) {
+		if (is_syncmer()) {
+			vec.emplace_back(Pack::index(segtree[i]), min_hash());
 		}
 	}
+
+	// the minimal hash belongs to the oldest leaf, i, or the newest one
+	bool is_syncmer() {
+		uint32_t newest = i == first() ? first() + window() - 1 : i - 1;
+		return Pack::neg_hash(segtree[1]) ==
+			   std::max(Pack::neg_hash(segtree[i]),
+						Pack::neg_hash(segtree[newest]));
+	}
 };
 
+/**
+ * @brief Same as SegmentTree but uses 64-bit hashes and 64-bit indices, for
+ * sequences longer than 2^32 bases.
+ *
+ * @tparam k large window size, 0 to take it from the constructor at runtime
+ */
+template <int k = 0> using SegmentTree64 = SegmentTree<k, uint64_t>;
+
 /**
  * @brief Naive data structure. Naively loops through the array to find the
  * minimum.
  *
  * @tparam k large window size
+ * @tparam T type of the hashes, uint64_t compares full 64-bit hashes
+ * @tparam I type of the indices, uint64_t keeps 64-bit indices
  */
-template <uint32_t k> struct Naive {
-	std::array<uint64_t, k> arr;
+template <uint32_t k, class T = uint32_t, class I = T> struct Naive {
+	typedef Packing<T, I> Pack;
+	typedef typename Pack::Key Key;
+
+	std::array<Key, k> arr{};
 	unsigned int i = 0;
 
 	Naive(uint32_t){};
 	Naive(const Naive &other) = default;
 	Naive &operator=(const Naive &other) = default;
 
-	void insert(uint32_t index, uint32_t hash) {
-		arr[i] = (uint64_t)~hash << 32 | index;
+	void insert(I index, T hash) {
+		arr[i] = Pack::pack(index, hash);
 		if (++i == k)
 			i = 0;
 	}
 
-	uint32_t min() {
+	// remembers the minimum for the block like Naive2, instead of scanning
+	// the window after every insert
+	template <class Out>
+	void insert_many(const uint32_t *index, const uint64_t *hash, size_t n,
+					 Out &&out) {
+		uint32_t last = max_slot_scalar(arr.data(), k);
+		I prev = Pack::index(arr[last]);
+		for (size_t j = 0; j < n; j++) {
+			arr[i] = Pack::pack(index[j], hash[j]);
+			if (arr[i] > arr[last]) {
+				last = i;
+			} else if (last == i) {
+				last = max_slot_scalar(arr.data(), k);
+			}
+			if (++i == k)
+				i = 0;
+
+			if (Pack::index(arr[last]) != prev) {
+				prev = Pack::index(arr[last]);
+				out(j, prev, Pack::hash(arr[last]));
+			}
+		}
+	}
+
+	I min() {
 		int i = k - 1;
 		for (int j = k - 2; j >= 0; j--) {
 			if (arr[j] > arr[i]) {
 				i = j;
 			}
 		}
-		return arr[i];
+		return Pack::index(arr[i]);
 	}
 
-	uint32_t min_hash() {
+	T min_hash() {
 		int i = k - 1;
 		for (int j = k - 2; j >= 0; j--) {
 			if (arr[j] > arr[i]) {
 				i = j;
 			}
 		}
-		return ~(uint32_t)(arr[i] >> 32);
+		return Pack::hash(arr[i]);
 	}
 
-	void min_syncmer(std::vector<uint32_t> &vec) {
+	void min_syncmer(std::vector<I> &vec) {
 		unsigned int j = 0;
 		for (unsigned int l = 1; l < k; l++) {
 			if (arr[l] > arr[j]) {
 				j = l;
 			}
 		}
-		if (arr[j] >> 32 == std::max(uint32_t(arr[i] >> 32),
-									 uint32_t(arr[i ? i - 1 : k - 1] >> 32))) {
-			vec.emplace_back(arr[i]);
+		if (Pack::neg_hash(arr[j]) ==
+			std::max(Pack::neg_hash(arr[i]),
+					 Pack::neg_hash(arr[i ? i - 1 : k - 1]))) {
+			vec.emplace_back(Pack::index(arr[i]));
 		}
 	}
 
-	void min_syncmer(std::vector<std::pair<uint32_t, uint32_t>> &vec) {
+	void min_syncmer(std::vector<std::pair<I, T>> &vec) {
 		unsigned int j = k - 1;
 		for (int l = k - 2; l >= 0; l--) {
 			if (arr[l] > arr[j]) {
 				j = l;
 			}
 		}
-		if (arr[j] >> 32 == std::max(uint32_t(arr[i] >> 32),
-									 uint32_t(arr[i ? i - 1 : k - 1] >> 32))) {
-			vec.emplace_back(arr[i], ~(uint32_t)(arr[j] >> 32));
+		if (Pack::neg_hash(arr[j]) ==
+			std::max(Pack::neg_hash(arr[i]),
+					 Pack::neg_hash(arr[i ? i - 1 : k - 1]))) {
+			vec.emplace_back(Pack::index(arr[i]), Pack::hash(arr[j]));
 		}
 	}
 };
@@ -177,67 +499,238 @@ template <uint32_t k> struct Naive {
  * through the array when this index leaves the window.
  *
  * @tparam k large window size
+ * @tparam T type of the hashes, uint64_t compares full 64-bit hashes
+ * @tparam I type of the indices, uint64_t keeps 64-bit indices
  */
-template <uint32_t k> struct Naive2 {
+template <uint32_t k, class T = uint32_t, class I = T> struct Naive2 {
+	typedef Packing<T, I> Pack;
+	typedef typename Pack::Key Key;
+
 	unsigned int i = 0;
 	unsigned int last = 0;
-	std::vector<uint64_t> arr = std::vector<uint64_t>(k);
+	std::vector<Key> arr = std::vector<Key>(k);
 
 	Naive2(uint32_t){};
 	Naive2(const Naive2 &other) = default;
 	Naive2 &operator=(const Naive2 &other) = default;
 
-	void insert(uint32_t index, uint32_t hash) {
+	void insert(I index, T hash) {
 		// flip the hash bits so we can take the maximum
-		arr[i] = (uint64_t)~hash << 32 | index;
+		arr[i] = Pack::pack(index, hash);
 
 		if (arr[i] > arr[last]) {
 			last = i;
 		} else if (last == i) {
-			for (unsigned j = 0; j < k; j++) {
-				if (arr[j] > arr[last]) {
-					last = j;
-				}
-			}
+			last = max_slot(arr.data(), k);
 		}
 
 		if (++i == k)
 			i = 0;
 	}
 
-	uint32_t min() { return arr[last]; }
+	template <class Out>
+	void insert_many(const uint32_t *index, const uint64_t *hash, size_t n,
+					 Out &&out) {
+		I prev = min();
+		for (size_t j = 0; j < n; j++) {
+			insert(index[j], hash[j]);
+			if (min() != prev) {
+				prev = min();
+				out(j, prev, min_hash());
+			}
+		}
+	}
 
-	uint32_t min_hash() { return ~(uint32_t)(arr[last] >> 32); }
+	I min() { return Pack::index(arr[last]); }
 
-	void min_syncmer(std::vector<uint32_t> &vec) {
-		if (arr[last] >> 32 ==
-			std::max(uint32_t(arr[i] >> 32),
-					 uint32_t(arr[i ? i - 1 : k - 1] >> 32))) {
-			vec.emplace_back(arr[i]);
+	T min_hash() { return Pack::hash(arr[last]); }
+
+	void min_syncmer(std::vector<I> &vec) {
+		if (Pack::neg_hash(arr[last]) ==
+			std::max(Pack::neg_hash(arr[i]),
+					 Pack::neg_hash(arr[i ? i - 1 : k - 1]))) {
+			vec.emplace_back(Pack::index(arr[i]));
 		}
 	}
 
-	void min_syncmer(std::vector<std::pair<uint32_t, uint32_t>> &vec) {
-		if (arr[last] >> 32 ==
-			std::max(uint32_t(arr[i] >> 32),
-					 uint32_t(arr[i ? i - 1 : k - 1] >> 32))) {
-			vec.emplace_back(arr[i], ~(uint32_t)(arr[last] >> 32));
+	void min_syncmer(std::vector<std::pair<I, T>> &vec) {
+		if (Pack::neg_hash(arr[last]) ==
+			std::max(Pack::neg_hash(arr[i]),
+					 Pack::neg_hash(arr[i ? i - 1 : k - 1]))) {
+			vec.emplace_back(Pack::index(arr[i]), min_hash());
 		}
 	}
 };
 
 /**
- * @brief Adaptive data structure. Selects between Naive and Naive2 based on the
- * large window size.
+ * @brief Monotonic queue data structure. Keeps the k-mers of the window that
+ * can still become the minimum in a deque of increasing hashes, so insertions
+ * are amortized O(1) and queries O(1) no matter the large window size or the
+ * order of the hashes. Ties go to the rightmost index, like every other data
+ * structure.
+ *
+ * @tparam k large window size, 0 to take it from the constructor at runtime
+ * @tparam T type of the hashes, uint64_t compares full 64-bit hashes
+ * @tparam I type of the indices, uint64_t keeps 64-bit indices, see
+ * MonoQueue64
+ */
+template <uint32_t k = 0, class T = uint32_t, class I = T> struct MonoQueue {
+	static_assert(std::is_same<T, uint32_t>() || std::is_same<T, uint64_t>(),
+				  "T must be either uint32_t or uint64_t");
+	static_assert(std::is_same<I, uint32_t>() || std::is_same<I, uint64_t>(),
+				  "I must be either uint32_t or uint64_t");
+
+	// the deque wraps around with a mask, so its capacity is a power of 2
+	static constexpr uint32_t capacity(uint32_t w) { return ceil_pow2(w); }
+
+	template <class V, uint32_t n>
+	using Buffer =
+		std::conditional_t<k == 0, std::vector<V>, std::array<V, n ? n : 1>>;
+
+	// the last large_window k-mers, slot i is the oldest one after an insert
+	Buffer<T, k> hashes;
+	Buffer<I, k> indices;
+	// hashes and slots of the k-mers in the deque, hashes increasing from head
+	// to tail, head and tail only wrap around through the mask
+	Buffer<T, capacity(k)> deque_hashes;
+	Buffer<uint32_t, capacity(k)> deque_slots;
+	uint32_t w, mask, i = 0, head = 0, tail = 0;
+
+	MonoQueue(uint32_t large_window)
+		: w(k ? k : large_window), mask(capacity(w) - 1) {
+		if constexpr (k == 0) {
+			hashes.resize(w);
+			indices.resize(w);
+			deque_hashes.resize(mask + 1);
+			deque_slots.resize(mask + 1);
+		} else {
+			hashes.fill(0);
+			indices.fill(0);
+			deque_hashes.fill(0);
+			deque_slots.fill(0);
+		}
+	}
+	MonoQueue(const MonoQueue &other) = default;
+	MonoQueue &operator=(const MonoQueue &other) = default;
+
+	void insert(I index, T hash) {
+		// the oldest k-mer leaves the window
+		if (head != tail and deque_slots[head & mask] == i)
+			head++;
+
+		hashes[i] = hash;
+		indices[i] = index;
+
+		// k-mers with a hash >= the new one can never be the minimum again
+		while (head != tail and deque_hashes[(tail - 1) & mask] >= hash)
+			tail--;
+
+		deque_hashes[tail & mask] = hash;
+		deque_slots[tail & mask] = i;
+		tail++;
+
+		if (++i == w)
+			i = 0;
+	}
+
+	template <class Out>
+	void insert_many(const uint32_t *index, const uint64_t *hash, size_t n,
+					 Out &&out) {
+		I prev = min();
+		for (size_t j = 0; j < n; j++) {
+			insert(index[j], hash[j]);
+			if (min() != prev) {
+				prev = min();
+				out(j, prev, min_hash());
+			}
+		}
+	}
+
+	I min() { return indices[deque_slots[head & mask]]; }
+
+	T min_hash() { return deque_hashes[head & mask]; }
+
+	void min_syncmer(std::vector<I> &vec) {
+		if (is_syncmer()) {
+			vec.emplace_back(indices[i]);
+		}
+	}
+
+	void min_syncmer(std::vector<std::pair<I, T>> &vec) {
+		if (is_syncmer()) {
+			vec.emplace_back(indices[i], min_hash());
+		}
+	}
+
+	// the minimal hash belongs to the leftmost or the rightmost k-mer, compares
+	// hashes rather than slots since the deque only keeps the rightmost of
+	// equal hashes
+	bool is_syncmer() {
+		T hash = min_hash();
+		return hashes[i] == hash or hashes[i ? i - 1 : w - 1] == hash;
+	}
+};
+
+/**
+ * @brief Same as MonoQueue but uses 64-bit hashes and 64-bit indices, for
+ * sequences longer than 2^32 bases.
+ *
+ * @tparam k large window size, 0 to take it from the constructor at runtime
+ */
+template <uint32_t k = 0> using MonoQueue64 = MonoQueue<k, uint64_t>;
+
+/**
+ * @brief Large window sizes at which Adaptive switches between its strategies.
+ * The defaults come from one machine, calibrate.hpp measures them on the host
+ * CPU.
+ */
+struct AdaptiveThresholds {
+	/** from this large window on, remember the minimum like Naive2 instead of
+	 * scanning the window on every query like Naive */
+	uint32_t naive2_from = 16;
+	/** from this large window on, use a MonoQueue, never by default */
+	uint32_t mono_from = UINT32_MAX;
+};
+
+/**
+ * @return AdaptiveThresholds&, the thresholds used by every Adaptive
+ * constructed from then on. They are not synchronized, set them before
+ * starting any threads that construct digesters.
+ */
+inline AdaptiveThresholds &adaptive_thresholds() {
+	static AdaptiveThresholds thresholds;
+	return thresholds;
+}
+
+/**
+ * @brief Adaptive data structure. Selects between Naive, Naive2 and MonoQueue
+ * based on the large window size and adaptive_thresholds().
  */
 struct Adaptive {
+	enum class Mode { NAIVE, NAIVE2, MONO };
+
 	uint32_t k, i = 0, last = 0;
+	Mode mode;
+	// for MONO, the slots of the monotonic queue follow the window, see
+	// MonoQueue
 	std::vector<uint64_t> arr;
+	uint32_t mask, head = 0, tail = 0;
 
-	Adaptive(uint32_t k) : k(k), arr(k) {}
+	Adaptive(uint32_t k,
+			 const AdaptiveThresholds &thresholds = adaptive_thresholds())
+		: k(k), mode(pick(k, thresholds)),
+		  arr(k + (mode == Mode::MONO ? MonoQueue<>::capacity(k) : 0)),
+		  mask(MonoQueue<>::capacity(k) - 1) {}
 	Adaptive(const Adaptive &other) = default;
 	Adaptive &operator=(const Adaptive &other) = default;
 
+	static Mode pick(uint32_t k, const AdaptiveThresholds &thresholds) {
+		if (k >= thresholds.mono_from) {
+			return Mode::MONO;
+		}
+		return k < thresholds.naive2_from ? Mode::NAIVE : Mode::NAIVE2;
+	}
+
 	void naive(uint32_t index, uint32_t hash) {
 		arr[i] = (uint64_t)~hash << 32 | index;
 		if (++i == k)
@@ -251,27 +744,74 @@ struct Adaptive {
 		if (arr[i] > arr[last]) {
 			last = i;
 		} else if (last == i) {
-			for (unsigned j = 0; j < k; j++) {
-				if (arr[j] > arr[last]) {
-					last = j;
-				}
-			}
+			last = max_slot(arr.data(), k);
 		}
 
 		if (++i == k)
 			i = 0;
 	}
 
+	void mono(uint32_t index, uint32_t hash) {
+		uint64_t *deque = arr.data() + k;
+		if (head != tail and deque[head & mask] == i)
+			head++;
+
+		arr[i] = (uint64_t)~hash << 32 | index;
+		while (head != tail and arr[deque[(tail - 1) & mask]] < arr[i])
+			tail--;
+		deque[tail++ & mask] = i;
+		last = deque[head & mask];
+
+		if (++i == k)
+			i = 0;
+	}
+
 	void insert(uint32_t index, uint32_t hash) {
-		if (k < 16) {
+		if (mode == Mode::NAIVE2) {
+			naive2(index, hash);
+		} else if (mode == Mode::NAIVE) {
 			naive(index, hash);
 		} else {
-			naive2(index, hash);
+			mono(index, hash);
 		}
 	}
 
+	// picks the strategy once for the block. NAIVE remembers the minimum like
+	// NAIVE2 here, it would scan the window after every insert otherwise
+	template <class Out>
+	void insert_many(const uint32_t *index, const uint64_t *hash, size_t n,
+					 Out &&out) {
+		last = min_slot();
+		uint32_t prev = arr[last];
+		if (mode == Mode::MONO) {
+			for (size_t j = 0; j < n; j++) {
+				mono(index[j], hash[j]);
+				if ((uint32_t)arr[last] != prev) {
+					prev = arr[last];
+					out(j, prev, ~(uint32_t)(arr[last] >> 32));
+				}
+			}
+		} else {
+			for (size_t j = 0; j < n; j++) {
+				naive2(index[j], hash[j]);
+				if ((uint32_t)arr[last] != prev) {
+					prev = arr[last];
+					out(j, prev, ~(uint32_t)(arr[last] >> 32));
+				}
+			}
+		}
+	}
+
+	// Naive2 and MonoQueue keep the slot of the minimum in last
+	uint32_t min_slot() {
+		if (mode == Mode::NAIVE) {
+			return max_slot_scalar(arr.data(), k);
+		}
+		return last;
+	}
+
 	uint32_t min() {
-		if (k < 16) {
+		if (mode == Mode::NAIVE) {
 			int i = k - 1;
 			for (int j = k - 2; j >= 0; j--) {
 				if (arr[j] > arr[i]) {
@@ -285,7 +825,7 @@ struct Adaptive {
 	}
 
 	uint32_t min_hash() {
-		if (k < 16) {
+		if (mode == Mode::NAIVE) {
 			int i = k - 1;
 			for (int j = k - 2; j >= 0; j--) {
 				if (arr[j] > arr[i]) {
@@ -299,165 +839,105 @@ struct Adaptive {
 	}
 
 	void min_syncmer(std::vector<uint32_t> &vec) {
-		if (k < 16) {
-			unsigned int j = k - 1;
-			for (int l = k - 2; l >= 0; l--) {
-				if (arr[l] > arr[j]) {
-					j = l;
-				}
-			}
-			if (arr[j] >> 32 ==
-				std::max(uint32_t(arr[i] >> 32),
-						 uint32_t(arr[i ? i - 1 : k - 1] >> 32))) {
-				vec.emplace_back(arr[i]);
-			}
-		} else {
-			if (arr[last] >> 32 ==
-				std::max(uint32_t(arr[i] >> 32),
-						 uint32_t(arr[i ? i - 1 : k - 1] >> 32))) {
-				vec.emplace_back(arr[i]);
-			}
+		uint32_t j = min_slot();
+		if (arr[j] >> 32 ==
+			std::max(uint32_t(arr[i] >> 32),
+					 uint32_t(arr[i ? i - 1 : k - 1] >> 32))) {
+			vec.emplace_back(arr[i]);
 		}
 	}
 
 	void min_syncmer(std::vector<std::pair<uint32_t, uint32_t>> &vec) {
-		if (k < 16) {
-			unsigned int j = k - 1;
-			for (int l = k - 2; l >= 0; l--) {
-				if (arr[l] > arr[j]) {
-					j = l;
-				}
-			}
-			if (arr[j] >> 32 ==
-				std::max(uint32_t(arr[i] >> 32),
-						 uint32_t(arr[i ? i - 1 : k - 1] >> 32))) {
-				vec.emplace_back(arr[i], ~(uint32_t)(arr[j] >> 32));
-			}
-		} else {
-			if (arr[last] >> 32 ==
-				std::max(uint32_t(arr[i] >> 32),
-						 uint32_t(arr[i ? i - 1 : k - 1] >> 32))) {
-				vec.emplace_back(arr[i], ~(uint32_t)(arr[last] >> 32));
-			}
+		uint32_t j = min_slot();
+		if (arr[j] >> 32 ==
+			std::max(uint32_t(arr[i] >> 32),
+					 uint32_t(arr[i ? i - 1 : k - 1] >> 32))) {
+			vec.emplace_back(arr[i], ~(uint32_t)(arr[j] >> 32));
 		}
 	}
 };
 
 /**
- * @brief Same as Adaptive but uses 64-bit hashes.
+ * @brief Same as Adaptive but uses 64-bit hashes and 64-bit indices, for
+ * sequences longer than 2^32 bases. The hashes and the indices are kept in
+ * separate arrays, so finding the minimum compares one 64-bit hash per k-mer
+ * and only looks at the indices to break ties. Scanning the window on every
+ * query like Naive is not faster than remembering the minimum like Naive2
+ * with that layout, for any large window size, so it always does the latter.
  */
 struct Adaptive64 {
 	uint32_t k, i = 0, last = 0;
-	std::vector<__uint128_t> arr;
+	// the last k k-mers, slot i is the oldest one after an insert. Slots that
+	// were never inserted into hold the largest hash, so they never win
+	std::vector<uint64_t> hashes, indices;
 
-	Adaptive64(uint32_t k) : k(k), arr(k) {}
+	Adaptive64(uint32_t k) : k(k), hashes(k, UINT64_MAX), indices(k) {}
 	Adaptive64(const Adaptive64 &other) = default;
 	Adaptive64 &operator=(const Adaptive64 &other) = default;
 
-	void naive(uint32_t index, uint64_t hash) {
-		arr[i] = (__uint128_t)~hash << 32 | index;
-		if (++i == k)
-			i = 0;
+	// the minimal hash first, then the largest index with it, so the first
+	// loop has no branches and vectorizes
+	uint32_t min_slot() {
+		uint64_t hash = hashes[0];
+		for (uint32_t j = 1; j < k; j++) {
+			hash = std::min(hash, hashes[j]);
+		}
+		uint32_t slot = 0;
+		uint64_t index = 0;
+		for (uint32_t j = 0; j < k; j++) {
+			if (hashes[j] == hash && indices[j] >= index) {
+				slot = j;
+				index = indices[j];
+			}
+		}
+		return slot;
 	}
 
-	void naive2(uint32_t index, uint64_t hash) {
-		// flip the hash bits so we can take the maximum
-		arr[i] = (__uint128_t)~hash << 32 | index;
+	void insert(uint64_t index, uint64_t hash) {
+		hashes[i] = hash;
+		indices[i] = index;
 
-		if (arr[i] > arr[last]) {
+		if (last == i) {
+			last = min_slot();
+		} else if (hash < hashes[last] ||
+				   (hash == hashes[last] && index > indices[last])) {
 			last = i;
-		} else if (last == i) {
-			for (int j = k - 1; j >= 0; j--) {
-				if (arr[j] > arr[last]) {
-					last = j;
-				}
-			}
 		}
 
 		if (++i == k)
 			i = 0;
 	}
 
-	void insert(uint32_t index, uint64_t hash) {
-		if (k < 16) {
-			naive(index, hash);
-		} else {
-			return naive2(index, hash);
-		}
-	}
-
-	uint32_t min() {
-		if (k < 16) {
-			int i = k - 1;
-			for (int j = k - 2; j >= 0; j--) {
-				if (arr[j] > arr[i]) {
-					i = j;
-				}
+	template <class Out>
+	void insert_many(const uint32_t *index, const uint64_t *hash, size_t n,
+					 Out &&out) {
+		uint64_t prev = min();
+		for (size_t j = 0; j < n; j++) {
+			insert(index[j], hash[j]);
+			if (min() != prev) {
+				prev = min();
+				out(j, prev, min_hash());
 			}
-			return arr[i];
-		} else {
-			return arr[last];
 		}
 	}
 
-	uint64_t min_hash() {
-		if (k < 16) {
-			int i = k - 1;
-			for (int j = k - 2; j >= 0; j--) {
-				if (arr[j] > arr[i]) {
-					i = j;
-				}
-			}
-			return ~(uint64_t)(arr[i] >> 32);
-		} else {
-			return ~(uint64_t)(arr[last] >> 32);
-		}
-	}
+	uint64_t min() { return indices[last]; }
 
-	void min_syncmer(std::vector<uint32_t> &vec) {
-		if (k < 16) {
-			unsigned int j = k - 1;
-			for (int l = k - 2; l >= 0; l--) {
-				if (arr[l] > arr[j]) {
-					j = l;
-				}
-			}
-			if (arr[j] >> 32 ==
-				std::max(uint32_t(arr[i] >> 32),
-						 uint32_t(arr[i ? i - 1 : k - 1] >> 32))) {
-				vec.emplace_back(arr[i]);
-			}
-		} else {
-			if (arr[last] >> 32 ==
-				std::max(uint32_t(arr[i] >> 32),
-						 uint32_t(arr[i ? i - 1 : k - 1] >> 32))) {
-				vec.emplace_back(arr[i]);
-			}
+	uint64_t min_hash() { return hashes[last]; }
+
+	void min_syncmer(std::vector<uint64_t> &vec) {
+		if (hashes[last] == std::min(hashes[i], hashes[i ? i - 1 : k - 1])) {
+			vec.emplace_back(indices[i]);
 		}
 	}
 
-	void min_syncmer(std::vector<std::pair<uint32_t, uint64_t>> &vec) {
-		if (k < 16) {
-			unsigned int j = k - 1;
-			for (int l = k - 2; l >= 0; l--) {
-				if (arr[l] > arr[j]) {
-					j = l;
-				}
-			}
-			if (arr[j] >> 32 ==
-				std::max(uint32_t(arr[i] >> 32),
-						 uint32_t(arr[i ? i - 1 : k - 1] >> 32))) {
-				vec.emplace_back(arr[i], ~(uint64_t)(arr[j] >> 32));
-			}
-		} else {
-			if (arr[last] >> 32 ==
-				std::max(uint32_t(arr[i] >> 32),
-						 uint32_t(arr[i ? i - 1 : k - 1] >> 32))) {
-				vec.emplace_back(arr[i], ~(uint64_t)(arr[last] >> 32));
-			}
+	void min_syncmer(std::vector<std::pair<uint64_t, uint64_t>> &vec) {
+		if (hashes[last] == std::min(hashes[i], hashes[i ? i - 1 : k - 1])) {
+			vec.emplace_back(indices[i], hashes[last]);
 		}
 	}
 };
+
 } // namespace digest::ds
 
 #endif // DATA_STRUCTURE_HPP
@@ -1,10 +1,20 @@
 #ifndef DIGESTER_HPP
 #define DIGESTER_HPP
 
+#include "digest/isa.hpp"
+#include "digest/packed_seq.hpp"
+#include <algorithm>
 #include <cstdint>
-#include <deque>
+#include <memory>
 #include <nthash/kmer.hpp>
 #include <nthash/nthash.hpp>
+#include <string>
+#include <type_traits>
+#include <vector>
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+	(defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#endif
 
 /**
  * @brief digest code.
@@ -65,14 +75,215 @@ enum class BadCharPolicy {
 	SKIPOVER
 };
 
+/**
+ * @internal
+ * @brief finds the first character in seq[from, to) that is (ACTG = true) or
+ * is not (ACTG = false) one of ACTGactg, 16 characters per step when the
+ * target has SSE2, which every x86-64 CPU does.
+ */
+template <bool ACTG>
+inline size_t find_by_ACTG_sse2(const char *seq, size_t from, size_t to) {
+	size_t i = from;
+	// setting bit 5 maps upper case letters to lower case, and no other byte
+	// onto acgt
+#if defined(__SSE2__)
+	const __m128i lower16 = _mm_set1_epi8(0x20);
+	const __m128i a16 = _mm_set1_epi8('a'), c16 = _mm_set1_epi8('c'),
+				  g16 = _mm_set1_epi8('g'), t16 = _mm_set1_epi8('t');
+	for (; i + 16 <= to; i += 16) {
+		__m128i x =
+			_mm_or_si128(_mm_loadu_si128((const __m128i *)(seq + i)), lower16);
+		__m128i ac =
+			_mm_or_si128(_mm_cmpeq_epi8(x, a16), _mm_cmpeq_epi8(x, c16));
+		__m128i gt =
+			_mm_or_si128(_mm_cmpeq_epi8(x, g16), _mm_cmpeq_epi8(x, t16));
+		uint32_t hits = (uint32_t)_mm_movemask_epi8(_mm_or_si128(ac, gt));
+		if (!ACTG) {
+			hits = ~hits & 0xFFFF;
+		}
+		if (hits) {
+			return i + __builtin_ctz(hits);
+		}
+	}
+#endif
+	for (; i < to; i++) {
+		char c = seq[i] | 0x20;
+		if ((c == 'a' || c == 'c' || c == 'g' || c == 't') == ACTG) {
+			return i;
+		}
+	}
+	return to;
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+	(defined(__GNUC__) || defined(__clang__))
+/**
+ * @internal
+ * @brief AVX2 version of find_by_ACTG_sse2(), 32 characters per step
+ */
+template <bool ACTG>
+__attribute__((target("avx2"))) size_t
+find_by_ACTG_avx2(const char *seq, size_t from, size_t to) {
+	size_t i = from;
+	const __m256i lower32 = _mm256_set1_epi8(0x20);
+	const __m256i a32 = _mm256_set1_epi8('a'), c32 = _mm256_set1_epi8('c'),
+				  g32 = _mm256_set1_epi8('g'), t32 = _mm256_set1_epi8('t');
+	for (; i + 32 <= to; i += 32) {
+		__m256i x = _mm256_or_si256(
+			_mm256_loadu_si256((const __m256i *)(seq + i)), lower32);
+		__m256i ac = _mm256_or_si256(_mm256_cmpeq_epi8(x, a32),
+									 _mm256_cmpeq_epi8(x, c32));
+		__m256i gt = _mm256_or_si256(_mm256_cmpeq_epi8(x, g32),
+									 _mm256_cmpeq_epi8(x, t32));
+		uint32_t hits = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(ac, gt));
+		if (!ACTG) {
+			hits = ~hits;
+		}
+		if (hits) {
+			return i + __builtin_ctz(hits);
+		}
+	}
+	return find_by_ACTG_sse2<ACTG>(seq, i, to);
+}
+#endif
+
+/**
+ * @internal
+ * @brief finds the first character in seq[from, to) that is (ACTG = true) or
+ * is not (ACTG = false) one of ACTGactg, with find_by_ACTG_avx2() if the CPU
+ * supports AVX2, and find_by_ACTG_sse2() otherwise.
+ */
+template <bool ACTG>
+inline size_t find_by_ACTG(const char *seq, size_t from, size_t to) {
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+	(defined(__GNUC__) || defined(__clang__))
+	if (get_isa() >= Isa::AVX2) {
+		return find_by_ACTG_avx2<ACTG>(seq, from, to);
+	}
+#endif
+	return find_by_ACTG_sse2<ACTG>(seq, from, to);
+}
+
+/**
+ * @brief finds the first character in seq[from, to) that is not one of
+ * ACTGactg, checking 32 characters per step when the CPU supports AVX2, and
+ * 16 with SSE2. <br>
+ * Time Complexity: O(to - from)
+ *
+ * @param seq
+ * @param from index to start searching from
+ * @param to index to stop searching at, exclusive
+ *
+ * @return size_t, index of the first non-ACTG character, or to if there is
+ * none
+ */
+inline size_t find_non_ACTG(const char *seq, size_t from, size_t to) {
+	return find_by_ACTG<false>(seq, from, to);
+}
+
+/**
+ * @brief finds the first character in seq[from, to) that is one of ACTGactg,
+ * i.e. the end of a run of non-ACTG characters such as N. <br>
+ * Time Complexity: O(to - from)
+ *
+ * @param seq
+ * @param from index to start searching from
+ * @param to index to stop searching at, exclusive
+ *
+ * @return size_t, index of the first ACTG character, or to if there is none
+ */
+inline size_t find_ACTG(const char *seq, size_t from, size_t to) {
+	return find_by_ACTG<true>(seq, from, to);
+}
+
+/**
+ * @internal
+ * @brief Fixed-capacity FIFO of characters. Used by Digester to hold the
+ * characters of previously appended sequences that still have to be rolled
+ * out. The storage is allocated once at construction, rounded up to a power of
+ * two so that indices wrap with a mask, and never grows, so rolling after
+ * append_seq() does not touch the allocator.
+ */
+class CharRing {
+  public:
+	/**
+	 * @param capacity maximum number of characters held at once
+	 */
+	explicit CharRing(unsigned capacity) {
+		size_t cap = 1;
+		while (cap < capacity) {
+			cap <<= 1;
+		}
+		buf.resize(cap);
+		mask = cap - 1;
+	}
+
+	size_t size() const { return tail - head; }
+
+	bool empty() const { return head == tail; }
+
+	char front() const { return buf[head & mask]; }
+
+	char operator[](size_t i) const { return buf[(head + i) & mask]; }
+
+	void pop_front() { head++; }
+
+	void push_back(char c) { buf[tail++ & mask] = c; }
+
+	void clear() { head = tail = 0; }
+
+	/**
+	 * @brief rotates the storage in place so the contents are contiguous
+	 *
+	 * @return pointer to the front character
+	 */
+	const char *linearize() {
+		size_t n = size();
+		std::rotate(buf.begin(), buf.begin() + (head & mask), buf.end());
+		head = 0;
+		tail = n;
+		return buf.data();
+	}
+
+  private:
+	std::vector<char> buf;
+	size_t mask;
+	size_t head = 0;
+	size_t tail = 0;
+};
+
+/**
+ * @internal
+ * @brief the digesters rolled together by Digester::roll_hashes_lanes(), one
+ * per lane. Lanes past the active ones repeat the first lane, so that a step
+ * function always works on all W lanes and writes the same values to the
+ * same place twice.
+ */
+template <unsigned W> struct LaneState {
+	/** next character rolled in, one pointer per lane */
+	const char *ins[W];
+	/** next character rolled out, one pointer per lane */
+	const char *outs[W];
+	uint64_t fhashes[W], rhashes[W];
+	/** all ones where the lane minimizes that hash, zero otherwise */
+	uint64_t canon_mask[W], forward_mask[W], reverse_mask[W];
+	unsigned ks[W];
+	uint64_t *hash_out[W];
+	uint32_t *pos_out[W];
+	uint32_t pos[W];
+};
+
 /**
  * @brief an abstract class for Digester objects.
  *
- * @tparam a BadCharPolicy enum value. The policy to adopt when handling
+ * @tparam P a BadCharPolicy enum value. The policy to adopt when handling
  * non-ACTG characters.
+ * @tparam K 0 to take the kmer size at runtime. Otherwise the kmer size is
+ * fixed at compile time to K, which lets the compiler fold it into the
+ * rolling hash. The constructors still take k, and it must equal K.
  *
  */
-template <BadCharPolicy P> class Digester {
+template <BadCharPolicy P, unsigned K = 0> class Digester {
   public:
 	/**
 	 * @param seq const char pointer pointing to the c-string of DNA sequence to
@@ -83,14 +294,16 @@ template <BadCharPolicy P> class Digester {
 	 * @param minimized_h whether we are minimizing the canonical, forward, or
 	 * reverse hash
 	 *
-	 * @throws BadConstructionException Thrown if k is less than 4,
-	 * or if the starting position is after the end of the string
+	 * @throws BadConstructionException Thrown if k is less than 4, if K is
+	 * not 0 and k is not K, or if the starting position is after the end of
+	 * the string
 	 */
 	Digester(const char *seq, size_t len, unsigned k, size_t start = 0,
 			 MinimizedHashType minimized_h = MinimizedHashType::CANON)
 		: seq(seq), len(len), offset(0), start(start), end(start + k), chash(0),
-		  fhash(0), rhash(0), k(k), minimized_h(minimized_h) {
-		if (k < 4 or start >= len or (int) minimized_h > 2) {
+		  fhash(0), rhash(0), k(k), c_outs(k), minimized_h(minimized_h) {
+		if (k < 4 or (K != 0 and k != K) or start >= len or
+			(int)minimized_h > 2) {
 			throw BadConstructionException();
 		}
 		init_hash();
@@ -103,13 +316,46 @@ template <BadCharPolicy P> class Digester {
 	 * @param minimized_h whether we are minimizing the canonical, forward, or
 	 * reverse hash
 	 *
-	 * @throws BadConstructionException Thrown if k is less than 4,
-	 * or if the starting position is after the end of the string
+	 * @throws BadConstructionException Thrown if k is less than 4, if K is
+	 * not 0 and k is not K, or if the starting position is after the end of
+	 * the string
 	 */
 	Digester(const std::string &seq, unsigned k, size_t start = 0,
 			 MinimizedHashType minimized_h = MinimizedHashType::CANON)
 		: Digester(seq.c_str(), seq.size(), k, start, minimized_h) {}
 
+	/**
+	 * @brief digests a 2-bit packed sequence, see unpack_bases() for the
+	 * encoding. The bases are unpacked packed_block at a time into a buffer
+	 * owned by the digester and rolled from there, as if each block had been
+	 * passed to append_seq(), so the whole sequence is never unpacked.
+	 * Positions are still indices into the packed sequence.
+	 *
+	 * @param packed 2-bit packed DNA sequence, memory is owned by the user
+	 * @param len number of bases in packed
+	 * @param n_intervals positions of the non-ACTG characters, handled
+	 * according to P, memory is owned by the user
+	 * @param k kmer size.
+	 * @param start 0-indexed position in packed to start hashing from.
+	 * @param minimized_h whether we are minimizing the canonical, forward, or
+	 * reverse hash
+	 *
+	 * @throws BadConstructionException Thrown if k is less than 4, if K is
+	 * not 0 and k is not K, or if the starting position is after the end of
+	 * the sequence
+	 */
+	Digester(const uint8_t *packed, size_t len, const NIntervals &n_intervals,
+			 unsigned k, size_t start = 0,
+			 MinimizedHashType minimized_h = MinimizedHashType::CANON)
+		: seq(nullptr), len(0), offset(0), start(0), end(k), chash(0),
+		  fhash(0), rhash(0), k(k), c_outs(k), minimized_h(minimized_h) {
+		if (k < 4 or (K != 0 and k != K) or start >= len or
+			(int)minimized_h > 2) {
+			throw BadConstructionException();
+		}
+		init_packed(packed, len, n_intervals, start);
+	}
+
 	virtual ~Digester() = default;
 
 	/**
@@ -143,6 +389,172 @@ template <BadCharPolicy P> class Digester {
 		}
 	};
 
+	/**
+	 * @brief writes the hash selected by get_minimized_h() and the position,
+	 * as defined by get_pos(), of up to amount consecutive valid k-mers into
+	 * caller owned arrays, starting with the current k-mer. The hash type and
+	 * policy are resolved once per call, so the inner loop only rolls the hash
+	 * and stores the result. <br>
+	 * Time Complexity: O(amount)
+	 *
+	 * @param amount maximum number of k-mers to write
+	 * @param hashes array of at least amount uint64_t, the hashes will go
+	 * there
+	 * @param positions array of at least amount uint32_t, the positions will
+	 * go there
+	 *
+	 * @return size_t, the number of k-mers written. Less than amount only if
+	 * the end of the sequence was reached
+	 */
+	size_t roll_hashes(size_t amount, uint64_t *hashes, uint32_t *positions) {
+		switch (minimized_h) {
+		case MinimizedHashType::FORWARD:
+			return roll_hashes_impl<MinimizedHashType::FORWARD>(
+				amount, hashes, positions);
+		case MinimizedHashType::REVERSE:
+			return roll_hashes_impl<MinimizedHashType::REVERSE>(
+				amount, hashes, positions);
+		default:
+			return roll_hashes_impl<MinimizedHashType::CANON>(amount, hashes,
+															  positions);
+		}
+	}
+
+	/**
+	 * @brief same as roll_hashes(), but for several digesters at once. While
+	 * none of them has characters left over from append_seq() or is about to
+	 * cross a character it has to handle specially, the k-mers of all of them
+	 * are rolled in lockstep by step, one digester per lane. Each digester
+	 * produces exactly what its own roll_hashes() would have. <br>
+	 * Time Complexity: O(amount * count)
+	 *
+	 * @tparam W maximum number of digesters rolled together
+	 *
+	 * @param digs array of count digester pointers
+	 * @param count number of digesters, at most W
+	 * @param amount maximum number of k-mers to write per digester
+	 * @param hashes hashes[i] is an array of at least amount uint64_t for
+	 * digs[i]
+	 * @param positions positions[i] is an array of at least amount uint32_t
+	 * for digs[i]
+	 * @param written written[i] will be set to the number of k-mers written
+	 * for digs[i]
+	 * @param step rolls all lanes a number of steps, roll_lanes() or a
+	 * function that writes the same
+	 */
+	template <unsigned W, class Step>
+	static inline __attribute__((always_inline)) void
+	roll_hashes_lanes(Digester **digs, unsigned count, size_t amount,
+					  uint64_t **hashes, uint32_t **positions, size_t *written,
+					  Step step) {
+		// number of plain rolling steps each digester is known to have left
+		size_t runs[W];
+		for (unsigned l = 0; l < count; l++) {
+			written[l] = 0;
+			runs[l] = 0;
+		}
+
+		while (true) {
+			unsigned lanes[W];
+			unsigned active = 0;
+			bool pending = false;
+			size_t steps = amount;
+			for (unsigned l = 0; l < count; l++) {
+				Digester *dig = digs[l];
+				if (!dig->is_valid_hash || written[l] == amount) {
+					continue;
+				}
+				if (runs[l] == 0) {
+					runs[l] = dig->clean_run(amount - written[l]);
+				}
+				if (runs[l] == 0) {
+					// leftover characters, a bad character or the end of
+					// the sequence, let the regular path handle one k-mer
+					written[l] += dig->roll_hashes(1, hashes[l] + written[l],
+												   positions[l] + written[l]);
+					pending = true;
+					continue;
+				}
+				lanes[active++] = l;
+				steps = std::min(steps, runs[l]);
+			}
+			if (active == 0) {
+				if (pending) {
+					continue;
+				}
+				return;
+			}
+
+			LaneState<W> state;
+			for (unsigned j = 0; j < W; j++) {
+				unsigned l = lanes[j < active ? j : 0];
+				Digester *dig = digs[l];
+				state.hash_out[j] = hashes[l] + written[l];
+				state.pos_out[j] = positions[l] + written[l];
+				state.pos[j] = dig->offset + dig->start;
+				state.ins[j] = dig->seq + dig->end;
+				state.outs[j] = dig->seq + dig->start;
+				state.fhashes[j] = dig->fhash;
+				state.rhashes[j] = dig->rhash;
+				state.ks[j] = dig->kmer_len();
+				state.canon_mask[j] =
+					-(uint64_t)(dig->minimized_h == MinimizedHashType::CANON);
+				state.forward_mask[j] =
+					-(uint64_t)(dig->minimized_h == MinimizedHashType::FORWARD);
+				state.reverse_mask[j] =
+					-(uint64_t)(dig->minimized_h == MinimizedHashType::REVERSE);
+			}
+
+			step(state, steps);
+
+			for (unsigned j = 0; j < active; j++) {
+				Digester *dig = digs[lanes[j]];
+				dig->start += steps;
+				dig->end += steps;
+				dig->fhash = state.fhashes[j];
+				dig->rhash = state.rhashes[j];
+				dig->chash = nthash::canonical(dig->fhash, dig->rhash);
+				written[lanes[j]] += steps;
+				runs[lanes[j]] -= steps;
+			}
+		}
+	}
+
+	/**
+	 * @brief the step function of roll_hashes_lanes() in plain scalar code,
+	 * rolls every lane of state steps times and writes the selected hash and
+	 * the position of each k-mer before it is rolled past. Only the hashes
+	 * in state are meaningful afterwards.
+	 *
+	 * @param state lanes set up by roll_hashes_lanes(), the next steps
+	 * characters of every lane must be ACTG, or any character under
+	 * WRITEOVER
+	 * @param steps number of k-mers to roll per lane
+	 */
+	template <unsigned W>
+	static inline void roll_lanes(LaneState<W> &state, size_t steps) {
+		for (size_t t = 0; t < steps; t++) {
+			for (unsigned j = 0; j < W; j++) {
+				char in = state.ins[j][t];
+				char out = state.outs[j][t];
+				if (P == BadCharPolicy::WRITEOVER) {
+					in = write_over[(unsigned char)in];
+					out = write_over[(unsigned char)out];
+				}
+				uint64_t fhash = state.fhashes[j];
+				uint64_t rhash = state.rhashes[j];
+				state.hash_out[j][t] =
+					(nthash::canonical(fhash, rhash) & state.canon_mask[j]) |
+					(fhash & state.forward_mask[j]) |
+					(rhash & state.reverse_mask[j]);
+				state.pos_out[j][t] = state.pos[j] + t;
+				unsigned lane_k = K != 0 ? K : state.ks[j];
+				state.fhashes[j] = next_forward_hash(fhash, lane_k, out, in);
+				state.rhashes[j] = next_reverse_hash(rhash, lane_k, out, in);
+			}
+		}
+	}
+
 	/**
 	 * @brief gets the positions, as defined by get_pos(), of minimizers up to
 	 * the amount specified
@@ -166,6 +578,32 @@ template <BadCharPolicy P> class Digester {
 	roll_minimizer(unsigned amount,
 				   std::vector<std::pair<uint32_t, uint32_t>> &vec) = 0;
 
+	/**
+	 * @brief same as the roll_minimizer that takes a vector of uint32_t,
+	 * except the positions are not truncated to 32 bits, for sequences longer
+	 * than 2^32 bases
+	 *
+	 * @param amount number of minimizers you want to generate
+	 * @param vec a reference to a vector of uint64_t, the positions returned
+	 * will go there
+	 */
+	virtual void roll_minimizer(unsigned amount,
+								std::vector<uint64_t> &vec) = 0;
+
+	/**
+	 * @brief same as the roll_minimizer that takes a vector of pairs of
+	 * uint32_t, except neither the positions nor the hashes are truncated to 32
+	 * bits. The hashes are as wide as the ones the minimizers are selected
+	 * with, refer to the child class.
+	 *
+	 * @param amount number of minimizers you want to generate
+	 * @param vec a reference to a vector of a pair of uint64_t, the positions
+	 * and hashes returned will go there
+	 */
+	virtual void
+	roll_minimizer(unsigned amount,
+				   std::vector<std::pair<uint64_t, uint64_t>> &vec) = 0;
+
 	/**
 	 * @return current index of the first character of the current kmer that has
 	 * been hashed. Sequences that have been appended onto each other count as 1
@@ -176,6 +614,29 @@ template <BadCharPolicy P> class Digester {
 	 */
 	size_t get_pos() { return offset + start - c_outs.size(); }
 
+	/**
+	 * @brief copies the characters of the current k-mer into out, as they
+	 * were hashed, so with WRITEOVER, non-ACTG characters are 'A'. Only
+	 * meaningful if get_is_valid_hash() is true.
+	 *
+	 * @param out at least k characters
+	 */
+	void get_kmer(char *out) {
+		size_t c = c_outs.size();
+		for (size_t i = 0; i < c; i++) {
+			out[i] = c_outs[i];
+		}
+		for (size_t i = c; i < k; i++) {
+			out[i] = write_over[(unsigned char)seq[end - k + i]];
+		}
+	}
+
+	/**
+	 * @return char, the last character of the current k-mer, as it was
+	 * hashed, see get_kmer()
+	 */
+	char get_last_char() { return write_over[(unsigned char)seq[end - 1]]; }
+
 	/**
 	 * @return uint64_t, the canonical hash of the kmer that was rolled over
 	 * when roll_one was last called (roll_minimizer() calls roll_one()
@@ -207,6 +668,7 @@ template <BadCharPolicy P> class Digester {
 	 * greater than the length of the string
 	 */
 	virtual void new_seq(const char *seq, size_t len, size_t start) {
+		this->packed = nullptr;
 		this->seq = seq;
 		this->len = len;
 		this->offset = 0;
@@ -233,6 +695,27 @@ template <BadCharPolicy P> class Digester {
 		new_seq(seq.c_str(), seq.size(), pos);
 	}
 
+	/**
+	 * @brief replaces the current sequence with a 2-bit packed one, see the
+	 * packed constructor
+	 *
+	 * @param packed 2-bit packed DNA sequence
+	 * @param len number of bases in packed
+	 * @param n_intervals positions of the non-ACTG characters
+	 * @param start position in packed to start from
+	 *
+	 * @throws BadConstructionException thrown if the starting position is
+	 * greater than the length of the sequence
+	 */
+	virtual void new_seq(const uint8_t *packed, size_t len,
+						 const NIntervals &n_intervals, size_t start) {
+		is_valid_hash = false;
+		if (start >= len) {
+			throw BadConstructionException();
+		}
+		init_packed(packed, len, n_intervals, start);
+	}
+
 	/**
 	 * @brief simulates the appending of a new sequence to the end of the old
 	 * sequence. The old sequence will no longer be stored, but the rolling
@@ -251,6 +734,9 @@ template <BadCharPolicy P> class Digester {
 	 * not at the end of the current sequence
 	 */
 	void append_seq(const char *seq, size_t len) {
+		if (packed_left()) {
+			throw NotRolledTillEndException();
+		}
 		if (P == BadCharPolicy::SKIPOVER) {
 			append_seq_skip_over(seq, len);
 		} else {
@@ -275,10 +761,34 @@ template <BadCharPolicy P> class Digester {
 	 * not at the end of the current sequence
 	 */
 	void append_seq(const std::string &seq) {
-		if (P == BadCharPolicy::SKIPOVER) {
-			append_seq_skip_over(seq.c_str(), seq.size());
-		} else {
-			append_seq_write_over(seq.c_str(), seq.size());
+		append_seq(seq.c_str(), seq.size());
+	}
+
+	/**
+	 * @brief same as the other append_seq functions, but the appended sequence
+	 * is 2-bit packed, see the packed constructor. Can also be called after a
+	 * sequence given as characters and vice versa.
+	 *
+	 * @param packed 2-bit packed DNA sequence to be appended
+	 * @param len number of bases in packed
+	 * @param n_intervals positions of the non-ACTG characters
+	 *
+	 * @throws NotRolledTillEndException Thrown when the internal iterator is
+	 * not at the end of the current sequence
+	 */
+	void append_seq(const uint8_t *packed, size_t len,
+					const NIntervals &n_intervals) {
+		if (end < this->len || packed_left()) {
+			throw NotRolledTillEndException();
+		}
+		this->packed = packed;
+		packed_len = len;
+		packed_next = 0;
+		this->n_intervals = &n_intervals;
+		n_next = 0;
+		if (packed_left()) {
+			append_block();
+			unpack_next();
 		}
 	}
 
@@ -326,6 +836,41 @@ template <BadCharPolicy P> class Digester {
 	 */
 	bool is_ACTG(char in) { return actg[in]; }
 
+	// maps upper and lowercase ACTG characters to themselves and everything
+	// else to 'A', the character the WRITEOVER policy substitutes
+	static constexpr std::array<char, 256> write_over = [] {
+		std::array<char, 256> table{};
+		for (unsigned c = 0; c < 256; c++) {
+			table[c] = 'A';
+		}
+		for (char c : {'A', 'C', 'G', 'T', 'a', 'c', 'g', 't'}) {
+			table[(unsigned char)c] = c;
+		}
+		return table;
+	}();
+
+	/**
+	 * @internal
+	 * @brief Helper function for roll_hashes_lanes()
+	 *
+	 * @param max upper bound on the result
+	 *
+	 * @return size_t, how many times the hash can be rolled with only the
+	 * plain rolling step, i.e. no characters are left over from append_seq()
+	 * and the next characters to be rolled in are inside the sequence (and
+	 * ACTG under SKIPOVER)
+	 */
+	size_t clean_run(size_t max) {
+		if (!c_outs.empty() || end >= len) {
+			return 0;
+		}
+		size_t run = std::min(max, len - end);
+		if (P == BadCharPolicy::SKIPOVER) {
+			return find_non_ACTG(seq, end, end + run) - end;
+		}
+		return run;
+	}
+
 	/**
 	 * @internal
 	 *
@@ -349,13 +894,12 @@ template <BadCharPolicy P> class Digester {
 			throw NotRolledTillEndException();
 		}
 		offset += this->len;
-		size_t ind = this->len - 1;
 
 		/*
 			this is for the case where we call append_seq after having
-		   previously called append_seq and not having gotten through the deque
-			In such a case, since append_seq initializes a hash, we need to get
-		   rid of the first character in the deque since if we just initialized
+		   previously called append_seq and not having gotten through the ring
+		   buffer. In such a case, since append_seq initializes a hash, we need
+		   to get rid of the first character in the ring buffer since if we just initialized
 		   the hash without doing this, it would be identical the the current
 		   hash held by the object
 
@@ -364,34 +908,28 @@ template <BadCharPolicy P> class Digester {
 		   previous append_seq call, plus the the amount of ACTG characters
 		   after the last non-ACTG character in the original string summed to be
 		   less than k In this case, it would not be correct to remove the first
-		   character in the deque
+		   character in the ring buffer
 		*/
 		if ((start != end || c_outs.size() == k) && c_outs.size() > 0) {
 			c_outs.pop_front();
 		}
 
 		// the following copies in characters from the end of the old sequence
-		// into the deque
-		std::vector<char> temp_vec;
-		while (temp_vec.size() + c_outs.size() < k - 1 && ind >= start) {
-			if (!is_ACTG(this->seq[ind]))
+		// into the ring buffer
+		size_t tail = 0;
+		while (tail + c_outs.size() < k - 1 && this->len - tail > start) {
+			if (!is_ACTG(this->seq[this->len - 1 - tail]))
 				break;
-
-			temp_vec.push_back(this->seq[ind]);
-			if (ind == 0)
-				break;
-
-			ind--;
+			tail++;
 		}
-		for (std::vector<char>::reverse_iterator rit = temp_vec.rbegin();
-			 rit != temp_vec.rend(); rit++) {
-			c_outs.push_back(*rit);
+		for (size_t i = this->len - tail; i < this->len; i++) {
+			c_outs.push_back(this->seq[i]);
 		}
 
 		// the following copies in characters from the front of the new sequence
 		// if there weren't enough non-ACTG characters at the end of the old
 		// sequence
-		ind = 0;
+		size_t ind = 0;
 		start = 0;
 		end = 0;
 		while (c_outs.size() < k && ind < len) {
@@ -410,13 +948,12 @@ template <BadCharPolicy P> class Digester {
 			end++;
 		}
 
-		// the following initializes a hash if we managed to fill the deque
+		// the following initializes a hash if we managed to fill the ring
+		// buffer
 		if (c_outs.size() == k) {
-			std::string temp(c_outs.begin(), c_outs.end());
-			// nthash::ntc64(temp.c_str(), k, fhash, rhash, chash,
-			// locn_useless);
-			fhash = base_forward_hash(temp.c_str(), k);
-			rhash = base_reverse_hash(temp.c_str(), k);
+			const char *temp = c_outs.linearize();
+			fhash = base_forward_hash(temp, kmer_len());
+			rhash = base_reverse_hash(temp, kmer_len());
 			chash = nthash::canonical(fhash, rhash);
 			is_valid_hash = true;
 		}
@@ -429,35 +966,25 @@ template <BadCharPolicy P> class Digester {
 			throw NotRolledTillEndException();
 		}
 		offset += this->len;
-		size_t ind = this->len - 1;
 
 		if ((start != end || c_outs.size() == k) && c_outs.size() > 0) {
 			c_outs.pop_front();
 		}
 
 		// the following copies in characters from the end of the old sequence
-		// into the deque
-		std::vector<char> temp_vec;
-		while (temp_vec.size() + c_outs.size() < k - 1 && ind >= start) {
-			if (!is_ACTG(this->seq[ind])) {
-				temp_vec.push_back('A');
-			} else {
-				temp_vec.push_back(this->seq[ind]);
-			}
-			if (ind == 0)
-				break;
-
-			ind--;
+		// into the ring buffer
+		size_t tail = 0;
+		while (tail + c_outs.size() < k - 1 && this->len - tail > start) {
+			tail++;
 		}
-		for (std::vector<char>::reverse_iterator rit = temp_vec.rbegin();
-			 rit != temp_vec.rend(); rit++) {
-			c_outs.push_back(*rit);
+		for (size_t i = this->len - tail; i < this->len; i++) {
+			c_outs.push_back(is_ACTG(this->seq[i]) ? this->seq[i] : 'A');
 		}
 
 		// the following copies in characters from the front of the new sequence
 		// if there weren't enough non-ACTG characters at the end of the old
 		// sequence
-		ind = 0;
+		size_t ind = 0;
 		start = 0;
 		end = 0;
 		while (c_outs.size() < k && ind < len) {
@@ -472,13 +999,12 @@ template <BadCharPolicy P> class Digester {
 			end++;
 		}
 
-		// the following initializes a hash if we managed to fill the deque
+		// the following initializes a hash if we managed to fill the ring
+		// buffer
 		if (c_outs.size() == k) {
-			std::string temp(c_outs.begin(), c_outs.end());
-			// nthash::ntc64(temp.c_str(), k, fhash, rhash, chash,
-			// locn_useless);
-			fhash = base_forward_hash(temp.c_str(), k);
-			rhash = base_reverse_hash(temp.c_str(), k);
+			const char *temp = c_outs.linearize();
+			fhash = base_forward_hash(temp, kmer_len());
+			rhash = base_reverse_hash(temp, kmer_len());
 			chash = nthash::canonical(fhash, rhash);
 			is_valid_hash = true;
 		}
@@ -489,21 +1015,16 @@ template <BadCharPolicy P> class Digester {
 	bool init_hash_skip_over() {
 		c_outs.clear();
 		while (end - 1 < len) {
-			bool works = true;
-			for (size_t i = start; i < end; i++) {
-				if (!is_ACTG(seq[i])) {
-					start = i + 1;
-					end = start + k;
-					works = false;
-					break;
-				}
-			}
-			if (!works) {
+			size_t bad = find_non_ACTG(seq, start, end);
+			if (bad != end) {
+				// skip the whole run of bad characters at once
+				start = find_ACTG(seq, bad + 1, len);
+				end = start + k;
 				continue;
 			}
 			// nthash::ntc64(seq + start, k, fhash, rhash, chash, locn_useless);
-			fhash = base_forward_hash(seq + start, k);
-			rhash = base_reverse_hash(seq + start, k);
+			fhash = base_forward_hash(seq + start, kmer_len());
+			rhash = base_reverse_hash(seq + start, kmer_len());
 			chash = nthash::canonical(fhash, rhash);
 			is_valid_hash = true;
 			return true;
@@ -527,8 +1048,8 @@ template <BadCharPolicy P> class Digester {
 			}
 
 			// nthash::ntc64(seq + start, k, fhash, rhash, chash, locn_useless);
-			fhash = base_forward_hash(init_str.c_str(), k);
-			rhash = base_reverse_hash(init_str.c_str(), k);
+			fhash = base_forward_hash(init_str.c_str(), kmer_len());
+			rhash = base_reverse_hash(init_str.c_str(), kmer_len());
 			chash = nthash::canonical(fhash, rhash);
 			is_valid_hash = true;
 			return true;
@@ -543,29 +1064,33 @@ template <BadCharPolicy P> class Digester {
 		}
 		if (end >= len) {
 			is_valid_hash = false;
-			return false;
+			return unpack_next();
 		}
-		if (c_outs.size() > 0) {
+		if (!c_outs.empty()) {
 			if (is_ACTG(seq[end])) {
-				fhash = next_forward_hash(fhash, k, c_outs.front(), seq[end]);
-				rhash = next_reverse_hash(rhash, k, c_outs.front(), seq[end]);
+				fhash = next_forward_hash(fhash, kmer_len(), c_outs.front(),
+										  seq[end]);
+				rhash = next_reverse_hash(rhash, kmer_len(), c_outs.front(),
+										  seq[end]);
 				c_outs.pop_front();
 				end++;
 				chash = nthash::canonical(fhash, rhash);
 				return true;
 			} else {
 				// c_outs will contain at most k-1 characters, so if we jump to
-				// end + 1, we won't consider anything else in deque so we
-				// should clear it
+				// end + 1, we won't consider anything else in the ring buffer
+				// so we should clear it
 				c_outs.clear();
 				start = end + 1;
 				end = start + k;
-				return init_hash();
+				return init_hash() || unpack_next();
 			}
 		} else {
 			if (is_ACTG(seq[end])) {
-				fhash = next_forward_hash(fhash, k, seq[start], seq[end]);
-				rhash = next_reverse_hash(rhash, k, seq[start], seq[end]);
+				fhash = next_forward_hash(fhash, kmer_len(), seq[start],
+										  seq[end]);
+				rhash = next_reverse_hash(rhash, kmer_len(), seq[start],
+										  seq[end]);
 				start++;
 				end++;
 				chash = nthash::canonical(fhash, rhash);
@@ -573,7 +1098,7 @@ template <BadCharPolicy P> class Digester {
 			} else {
 				start = end + 1;
 				end = start + k;
-				return init_hash();
+				return init_hash() || unpack_next();
 			}
 		}
 	}
@@ -584,19 +1109,21 @@ template <BadCharPolicy P> class Digester {
 		}
 		if (end >= len) {
 			is_valid_hash = false;
-			return false;
+			return unpack_next();
 		}
 		char next_char = is_ACTG(seq[end]) ? seq[end] : 'A';
-		if (c_outs.size() > 0) {
-			fhash = next_forward_hash(fhash, k, c_outs.front(), next_char);
-			rhash = next_reverse_hash(rhash, k, c_outs.front(), next_char);
+		if (!c_outs.empty()) {
+			fhash = next_forward_hash(fhash, kmer_len(), c_outs.front(),
+									  next_char);
+			rhash = next_reverse_hash(rhash, kmer_len(), c_outs.front(),
+									  next_char);
 			c_outs.pop_front();
 			end++;
 
 		} else {
 			char out_char = is_ACTG(seq[start]) ? seq[start] : 'A';
-			fhash = next_forward_hash(fhash, k, out_char, next_char);
-			rhash = next_reverse_hash(rhash, k, out_char, next_char);
+			fhash = next_forward_hash(fhash, kmer_len(), out_char, next_char);
+			rhash = next_reverse_hash(rhash, kmer_len(), out_char, next_char);
 			start++;
 			end++;
 		}
@@ -604,7 +1131,198 @@ template <BadCharPolicy P> class Digester {
 		return true;
 	}
 
-	// sequence to be digested, memory is owned by the user
+	/**
+	 * @internal
+	 * @brief returns the hash selected by H
+	 */
+	template <MinimizedHashType H> uint64_t selected_hash() {
+		if (H == MinimizedHashType::CANON) {
+			return chash;
+		} else if (H == MinimizedHashType::FORWARD) {
+			return fhash;
+		} else {
+			return rhash;
+		}
+	}
+
+	/**
+	 * @internal
+	 * @brief passes a minimizer to a sink given to roll_minimizer(). The sink
+	 * is called with the position alone if it accepts that, otherwise with the
+	 * position and get_hash(), so the hash is only looked up when needed.
+	 *
+	 * @return bool, false if the sink returned false to stop rolling
+	 */
+	template <class Sink, class GetHash>
+	static bool emit(Sink &sink, size_t pos, GetHash get_hash) {
+		if constexpr (std::is_invocable_v<Sink &, size_t>) {
+			if constexpr (std::is_same_v<std::invoke_result_t<Sink &, size_t>,
+										 bool>) {
+				return sink(pos);
+			} else {
+				sink(pos);
+				return true;
+			}
+		} else {
+			if constexpr (std::is_same_v<
+							  std::invoke_result_t<Sink &, size_t,
+												   decltype(get_hash())>,
+							  bool>) {
+				return sink(pos, get_hash());
+			} else {
+				sink(pos, get_hash());
+				return true;
+			}
+		}
+	}
+
+	template <MinimizedHashType H>
+	size_t roll_hashes_impl(size_t amount, uint64_t *hashes,
+							uint32_t *positions) {
+		size_t n = 0;
+		while (n < amount && is_valid_hash) {
+			// characters left over from an appended sequence go through the
+			// regular path, there are at most k of them
+			if (!c_outs.empty()) {
+				hashes[n] = selected_hash<H>();
+				positions[n++] = get_pos();
+				roll_one();
+				continue;
+			}
+
+			// every remaining k-mer lies inside seq, so the out character
+			// can be read directly and get_pos() is just offset + start
+			while (n < amount) {
+				hashes[n] = selected_hash<H>();
+				positions[n++] = offset + start;
+
+				if (end >= len) {
+					is_valid_hash = false;
+					if (!unpack_next()) {
+						return n;
+					}
+					// the next block may start with characters left over
+					break;
+				}
+				char in = seq[end];
+				char out = seq[start];
+				if (!is_ACTG(in)) {
+					if (P == BadCharPolicy::SKIPOVER) {
+						start = end + 1;
+						end = start + k;
+						if (init_hash()) {
+							continue;
+						}
+						if (!unpack_next()) {
+							return n;
+						}
+						break;
+					}
+					in = 'A';
+				}
+				if (P == BadCharPolicy::WRITEOVER && !is_ACTG(out)) {
+					out = 'A';
+				}
+				fhash = next_forward_hash(fhash, kmer_len(), out, in);
+				rhash = next_reverse_hash(rhash, kmer_len(), out, in);
+				chash = nthash::canonical(fhash, rhash);
+				start++;
+				end++;
+			}
+		}
+		return n;
+	}
+
+	/**
+	 * @internal
+	 * @brief sets up digesting packed from base start on, and initializes
+	 * the first valid hash
+	 */
+	void init_packed(const uint8_t *packed, size_t len,
+					 const NIntervals &n_intervals, size_t start) {
+		this->packed = packed;
+		packed_len = len;
+		packed_next = start;
+		this->n_intervals = &n_intervals;
+		n_next = std::lower_bound(n_intervals.begin(), n_intervals.end(),
+								  std::make_pair(start, start),
+								  [](const std::pair<size_t, size_t> &a,
+									 const std::pair<size_t, size_t> &b) {
+									  return a.second <= b.first;
+								  }) -
+				 n_intervals.begin();
+
+		size_t n = std::min(packed_block, packed_len - packed_next);
+		unpack_block(blocks[0], n);
+		c_outs.clear();
+		this->seq = blocks[0]->data();
+		this->len = n;
+		offset = start;
+		this->start = 0;
+		end = k;
+		init_hash();
+		unpack_next();
+	}
+
+	/**
+	 * @internal
+	 * @return bool, true if part of the packed sequence still has to be
+	 * unpacked
+	 */
+	bool packed_left() {
+		return packed != nullptr && packed_next < packed_len;
+	}
+
+	/**
+	 * @internal
+	 * @brief unpacks the next n bases into block, which is replaced by a new
+	 * buffer if a copy of this digester may still be reading it
+	 */
+	void unpack_block(std::shared_ptr<std::string> &block, size_t n) {
+		if (!block || block.use_count() > 1) {
+			block = std::make_shared<std::string>();
+		}
+		block->resize(n);
+		unpack_bases(packed, packed_next, n, *n_intervals, n_next,
+					 &(*block)[0]);
+		packed_next += n;
+	}
+
+	/**
+	 * @internal
+	 * @brief appends the next block of the packed sequence, the current block
+	 * is kept alive until the characters append_seq needs are copied out
+	 */
+	void append_block() {
+		size_t n = std::min(packed_block, packed_len - packed_next);
+		unpack_block(blocks[1], n);
+		if (P == BadCharPolicy::SKIPOVER) {
+			append_seq_skip_over(blocks[1]->data(), n);
+		} else {
+			append_seq_write_over(blocks[1]->data(), n);
+		}
+		std::swap(blocks[0], blocks[1]);
+	}
+
+	/**
+	 * @internal
+	 * @brief called when the end of the current sequence was reached without
+	 * a valid hash, appends blocks of the packed sequence until there is one
+	 *
+	 * @return bool, the new value of is_valid_hash
+	 */
+	bool unpack_next() {
+		while (!is_valid_hash && packed_left()) {
+			append_block();
+		}
+		return is_valid_hash;
+	}
+
+	// number of bases of a packed sequence unpacked at a time
+	static constexpr size_t packed_block = 1 << 16;
+
+	// sequence to be digested, memory is owned by the user, or points into
+	// blocks[0] when digesting a packed sequence
 	const char *seq;
 
 	// length of seq
@@ -633,9 +1351,14 @@ template <BadCharPolicy P> class Digester {
 	// length of kmer
 	unsigned k;
 
-	// deque of characters to be rolled out in the rolling hash from left to
-	// right
-	std::deque<char> c_outs;
+	/**
+	 * @return unsigned, the kmer size, a compile time constant when K is not 0
+	 */
+	unsigned kmer_len() const { return K != 0 ? K : k; }
+
+	// ring buffer of characters to be rolled out in the rolling hash from left
+	// to right, holds at most k characters
+	CharRing c_outs;
 
 	// Hash value to be minimized, 0 for canonical, 1 for forward, 2 for reverse
 	MinimizedHashType minimized_h;
@@ -643,6 +1366,180 @@ template <BadCharPolicy P> class Digester {
 	// bool representing whether the current hash is meaningful, i.e.
 	// corresponds to the k-mer at get_pos()
 	bool is_valid_hash = false;
+
+	// packed sequence being digested, nullptr if the current sequence was
+	// given as characters, memory is owned by the user
+	const uint8_t *packed = nullptr;
+
+	// number of bases in packed
+	size_t packed_len = 0;
+
+	// index in packed of the first base that hasn't been unpacked yet
+	size_t packed_next = 0;
+
+	// N intervals of packed, memory is owned by the user
+	const NIntervals *n_intervals = nullptr;
+
+	// index of the first interval that may overlap bases that haven't been
+	// unpacked yet
+	size_t n_next = 0;
+
+	// the unpacked block seq points into, and the buffer the next block is
+	// unpacked into. Shared with copies of this digester, which unpack into
+	// a new buffer instead of one that is still shared
+	std::shared_ptr<std::string> blocks[2];
+};
+
+/**
+ * @brief Digester that only rolls hashes, it never selects any. Schemes that
+ * look at a second, shorter length than their k-mers, like the s-mers of
+ * SmerSyncmer and the t-mers of ModMinimizer, roll one alongside themselves
+ * and insert its hashes into a data structure with insert_until(). It counts
+ * how many of the inserted positions are consecutive, so the scheme knows
+ * when the data structure holds only the sub-k-mers of the current k-mer or
+ * window, and none from before a skipped character.
+ *
+ * @tparam P
+ */
+template <BadCharPolicy P> class SubHasher final : public Digester<P> {
+  public:
+	using Digester<P>::Digester;
+	using Digester<P>::selected_hash;
+
+	void roll_minimizer(unsigned, std::vector<uint32_t> &) override {}
+	void roll_minimizer(
+		unsigned, std::vector<std::pair<uint32_t, uint32_t>> &) override {}
+	void roll_minimizer(unsigned, std::vector<uint64_t> &) override {}
+	void roll_minimizer(
+		unsigned, std::vector<std::pair<uint64_t, uint64_t>> &) override {}
+
+	void new_seq(const char *seq, size_t len, size_t start) override {
+		reset_run();
+		Digester<P>::new_seq(seq, len, start);
+	}
+
+	void new_seq(const std::string &seq, size_t pos) override {
+		new_seq(seq.c_str(), seq.size(), pos);
+	}
+
+	void new_seq(const uint8_t *packed, size_t len,
+				 const NIntervals &n_intervals, size_t start) override {
+		reset_run();
+		Digester<P>::new_seq(packed, len, n_intervals, start);
+	}
+
+	/**
+	 * @brief inserts the hashes of the positions up to last into ds, rolling
+	 * past them
+	 *
+	 * @param ds
+	 * @param last
+	 */
+	template <MinimizedHashType H, class T>
+	void insert_until(T &ds, size_t last) {
+		while (this->is_valid_hash and this->get_pos() <= last) {
+			size_t pos = this->get_pos();
+			run = pos == next ? run + 1 : 1;
+			next = pos + 1;
+			ds.insert(pos, this->template selected_hash<H>());
+			this->roll_one();
+		}
+	}
+
+	/**
+	 * @brief inserts the hashes left at the end of the sequence into ds, so
+	 * the sequence can be appended to
+	 *
+	 * @param ds
+	 */
+	template <class T> void insert_rest(T &ds) {
+		switch (this->get_minimized_h()) {
+		case MinimizedHashType::FORWARD:
+			insert_until<MinimizedHashType::FORWARD>(ds, SIZE_MAX);
+			break;
+		case MinimizedHashType::REVERSE:
+			insert_until<MinimizedHashType::REVERSE>(ds, SIZE_MAX);
+			break;
+		default:
+			insert_until<MinimizedHashType::CANON>(ds, SIZE_MAX);
+		}
+	}
+
+	/**
+	 * @return size_t, the number of consecutive positions inserted last
+	 */
+	size_t get_run() { return run; }
+
+  private:
+	// number of consecutive positions inserted, and the position that
+	// continues them
+	size_t run = 0, next = 0;
+
+	void reset_run() {
+		run = 0;
+		next = 0;
+	}
+};
+
+/**
+ * @brief ModMin, WindowMin or Syncmer with its virtual functions bound at
+ * compile time. Calls through a Static<D> object, reference or pointer don't
+ * go through the vtable, because Static<D> is final, and the overrides call D's
+ * implementations directly, so the compiler can inline all of roll_minimizer()
+ * and new_seq() into the caller. This matters for many small calls, e.g. one
+ * new_seq() and roll_minimizer() per short read.
+ *
+ * A Static<D> is still a D and a Digester, so it can be passed to code that
+ * takes those by reference and only uses the virtual functions, which then
+ * behaves exactly like D.
+ *
+ * @tparam D the scheme, e.g. WindowMin<BadCharPolicy::SKIPOVER, ds::Adaptive>
+ */
+template <class D> class Static final : public D {
+  public:
+	using D::D;
+	using D::new_seq;
+	using D::roll_minimizer;
+
+	/**
+	 * @brief copies other, including where it is in its sequence. Explicit,
+	 * so a D is never copied by accident where a Static<D> is expected and
+	 * the copy rolled instead of other.
+	 *
+	 * @param other
+	 */
+	explicit Static(const D &other) : D(other) {}
+
+	void roll_minimizer(unsigned amount, std::vector<uint32_t> &vec) final {
+		D::roll_minimizer(amount, vec);
+	}
+
+	void roll_minimizer(unsigned amount,
+						std::vector<std::pair<uint32_t, uint32_t>> &vec) final {
+		D::roll_minimizer(amount, vec);
+	}
+
+	void roll_minimizer(unsigned amount, std::vector<uint64_t> &vec) final {
+		D::roll_minimizer(amount, vec);
+	}
+
+	void roll_minimizer(unsigned amount,
+						std::vector<std::pair<uint64_t, uint64_t>> &vec) final {
+		D::roll_minimizer(amount, vec);
+	}
+
+	void new_seq(const char *seq, size_t len, size_t start) final {
+		D::new_seq(seq, len, start);
+	}
+
+	void new_seq(const std::string &seq, size_t pos) final {
+		new_seq(seq.c_str(), seq.size(), pos);
+	}
+
+	void new_seq(const uint8_t *packed, size_t len,
+				 const NIntervals &n_intervals, size_t start) final {
+		D::new_seq(packed, len, n_intervals, start);
+	}
 };
 
 } // namespace digest
@@ -0,0 +1,180 @@
+#ifndef FACTORY_HPP
+#define FACTORY_HPP
+
+#include "digest/data_structure.hpp"
+#include "digest/digester.hpp"
+#include "digest/syncmer.hpp"
+#include "digest/window_minimizer.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Constructs window minimizers and syncmers for a large window that is
+ * only known at runtime, with the data structure recommended for it in
+ * data_structure.hpp. Naive, SegmentTree and Naive2 need the large window at
+ * compile time, so a digester is instantiated for every large window from
+ * MIN_TABLE_WINDOW to M, MAX_TABLE_WINDOW by default, and a table indexed by
+ * the large window picks its constructor. Larger windows use ds::Adaptive.
+ *
+ * Every entry of a table is compiled into the program, which takes about a
+ * second per entry with GCC at -O3. A program that only needs the factory
+ * for small windows, or for one scheme, can pass a smaller M: the largest
+ * gains over ds::Adaptive are for windows up to 16, see BM_WindowMinFactory.
+ *
+ * The digesters are returned through the Digester base class, so
+ * roll_minimizer() is a virtual call. That is one call per batch of
+ * minimizers, the data structure calls inside of it are still bound at
+ * compile time. The sink overloads of roll_minimizer() are templates and are
+ * not available through the base class.
+ */
+namespace digest::factory {
+
+/**
+ * @brief smallest large window in the table, a large window of 0 is rejected
+ * by the constructors
+ */
+constexpr unsigned MIN_TABLE_WINDOW = 1;
+
+/**
+ * @brief default largest large window in the table
+ */
+constexpr unsigned MAX_TABLE_WINDOW = 64;
+
+/**
+ * @brief The data structure recommended for a large window of w k-mers in
+ * data_structure.hpp, Naive for w < 12, SegmentTree for 12 <= w <= 16, and
+ * Naive2 otherwise.
+ *
+ * @tparam w
+ */
+template <unsigned w>
+using Best = std::conditional_t<
+	(w < 12), ds::Naive<w>,
+	std::conditional_t<(w <= 16), ds::SegmentTree<w>, ds::Naive2<w>>>;
+
+template <BadCharPolicy P, unsigned K>
+using Constructor = std::unique_ptr<Digester<P, K>> (*)(const char *, size_t,
+														 unsigned, unsigned,
+														 size_t,
+														 MinimizedHashType);
+
+template <class D, BadCharPolicy P, unsigned K>
+std::unique_ptr<Digester<P, K>>
+construct(const char *seq, size_t len, unsigned k, unsigned large_window,
+		  size_t start, MinimizedHashType minimized_h) {
+	return std::make_unique<D>(seq, len, k, large_window, start, minimized_h);
+}
+
+// D may have more template parameters after K, all of them defaulted
+template <template <BadCharPolicy, class, unsigned, class...> class D,
+		  BadCharPolicy P, unsigned K, unsigned... w>
+constexpr std::array<Constructor<P, K>, sizeof...(w)>
+make_table(std::integer_sequence<unsigned, w...>) {
+	return {{&construct<D<P, Best<MIN_TABLE_WINDOW + w>, K>, P, K>...}};
+}
+
+/**
+ * @brief constructs D<P, T, K>, where T is the data structure recommended for
+ * large_window if it is at most M, and ds::Adaptive otherwise. D may have
+ * more template parameters after K if they have defaults, like the order of
+ * WindowMin and Syncmer.
+ */
+template <template <BadCharPolicy, class, unsigned, class...> class D,
+		  BadCharPolicy P, unsigned K, unsigned M>
+std::unique_ptr<Digester<P, K>>
+dispatch(const char *seq, size_t len, unsigned k, unsigned large_window,
+		 size_t start, MinimizedHashType minimized_h) {
+	static_assert(M >= MIN_TABLE_WINDOW, "the table needs at least one entry");
+	static constexpr std::array<Constructor<P, K>, M - MIN_TABLE_WINDOW + 1>
+		table = make_table<D, P, K>(
+			std::make_integer_sequence<unsigned, M - MIN_TABLE_WINDOW + 1>());
+
+	if (large_window >= MIN_TABLE_WINDOW && large_window <= M) {
+		return table[large_window - MIN_TABLE_WINDOW](seq, len, k, large_window,
+													  start, minimized_h);
+	}
+	return construct<D<P, ds::Adaptive, K>, P, K>(seq, len, k, large_window,
+												  start, minimized_h);
+}
+
+/**
+ * @brief constructs a WindowMin with the data structure recommended for
+ * large_window, or ds::Adaptive if large_window is above M. The parameters
+ * are the same as the parameters of the WindowMin constructor.
+ *
+ * @param seq
+ * @param len
+ * @param k
+ * @param large_window
+ * @param start
+ * @param minimized_h
+ *
+ * @return std::unique_ptr<Digester<P, K>>, the window minimizer
+ *
+ * @throws BadWindowSizeException Thrown when large_window is passed in as 0
+ */
+template <BadCharPolicy P, unsigned K = 0, unsigned M = MAX_TABLE_WINDOW>
+std::unique_ptr<Digester<P, K>>
+window_min(const char *seq, size_t len, unsigned k, unsigned large_window,
+		   size_t start = 0,
+		   MinimizedHashType minimized_h = MinimizedHashType::CANON) {
+	return dispatch<WindowMin, P, K, M>(seq, len, k, large_window, start,
+										minimized_h);
+}
+
+/**
+ * @brief same as the other window_min, but takes the sequence as a string
+ */
+template <BadCharPolicy P, unsigned K = 0, unsigned M = MAX_TABLE_WINDOW>
+std::unique_ptr<Digester<P, K>>
+window_min(const std::string &seq, unsigned k, unsigned large_window,
+		   size_t start = 0,
+		   MinimizedHashType minimized_h = MinimizedHashType::CANON) {
+	return window_min<P, K, M>(seq.c_str(), seq.size(), k, large_window, start,
+							   minimized_h);
+}
+
+/**
+ * @brief constructs a Syncmer with the data structure recommended for
+ * large_window, or ds::Adaptive if large_window is above M. The parameters
+ * are the same as the parameters of the Syncmer constructor.
+ *
+ * @param seq
+ * @param len
+ * @param k
+ * @param large_window
+ * @param start
+ * @param minimized_h
+ *
+ * @return std::unique_ptr<Digester<P, K>>, the syncmer
+ *
+ * @throws BadWindowSizeException Thrown when large_window is passed in as 0
+ */
+template <BadCharPolicy P, unsigned K = 0, unsigned M = MAX_TABLE_WINDOW>
+std::unique_ptr<Digester<P, K>>
+syncmer(const char *seq, size_t len, unsigned k, unsigned large_window,
+		size_t start = 0,
+		MinimizedHashType minimized_h = MinimizedHashType::CANON) {
+	return dispatch<Syncmer, P, K, M>(seq, len, k, large_window, start,
+									  minimized_h);
+}
+
+/**
+ * @brief same as the other syncmer, but takes the sequence as a string
+ */
+template <BadCharPolicy P, unsigned K = 0, unsigned M = MAX_TABLE_WINDOW>
+std::unique_ptr<Digester<P, K>>
+syncmer(const std::string &seq, unsigned k, unsigned large_window,
+		size_t start = 0,
+		MinimizedHashType minimized_h = MinimizedHashType::CANON) {
+	return syncmer<P, K, M>(seq.c_str(), seq.size(), k, large_window, start,
+							minimized_h);
+}
+
+} // namespace digest::factory
+
+#endif // FACTORY_HPP
@@ -0,0 +1,52 @@
+#ifndef ISA_HPP
+#define ISA_HPP
+
+/**
+ * @brief Runtime detection of the SIMD instruction sets the kernels of digest
+ * are compiled for. The kernels are built with target attributes rather than
+ * -march flags, and the ones to call are picked from get_isa(), so the same
+ * binary runs on any x86-64 CPU and uses the widest vectors it has.
+ */
+namespace digest {
+
+/**
+ * @brief Instruction sets of the kernels, ordered, a CPU that supports one
+ * supports all before it
+ */
+enum class Isa {
+	/** no SIMD instruction set */
+	SCALAR,
+	/** AVX2 */
+	AVX2,
+	/** AVX-512F */
+	AVX512
+};
+
+/**
+ * @return Isa, the best instruction set supported by the CPU this is running
+ * on
+ */
+inline Isa detect_isa() {
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+	(defined(__GNUC__) || defined(__clang__))
+	if (__builtin_cpu_supports("avx512f")) {
+		return Isa::AVX512;
+	}
+	if (__builtin_cpu_supports("avx2")) {
+		return Isa::AVX2;
+	}
+#endif
+	return Isa::SCALAR;
+}
+
+/**
+ * @return Isa, the result of detect_isa(), detected once
+ */
+inline Isa get_isa() {
+	static const Isa isa = detect_isa();
+	return isa;
+}
+
+} // namespace digest
+
+#endif // ISA_HPP
@@ -2,8 +2,14 @@
 #define MOD_MINIMIZER_HPP
 
 #include "digest/digester.hpp"
+#include "digest/isa.hpp"
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+	(defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#endif
 
 namespace digest {
 
@@ -19,6 +25,313 @@ class BadModException : public std::exception {
 	}
 };
 
+/**
+ * @brief x % d for a divisor d that is fixed when it is constructed. The
+ * remainder is computed with two multiplications (Lemire, Kaser and Kurz
+ * 2019), or with a mask when d is a power of two, instead of a division,
+ * which is several times slower. It is exact for every 32-bit x and d > 0.
+ */
+class FastMod {
+  public:
+	/**
+	 * @param d the divisor, 0 is only allowed if operator() is never called
+	 */
+	explicit FastMod(uint32_t d)
+		: d(d), m(d ? UINT64_MAX / d + 1 : 0),
+		  mask((d & (d - 1)) == 0 ? d - 1 : 0), pow2((d & (d - 1)) == 0) {}
+
+	/**
+	 * @param x
+	 *
+	 * @return uint32_t, x % d
+	 */
+	uint32_t operator()(uint32_t x) const {
+		if (pow2) {
+			return x & mask;
+		}
+		// m * x holds the fractional part of x / d in 64 bits, multiplying
+		// it by d moves the remainder into the upper 64 bits
+		uint64_t frac = m * x;
+		return (uint32_t)(((__uint128_t)frac * d) >> 64);
+	}
+
+	/**
+	 * @return uint32_t, the divisor
+	 */
+	uint32_t divisor() const { return d; }
+
+  private:
+	uint32_t d;
+	uint64_t m;
+	uint32_t mask;
+	bool pow2;
+};
+
+/**
+ * @brief the test x % d == c, without computing x % d. It holds iff x >= c
+ * and d divides x - c, and for d = d_odd * 2^s, d divides y iff
+ * rotr(y * d_odd^-1, s) <= (2^32 - 1) / d, where d_odd^-1 is the inverse of
+ * d_odd modulo 2^32 (Granlund and Montgomery 1994). That is one 32-bit
+ * multiplication and a rotation, which, unlike FastMod, also exist for 8 or
+ * 16 lanes of 32 bits in AVX2 and AVX-512, see select_congruent().
+ */
+struct CongruenceTest {
+	uint32_t c, inv, limit;
+	unsigned shift;
+
+	/**
+	 * @param d the divisor, 0 is only allowed if operator() is never called
+	 * @param c the remainder, less than d
+	 */
+	CongruenceTest(uint32_t d, uint32_t c)
+		: c(c), inv(1), limit(d ? UINT32_MAX / d : 0),
+		  shift(d ? __builtin_ctz(d) : 0) {
+		uint32_t odd = d >> shift;
+		// Newton's iteration doubles the correct low bits, odd * odd is 1
+		// modulo 8 already
+		inv = odd;
+		for (int i = 0; i < 4; i++) {
+			inv *= 2 - odd * inv;
+		}
+	}
+
+	/**
+	 * @param x
+	 *
+	 * @return bool, x % d == c
+	 */
+	bool operator()(uint32_t x) const {
+		uint32_t y = (x - c) * inv;
+		y = y >> shift | y << ((32 - shift) & 31);
+		return (x >= c) & (y <= limit);
+	}
+};
+
+/**
+ * @brief scalar version of select_congruent(). It doesn't branch on the test
+ * either, every k-mer is written and only kept by advancing the output.
+ */
+template <bool Hashes>
+size_t select_congruent_scalar(const uint64_t *hashes,
+							   const uint32_t *positions, size_t n,
+							   const CongruenceTest &test, uint32_t *out_pos,
+							   uint64_t *out_hash) {
+	size_t m = 0;
+	for (size_t i = 0; i < n; i++) {
+		out_pos[m] = positions[i];
+		if (Hashes) {
+			out_hash[m] = hashes[i];
+		}
+		m += test((uint32_t)hashes[i]);
+	}
+	return m;
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+	(defined(__GNUC__) || defined(__clang__))
+/**
+ * @brief permutations for _mm256_permutevar8x32_epi32() that move the 32-bit
+ * lanes set in a mask of 8 bits, or the 64-bit lanes set in a mask of 4 bits,
+ * to the front, in order. AVX2 has no compress instruction.
+ */
+struct CompressTable {
+	alignas(32) uint32_t lanes32[256][8];
+	alignas(32) uint32_t lanes64[16][8];
+
+	CompressTable() {
+		for (unsigned mask = 0; mask < 256; mask++) {
+			unsigned j = 0;
+			for (unsigned l = 0; l < 8; l++) {
+				if (mask >> l & 1) {
+					lanes32[mask][j++] = l;
+				}
+			}
+			for (; j < 8; j++) {
+				lanes32[mask][j] = 0;
+			}
+		}
+		for (unsigned mask = 0; mask < 16; mask++) {
+			unsigned j = 0;
+			for (unsigned l = 0; l < 4; l++) {
+				if (mask >> l & 1) {
+					lanes64[mask][j++] = 2 * l;
+					lanes64[mask][j++] = 2 * l + 1;
+				}
+			}
+			for (; j < 8; j++) {
+				lanes64[mask][j] = 0;
+			}
+		}
+	}
+};
+
+inline const CompressTable &compress_table() {
+	static const CompressTable table;
+	return table;
+}
+
+/**
+ * @brief AVX2 version of select_congruent(), 8 k-mers at a time. The
+ * unsigned comparisons are done with max, the rotation with two shifts, and
+ * the selected lanes are packed with a permutation from CompressTable and
+ * written with a full store.
+ */
+template <bool Hashes>
+__attribute__((target("avx2"))) size_t
+select_congruent_avx2(const uint64_t *hashes, const uint32_t *positions,
+					  size_t n, const CongruenceTest &test, uint32_t *out_pos,
+					  uint64_t *out_hash) {
+	const CompressTable &table = compress_table();
+	const __m256i c = _mm256_set1_epi32(test.c);
+	const __m256i inv = _mm256_set1_epi32(test.inv);
+	const __m256i limit = _mm256_set1_epi32(test.limit);
+	const __m128i right = _mm_cvtsi32_si128(test.shift);
+	const __m128i left = _mm_cvtsi32_si128(32 - test.shift);
+	const __m256i low = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+	size_t m = 0, i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i h0 = _mm256_loadu_si256((const __m256i *)(hashes + i));
+		__m256i h1 = _mm256_loadu_si256((const __m256i *)(hashes + i + 4));
+		// the lower 32 bits of the 8 hashes
+		__m256i x = _mm256_permute2x128_si256(
+			_mm256_permutevar8x32_epi32(h0, low),
+			_mm256_permutevar8x32_epi32(h1, low), 0x20);
+		__m256i ge = _mm256_cmpeq_epi32(_mm256_max_epu32(x, c), x);
+		__m256i y = _mm256_mullo_epi32(_mm256_sub_epi32(x, c), inv);
+		y = _mm256_or_si256(_mm256_srl_epi32(y, right),
+							_mm256_sll_epi32(y, left));
+		__m256i le = _mm256_cmpeq_epi32(_mm256_max_epu32(y, limit), limit);
+		unsigned mask = _mm256_movemask_ps(
+			_mm256_castsi256_ps(_mm256_and_si256(ge, le)));
+
+		// m <= i, so the full stores stay within the first n slots
+		__m256i pos = _mm256_loadu_si256((const __m256i *)(positions + i));
+		_mm256_storeu_si256(
+			(__m256i *)(out_pos + m),
+			_mm256_permutevar8x32_epi32(
+				pos, _mm256_load_si256((const __m256i *)table.lanes32[mask])));
+		if (Hashes) {
+			_mm256_storeu_si256(
+				(__m256i *)(out_hash + m),
+				_mm256_permutevar8x32_epi32(
+					h0, _mm256_load_si256(
+							(const __m256i *)table.lanes64[mask & 15])));
+			_mm256_storeu_si256(
+				(__m256i *)(out_hash + m + __builtin_popcount(mask & 15)),
+				_mm256_permutevar8x32_epi32(
+					h1, _mm256_load_si256(
+							(const __m256i *)table.lanes64[mask >> 4])));
+		}
+		m += __builtin_popcount(mask);
+	}
+	return m + select_congruent_scalar<Hashes>(
+				   hashes + i, positions + i, n - i, test, out_pos + m,
+				   Hashes ? out_hash + m : out_hash);
+}
+
+/**
+ * @brief AVX-512 version of select_congruent(), 16 k-mers at a time. The
+ * selected lanes are packed with compress into a register and written with a
+ * full store, which is faster than compressing straight to memory on CPUs
+ * that microcode that form.
+ */
+template <bool Hashes>
+__attribute__((target("avx512f"))) size_t
+select_congruent_avx512(const uint64_t *hashes, const uint32_t *positions,
+						size_t n, const CongruenceTest &test,
+						uint32_t *out_pos, uint64_t *out_hash) {
+	const __m512i c = _mm512_set1_epi32(test.c);
+	const __m512i inv = _mm512_set1_epi32(test.inv);
+	const __m512i limit = _mm512_set1_epi32(test.limit);
+	const __m512i shift = _mm512_set1_epi32(test.shift);
+	const __m512i low =
+		_mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26,
+						  28, 30);
+	size_t m = 0, i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m512i h0 = _mm512_loadu_si512(hashes + i);
+		__m512i h1 = _mm512_loadu_si512(hashes + i + 8);
+		// the lower 32 bits of the 16 hashes
+		__m512i x = _mm512_permutex2var_epi32(h0, low, h1);
+		__mmask16 ge = _mm512_cmpge_epu32_mask(x, c);
+		__m512i y = _mm512_mullo_epi32(_mm512_sub_epi32(x, c), inv);
+		// the unmasked rotation trips -Wuninitialized in GCC 12
+		y = _mm512_maskz_rorv_epi32(0xFFFF, y, shift);
+		__mmask16 mask = _mm512_mask_cmple_epu32_mask(ge, y, limit);
+
+		// m <= i, so the full stores stay within the first n slots
+		__m512i pos = _mm512_loadu_si512(positions + i);
+		_mm512_storeu_si512(out_pos + m,
+							_mm512_maskz_compress_epi32(mask, pos));
+		if (Hashes) {
+			__mmask8 lo = mask & 0xFF, hi = mask >> 8;
+			_mm512_storeu_si512(out_hash + m,
+								_mm512_maskz_compress_epi64(lo, h0));
+			_mm512_storeu_si512(out_hash + m + __builtin_popcount(lo),
+								_mm512_maskz_compress_epi64(hi, h1));
+		}
+		m += __builtin_popcount(mask);
+	}
+	return m + select_congruent_scalar<Hashes>(
+				   hashes + i, positions + i, n - i, test, out_pos + m,
+				   Hashes ? out_hash + m : out_hash);
+}
+#endif
+
+/**
+ * @return the kernel of select_congruent() for the instruction sets the CPU
+ * supports, picked once
+ */
+template <bool Hashes>
+auto select_congruent_kernel() -> decltype(&select_congruent_scalar<Hashes>) {
+	typedef decltype(&select_congruent_scalar<Hashes>) Kernel;
+	static const Kernel kernel = []() -> Kernel {
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+	(defined(__GNUC__) || defined(__clang__))
+		switch (get_isa()) {
+		case Isa::AVX512:
+			return select_congruent_avx512<Hashes>;
+		case Isa::AVX2:
+			return select_congruent_avx2<Hashes>;
+		default:
+			break;
+		}
+#endif
+		return select_congruent_scalar<Hashes>;
+	}();
+	return kernel;
+}
+
+/**
+ * @brief writes the positions, and the hashes if out_hash is not null, of the
+ * k-mers among hashes and positions, e.g. from Digester::roll_hashes(), whose
+ * hashes pass test on their lower 32 bits, in order. The test is applied to a
+ * vector of hashes at a time and the positions are packed without a branch
+ * per k-mer, with the AVX-512 or AVX2 kernel if the CPU supports it, or with
+ * scalar code.
+ *
+ * @param hashes
+ * @param positions
+ * @param n number of k-mers in hashes and positions
+ * @param test
+ * @param out_pos array of at least n uint32_t, all of them may be written
+ * @param out_hash null, or an array of at least n uint64_t, all of them may
+ * be written
+ *
+ * @return size_t, the number of k-mers that passed
+ */
+inline size_t select_congruent(const uint64_t *hashes,
+							   const uint32_t *positions, size_t n,
+							   const CongruenceTest &test, uint32_t *out_pos,
+							   uint64_t *out_hash = nullptr) {
+	if (out_hash) {
+		return select_congruent_kernel<true>()(hashes, positions, n, test,
+											   out_pos, out_hash);
+	}
+	return select_congruent_kernel<false>()(hashes, positions, n, test,
+											out_pos, out_hash);
+}
+
 /**
  * @brief Child class of Digester that defines a minimizer as a kmer whose hash
  * is equal to some target value after being modded. Parameters without a
@@ -26,8 +339,10 @@ class BadModException : public std::exception {
  * are simply passed up to the parent constructor.
  *
  * @tparam P
+ * @tparam K
  */
-template <BadCharPolicy P> class ModMin : public Digester<P> {
+template <BadCharPolicy P, unsigned K = 0>
+class ModMin : public Digester<P, K> {
   public:
 	/**
 	 * @brief
@@ -46,8 +361,8 @@ template <BadCharPolicy P> class ModMin : public Digester<P> {
 	ModMin(const char *seq, size_t len, unsigned k, uint32_t mod,
 		   uint32_t congruence = 0, size_t start = 0,
 		   MinimizedHashType minimized_h = MinimizedHashType::CANON)
-		: Digester<P>(seq, len, k, start, minimized_h), mod(mod),
-		  congruence(congruence) {
+		: Digester<P, K>(seq, len, k, start, minimized_h), mod(mod),
+		  congruence(congruence), fast_mod(mod) {
 		if (congruence >= mod) {
 			throw BadModException();
 		}
@@ -68,8 +383,32 @@ template <BadCharPolicy P> class ModMin : public Digester<P> {
 	ModMin(const std::string &seq, unsigned k, uint32_t mod,
 		   uint32_t congruence = 0, size_t start = 0,
 		   MinimizedHashType minimized_h = MinimizedHashType::CANON)
-		: ModMin<P>(seq.c_str(), seq.size(), k, mod, congruence, start,
-					minimized_h) {}
+		: ModMin<P, K>(seq.c_str(), seq.size(), k, mod, congruence, start,
+					   minimized_h) {}
+
+	/**
+	 *
+	 * @param packed
+	 * @param len
+	 * @param n_intervals
+	 * @param k
+	 * @param mod mod space to be used to calculate universal minimizers
+	 * @param congruence value we want minimizer hashes to be congruent to in
+	 * the mod space
+	 * @param start
+	 * @param minimized_h
+	 *
+	 * @throws BadModException Thrown when congruence is greater or equal to mod
+	 */
+	ModMin(const uint8_t *packed, size_t len, const NIntervals &n_intervals,
+		   unsigned k, uint32_t mod, uint32_t congruence = 0, size_t start = 0,
+		   MinimizedHashType minimized_h = MinimizedHashType::CANON)
+		: Digester<P, K>(packed, len, n_intervals, k, start, minimized_h),
+		  mod(mod), congruence(congruence), fast_mod(mod) {
+		if (congruence >= mod) {
+			throw BadModException();
+		}
+	}
 
 	/**
 	 * @brief adds up to amount of positions of minimizers into vec. Here a
@@ -80,33 +419,7 @@ template <BadCharPolicy P> class ModMin : public Digester<P> {
 	 * @param vec
 	 */
 	void roll_minimizer(unsigned amount, std::vector<uint32_t> &vec) override {
-		if (!this->is_valid_hash)
-			return;
-
-		if (this->get_minimized_h() == digest::MinimizedHashType::CANON) {
-			do {
-				if ((uint32_t)this->chash % mod == congruence) {
-					vec.emplace_back(this->get_pos());
-				}
-			} while (this->roll_one() && vec.size() < amount);
-			return;
-		}
-
-		if (this->get_minimized_h() == digest::MinimizedHashType::FORWARD) {
-			do {
-				if ((uint32_t)this->fhash % mod == congruence) {
-					vec.emplace_back(this->get_pos());
-				}
-			} while (this->roll_one() && vec.size() < amount);
-			return;
-		}
-
-		// reverse
-		do {
-			if ((uint32_t)this->rhash % mod == congruence) {
-				vec.emplace_back(this->get_pos());
-			}
-		} while (this->roll_one() && vec.size() < amount);
+		roll_into(amount, vec);
 	}
 
 	/**
@@ -120,33 +433,99 @@ template <BadCharPolicy P> class ModMin : public Digester<P> {
 	void
 	roll_minimizer(unsigned amount,
 				   std::vector<std::pair<uint32_t, uint32_t>> &vec) override {
-		if (!this->is_valid_hash)
-			return;
+		roll_into(amount, vec);
+	}
 
-		if (this->get_minimized_h() == digest::MinimizedHashType::CANON) {
-			do {
-				if ((uint32_t)this->chash % mod == congruence) {
-					vec.emplace_back(this->get_pos(), this->chash);
-				}
-			} while (this->roll_one() && vec.size() < amount);
-			return;
-		}
+	/**
+	 * @brief adds up to amount of positions of minimizers into vec, without
+	 * truncating them to 32 bits. Here a k-mer is considered a minimizer if
+	 * its hash is congruent to congruence in the mod space.
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void roll_minimizer(unsigned amount, std::vector<uint64_t> &vec) override {
+		roll_into(amount, vec);
+	}
 
-		if (this->get_minimized_h() == digest::MinimizedHashType::FORWARD) {
-			do {
-				if ((uint32_t)this->fhash % mod == congruence) {
-					vec.emplace_back(this->get_pos(), this->fhash);
-				}
-			} while (this->roll_one() && vec.size() < amount);
-			return;
+	/**
+	 * @brief adds up to amount of positions and hashes of minimizers into vec.
+	 * Neither is truncated to 32 bits, the hash is the full 64-bit hash of the
+	 * k-mer, while the congruence is still checked on its lower 32 bits, so
+	 * the minimizers are the same as with the other roll_minimizer functions.
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void
+	roll_minimizer(unsigned amount,
+				   std::vector<std::pair<uint64_t, uint64_t>> &vec) override {
+		roll_into(amount, vec);
+	}
+
+	/**
+	 * @brief passes up to amount minimizers, the same ones the other
+	 * roll_minimizer functions would add to a vector, to sink, so they can go
+	 * straight into an index or a stream without being stored first. sink is
+	 * called as sink(position) if it accepts that, and as sink(position, hash)
+	 * otherwise. The position is a size_t, and the hash is the full 64-bit hash
+	 * of the k-mer. If it returns bool, returning false stops rolling after
+	 * that minimizer, e.g. when a fixed size buffer is full, and the next call
+	 * continues from there. Unlike with the vectors, where amount is the size
+	 * the vector may reach, amount only counts the minimizers of this call.
+	 *
+	 * @param amount
+	 * @param sink
+	 *
+	 * @return size_t, the number of minimizers passed to sink
+	 */
+	template <class Sink> size_t roll_minimizer(unsigned amount, Sink &&sink) {
+		switch (this->get_minimized_h()) {
+		case MinimizedHashType::FORWARD:
+			return roll_mod<MinimizedHashType::FORWARD>(amount, sink);
+		case MinimizedHashType::REVERSE:
+			return roll_mod<MinimizedHashType::REVERSE>(amount, sink);
+		default:
+			return roll_mod<MinimizedHashType::CANON>(amount, sink);
 		}
+	}
 
-		// reverse
-		do {
-			if ((uint32_t)this->rhash % mod == congruence) {
-				vec.emplace_back(this->get_pos(), this->rhash);
+	/**
+	 * @brief applies the selection of roll_minimizer() to hashes and positions
+	 * that were already produced by roll_hashes() or roll_hashes_lanes(), and
+	 * adds the positions of the minimizers into vec, with select_congruent()
+	 *
+	 * @param hashes
+	 * @param positions
+	 * @param n number of k-mers in hashes and positions
+	 * @param vec
+	 */
+	void select_minimizers(const uint64_t *hashes, const uint32_t *positions,
+						   size_t n, std::vector<uint32_t> &vec) {
+		size_t old = vec.size();
+		vec.resize(old + n);
+		vec.resize(old + select_congruent(hashes, positions, n,
+										  CongruenceTest(mod, congruence),
+										  vec.data() + old));
+	}
+
+	/**
+	 * @brief same as the other select_minimizers, except the hashes of the
+	 * minimizers are added as well
+	 *
+	 * @param hashes
+	 * @param positions
+	 * @param n
+	 * @param vec
+	 */
+	void select_minimizers(const uint64_t *hashes, const uint32_t *positions,
+						   size_t n,
+						   std::vector<std::pair<uint32_t, uint32_t>> &vec) {
+		for (size_t i = 0; i < n; i++) {
+			if (congruent(hashes[i])) {
+				vec.emplace_back(positions[i], hashes[i]);
 			}
-		} while (this->roll_one() && vec.size() < amount);
+		}
 	}
 
 	/**
@@ -160,8 +539,68 @@ template <BadCharPolicy P> class ModMin : public Digester<P> {
 	uint32_t get_congruence() { return congruence; }
 
   private:
+	/**
+	 * @brief the vector versions of roll_minimizer(). Unlike for the sink,
+	 * amount is the size vec may reach, counting what is already in it, and
+	 * at least one k-mer is rolled whenever the hash is valid.
+	 */
+	template <class V> void roll_into(unsigned amount, std::vector<V> &vec) {
+		if (!this->is_valid_hash)
+			return;
+
+		switch (this->get_minimized_h()) {
+		case MinimizedHashType::FORWARD:
+			return roll_into<MinimizedHashType::FORWARD>(amount, vec);
+		case MinimizedHashType::REVERSE:
+			return roll_into<MinimizedHashType::REVERSE>(amount, vec);
+		default:
+			return roll_into<MinimizedHashType::CANON>(amount, vec);
+		}
+	}
+
+	template <MinimizedHashType H, class V>
+	void roll_into(unsigned amount, std::vector<V> &vec) {
+		do {
+			uint64_t hash = this->template selected_hash<H>();
+			if (congruent(hash)) {
+				if constexpr (std::is_integral_v<V>) {
+					vec.emplace_back(this->get_pos());
+				} else {
+					vec.emplace_back(this->get_pos(), hash);
+				}
+			}
+		} while (this->roll_one() && vec.size() < amount);
+	}
+
+	template <MinimizedHashType H, class Sink>
+	size_t roll_mod(unsigned amount, Sink &sink) {
+		size_t n = 0;
+		if (!this->is_valid_hash || amount == 0)
+			return n;
+
+		bool more = true;
+		do {
+			uint64_t hash = this->template selected_hash<H>();
+			if (congruent(hash)) {
+				n++;
+				more =
+					this->emit(sink, this->get_pos(), [hash] { return hash; });
+			}
+		} while (this->roll_one() && more && n < amount);
+		return n;
+	}
+
 	uint32_t mod;
 	uint32_t congruence;
+	FastMod fast_mod;
+
+	/**
+	 * @brief whether the lower 32 bits of hash are congruent to congruence,
+	 * with the mod computed by fast_mod instead of a division
+	 */
+	bool congruent(uint64_t hash) const {
+		return fast_mod((uint32_t)hash) == congruence;
+	}
 };
 
 } // namespace digest
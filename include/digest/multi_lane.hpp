@@ -0,0 +1,373 @@
+#ifndef MULTI_LANE_HPP
+#define MULTI_LANE_HPP
+
+#include "digest/digester.hpp"
+#include "digest/isa.hpp"
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+	(defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Digests several independent sequences, or several segments of one
+ * sequence, on a single core. The rolling hash of a single digester is a
+ * serial chain, so instead of rolling one digester at a time, the hashes of a
+ * group of 4 digesters are rolled in lockstep, one digester per lane, and the
+ * results are then passed through each digester's own selection logic. The
+ * output for every digester is identical to calling roll_minimizer() on it
+ * until the end of its sequence.
+ *
+ * With AVX2, detected by get_isa(), a step of all 4 lanes is done with one
+ * 256-bit vector per hash when the digesters of a group share k and use
+ * SKIPOVER, otherwise the lanes are rolled by interleaved scalar code.
+ *
+ * @par Segments of the same sequence:
+ * construct one digester per segment the same way thread_out does, the same
+ * caveat about non-ACTG characters applies.
+ */
+namespace digest::multi_lane {
+
+/**
+ * @brief number of digesters rolled together
+ */
+constexpr unsigned LANES = 4;
+
+//------------- ROLLING KERNELS ----------------
+
+template <BadCharPolicy P, unsigned K>
+void roll_hashes_scalar(Digester<P, K> **digs, unsigned count, size_t amount,
+						uint64_t **hashes, uint32_t **positions,
+						size_t *written) {
+	Digester<P, K>::template roll_hashes_lanes<LANES>(
+		digs, count, amount, hashes, positions, written,
+		Digester<P, K>::template roll_lanes<LANES>);
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+	(defined(__GNUC__) || defined(__clang__))
+/**
+ * @brief largest k the vector step is checked against ntHash for
+ */
+constexpr unsigned VECTOR_MAX_K = 64;
+
+/**
+ * @brief the bases in the order of their code (c >> 1) & 3, which is the
+ * same for upper and lower case
+ */
+constexpr char lane_bases[4] = {'A', 'C', 'T', 'G'};
+
+/**
+ * @brief one step of ntHash's split rotation, the upper 31 and the lower 33
+ * bits are each rotated left by one
+ */
+inline uint64_t split_rol(uint64_t x) {
+	return ((x << 1) & 0xFFFFFFFDFFFFFFFFULL) | ((x >> 30) & (1ULL << 33)) |
+		   ((x >> 32) & 1);
+}
+
+/**
+ * @brief inverse of split_rol()
+ */
+inline uint64_t split_ror(uint64_t x) {
+	return ((x >> 1) & 0xFFFFFFFEFFFFFFFFULL) | ((x << 30) & (1ULL << 63)) |
+		   ((x << 32) & (1ULL << 32));
+}
+
+/**
+ * @brief checks what the vector step relies on: for every k up to
+ * VECTOR_MAX_K, next_forward_hash() and next_reverse_hash() are split_rol()
+ * and split_ror() of the hash xored with a term for the outgoing and a term
+ * for the incoming base, and the canonical hash is the sum of the two.
+ *
+ * @return bool, true if the ntHash in use rolls that way
+ */
+inline bool nthash_is_split_rotation() {
+	const uint64_t probes[] = {0, ~0ULL, 0x0123456789ABCDEFULL,
+							   0xF0E1D2C3B4A59687ULL};
+	const char bases[] = "ACTGactg";
+	for (unsigned k = 4; k <= VECTOR_MAX_K; k++) {
+		uint64_t f0 = next_forward_hash(0, k, 'A', 'A');
+		uint64_t r0 = next_reverse_hash(0, k, 'A', 'A');
+		for (unsigned o = 0; o < 8; o++) {
+			for (unsigned i = 0; i < 8; i++) {
+				char out = bases[o], in = bases[i];
+				char uout = lane_bases[(out >> 1) & 3];
+				char uin = lane_bases[(in >> 1) & 3];
+				uint64_t f = next_forward_hash(0, k, uout, 'A') ^
+							 next_forward_hash(0, k, 'A', uin) ^ f0;
+				uint64_t r = next_reverse_hash(0, k, uout, 'A') ^
+							 next_reverse_hash(0, k, 'A', uin) ^ r0;
+				for (uint64_t x : probes) {
+					uint64_t fx = next_forward_hash(x, k, out, in);
+					uint64_t rx = next_reverse_hash(x, k, out, in);
+					if (fx != (split_rol(x) ^ f) || rx != (split_ror(x) ^ r)) {
+						return false;
+					}
+				}
+			}
+		}
+	}
+	for (uint64_t x : probes) {
+		for (uint64_t y : probes) {
+			if (nthash::canonical(x, y) != x + y) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief split_rol() of 4 hashes
+ */
+__attribute__((target("avx2"))) inline __m256i split_rol_avx2(__m256i x) {
+	__m256i hi = _mm256_and_si256(_mm256_srli_epi64(x, 30),
+								  _mm256_set1_epi64x(1ULL << 33));
+	__m256i lo =
+		_mm256_and_si256(_mm256_srli_epi64(x, 32), _mm256_set1_epi64x(1));
+	__m256i body = _mm256_and_si256(_mm256_slli_epi64(x, 1),
+									_mm256_set1_epi64x(0xFFFFFFFDFFFFFFFFULL));
+	return _mm256_or_si256(body, _mm256_or_si256(hi, lo));
+}
+
+/**
+ * @brief split_ror() of 4 hashes
+ */
+__attribute__((target("avx2"))) inline __m256i split_ror_avx2(__m256i x) {
+	__m256i hi = _mm256_and_si256(_mm256_slli_epi64(x, 30),
+								  _mm256_set1_epi64x(1ULL << 63));
+	__m256i lo = _mm256_and_si256(_mm256_slli_epi64(x, 32),
+								  _mm256_set1_epi64x(1ULL << 32));
+	__m256i body = _mm256_and_si256(_mm256_srli_epi64(x, 1),
+									_mm256_set1_epi64x(0xFFFFFFFEFFFFFFFFULL));
+	return _mm256_or_si256(body, _mm256_or_si256(hi, lo));
+}
+
+/**
+ * @brief loads 4 characters from each lane, starting at t, and turns them
+ * into permutevar8x32 indices: per 64-bit lane, byte s of the low and of the
+ * high half is twice, and twice plus one, the code of character s
+ */
+__attribute__((target("avx2"))) inline __m256i
+load_codes_avx2(const char *const *chars, size_t t) {
+	uint32_t raw[4];
+	for (unsigned j = 0; j < 4; j++) {
+		std::memcpy(&raw[j], chars[j] + t, 4);
+	}
+	__m256i x = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)raw));
+	__m256i c = _mm256_and_si256(_mm256_srli_epi64(x, 1),
+								 _mm256_set1_epi64x(0x03030303));
+	__m256i c2 = _mm256_add_epi64(c, c);
+	__m256i c21 = _mm256_or_si256(c2, _mm256_set1_epi64x(0x01010101));
+	return _mm256_or_si256(c2, _mm256_slli_epi64(c21, 32));
+}
+
+/**
+ * @brief the step function of roll_hashes_lanes() with AVX2, same result as
+ * Digester::roll_lanes(). The hashes of the 4 lanes are rolled in one vector
+ * each, the terms of the outgoing and incoming bases are looked up in 4
+ * entry tables for the shared k, and the selected hashes of 4 steps are
+ * transposed so each lane stores them at once. Falls back to roll_lanes()
+ * under WRITEOVER, for lanes with different k, for k above VECTOR_MAX_K, and
+ * if nthash_is_split_rotation() fails.
+ */
+template <BadCharPolicy P, unsigned K>
+__attribute__((target("avx2"))) void roll_lanes_avx2(LaneState<LANES> &state,
+													 size_t steps) {
+	static const bool split_rotation = nthash_is_split_rotation();
+	unsigned k = K != 0 ? K : state.ks[0];
+	bool shared_k = true;
+	for (unsigned j = 1; j < LANES; j++) {
+		shared_k &= K != 0 || state.ks[j] == k;
+	}
+	if (P == BadCharPolicy::WRITEOVER || !split_rotation || !shared_k ||
+		k > VECTOR_MAX_K) {
+		return Digester<P, K>::template roll_lanes<LANES>(state, steps);
+	}
+
+	// the terms of the outgoing and the incoming base, by code
+	uint64_t f_out[4], f_in[4], r_out[4], r_in[4];
+	uint64_t f0 = next_forward_hash(0, k, 'A', 'A');
+	uint64_t r0 = next_reverse_hash(0, k, 'A', 'A');
+	for (unsigned c = 0; c < 4; c++) {
+		f_out[c] = next_forward_hash(0, k, lane_bases[c], 'A');
+		f_in[c] = next_forward_hash(0, k, 'A', lane_bases[c]) ^ f0;
+		r_out[c] = next_reverse_hash(0, k, lane_bases[c], 'A');
+		r_in[c] = next_reverse_hash(0, k, 'A', lane_bases[c]) ^ r0;
+	}
+	const __m256i f_out_tab = _mm256_loadu_si256((const __m256i *)f_out);
+	const __m256i f_in_tab = _mm256_loadu_si256((const __m256i *)f_in);
+	const __m256i r_out_tab = _mm256_loadu_si256((const __m256i *)r_out);
+	const __m256i r_in_tab = _mm256_loadu_si256((const __m256i *)r_in);
+	const __m256i canon_mask =
+		_mm256_loadu_si256((const __m256i *)state.canon_mask);
+	const __m256i forward_mask =
+		_mm256_loadu_si256((const __m256i *)state.forward_mask);
+	const __m256i reverse_mask =
+		_mm256_loadu_si256((const __m256i *)state.reverse_mask);
+	// shuffle_epi8 indices that pick byte s of each half of every 64-bit
+	// lane, the bytes of the second lane of a 128-bit half are 8 higher
+	const __m256i second = _mm256_set_epi64x(0x0000000800000008LL, 0,
+											 0x0000000800000008LL, 0);
+	const __m256i pick[4] = {
+		_mm256_add_epi8(_mm256_set1_epi64x(0x8080800480808000LL), second),
+		_mm256_add_epi8(_mm256_set1_epi64x(0x8080800580808001LL), second),
+		_mm256_add_epi8(_mm256_set1_epi64x(0x8080800680808002LL), second),
+		_mm256_add_epi8(_mm256_set1_epi64x(0x8080800780808003LL), second)};
+
+	__m256i fhash = _mm256_loadu_si256((const __m256i *)state.fhashes);
+	__m256i rhash = _mm256_loadu_si256((const __m256i *)state.rhashes);
+	size_t t = 0;
+	for (; t + 4 <= steps; t += 4) {
+		__m256i out_codes = load_codes_avx2(state.outs, t);
+		__m256i in_codes = load_codes_avx2(state.ins, t);
+		__m256i selected[4];
+		for (unsigned s = 0; s < 4; s++) {
+			__m256i out_idx = _mm256_shuffle_epi8(out_codes, pick[s]);
+			__m256i in_idx = _mm256_shuffle_epi8(in_codes, pick[s]);
+			__m256i chash = _mm256_add_epi64(fhash, rhash);
+			selected[s] = _mm256_or_si256(
+				_mm256_and_si256(chash, canon_mask),
+				_mm256_or_si256(_mm256_and_si256(fhash, forward_mask),
+								_mm256_and_si256(rhash, reverse_mask)));
+			fhash = _mm256_xor_si256(
+				split_rol_avx2(fhash),
+				_mm256_xor_si256(
+					_mm256_permutevar8x32_epi32(f_out_tab, out_idx),
+					_mm256_permutevar8x32_epi32(f_in_tab, in_idx)));
+			rhash = _mm256_xor_si256(
+				split_ror_avx2(rhash),
+				_mm256_xor_si256(
+					_mm256_permutevar8x32_epi32(r_out_tab, out_idx),
+					_mm256_permutevar8x32_epi32(r_in_tab, in_idx)));
+		}
+
+		// selected[s] holds step s of all lanes, transpose to 4 steps per
+		// lane
+		__m256i t0 = _mm256_unpacklo_epi64(selected[0], selected[1]);
+		__m256i t1 = _mm256_unpackhi_epi64(selected[0], selected[1]);
+		__m256i t2 = _mm256_unpacklo_epi64(selected[2], selected[3]);
+		__m256i t3 = _mm256_unpackhi_epi64(selected[2], selected[3]);
+		__m256i lanes[4] = {_mm256_permute2x128_si256(t0, t2, 0x20),
+							_mm256_permute2x128_si256(t1, t3, 0x20),
+							_mm256_permute2x128_si256(t0, t2, 0x31),
+							_mm256_permute2x128_si256(t1, t3, 0x31)};
+		for (unsigned j = 0; j < LANES; j++) {
+			_mm256_storeu_si256((__m256i *)(state.hash_out[j] + t), lanes[j]);
+			__m128i pos = _mm_add_epi32(_mm_set1_epi32(state.pos[j] + t),
+										_mm_setr_epi32(0, 1, 2, 3));
+			_mm_storeu_si128((__m128i *)(state.pos_out[j] + t), pos);
+		}
+	}
+	_mm256_storeu_si256((__m256i *)state.fhashes, fhash);
+	_mm256_storeu_si256((__m256i *)state.rhashes, rhash);
+
+	// fewer than 4 steps left
+	for (unsigned j = 0; j < LANES; j++) {
+		state.ins[j] += t;
+		state.outs[j] += t;
+		state.hash_out[j] += t;
+		state.pos_out[j] += t;
+		state.pos[j] += t;
+	}
+	Digester<P, K>::template roll_lanes<LANES>(state, steps - t);
+}
+
+template <BadCharPolicy P, unsigned K>
+__attribute__((target("avx2"))) void
+roll_hashes_avx2(Digester<P, K> **digs, unsigned count, size_t amount,
+				 uint64_t **hashes, uint32_t **positions, size_t *written) {
+	Digester<P, K>::template roll_hashes_lanes<LANES>(
+		digs, count, amount, hashes, positions, written,
+		roll_lanes_avx2<P, K>);
+}
+#endif
+
+/**
+ * @brief calls Digester::roll_hashes_lanes() with the step function for isa,
+ * the AVX2 one for AVX2 and AVX512
+ *
+ * @param isa must be supported by the CPU, count must be at most LANES
+ */
+template <BadCharPolicy P, unsigned K>
+void roll_hashes(Isa isa, Digester<P, K> **digs, unsigned count, size_t amount,
+				 uint64_t **hashes, uint32_t **positions, size_t *written) {
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+	(defined(__GNUC__) || defined(__clang__))
+	if (isa >= Isa::AVX2) {
+		return roll_hashes_avx2<P, K>(digs, count, amount, hashes, positions,
+								   written);
+	}
+#endif
+	roll_hashes_scalar<P, K>(digs, count, amount, hashes, positions, written);
+}
+
+/**
+ * @brief only declared, used to find the Digester a scheme derives from
+ */
+template <BadCharPolicy P, unsigned K>
+Digester<P, K> *digester_base(Digester<P, K> *dig);
+
+//------------- DRIVER ----------------
+
+/**
+ * @tparam P policy for dealing with non-ACTG characters
+ * @tparam D ModMin, WindowMin or Syncmer
+ * @tparam V uint32_t, or std::pair<uint32_t, uint32_t> to also get the hashes
+ *
+ * @param digs the digesters, each is rolled until the end of its sequence
+ * @param vec vec[i] receives the minimizers of digs[i], in the same order and
+ * with the same values roll_minimizer() would have given. vec is resized to
+ * digs.size() if it is smaller.
+ * @param block number of k-mers rolled per digester before they are passed to
+ * the selection logic
+ * @param isa instruction set to use, must be supported by the CPU
+ */
+template <BadCharPolicy P, class D, class V>
+void roll_minimizer(std::vector<D> &digs, std::vector<std::vector<V>> &vec,
+					size_t block = 4096, Isa isa = get_isa()) {
+	using Base = std::remove_pointer_t<decltype(digester_base(
+		static_cast<D *>(nullptr)))>;
+	const unsigned width = LANES;
+	if (vec.size() < digs.size()) {
+		vec.resize(digs.size());
+	}
+
+	std::vector<uint64_t> hash_buf(width * block);
+	std::vector<uint32_t> pos_buf(width * block);
+	std::vector<Base *> group(width);
+	std::vector<uint64_t *> hashes(width);
+	std::vector<uint32_t *> positions(width);
+	std::vector<size_t> written(width);
+	for (unsigned l = 0; l < width; l++) {
+		hashes[l] = hash_buf.data() + l * block;
+		positions[l] = pos_buf.data() + l * block;
+	}
+
+	for (size_t first = 0; first < digs.size(); first += width) {
+		unsigned count = std::min<size_t>(width, digs.size() - first);
+		for (unsigned l = 0; l < count; l++) {
+			group[l] = &digs[first + l];
+		}
+
+		bool rolling = true;
+		while (rolling) {
+			roll_hashes(isa, group.data(), count, block, hashes.data(),
+						positions.data(), written.data());
+			rolling = false;
+			for (unsigned l = 0; l < count; l++) {
+				digs[first + l].select_minimizers(hashes[l], positions[l],
+												  written[l], vec[first + l]);
+				rolling |= written[l] == block;
+			}
+		}
+	}
+}
+
+} // namespace digest::multi_lane
+
+#endif // MULTI_LANE_HPP
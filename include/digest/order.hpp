@@ -0,0 +1,301 @@
+#ifndef ORDER_HPP
+#define ORDER_HPP
+
+#include "digest/data_structure.hpp"
+#include "digest/digester.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Orders of k-mers for WindowMin and Syncmer, their O template
+ * parameter. By default the k-mers are ordered by their hash, so the density
+ * of window minimizers is about 2 / (large_window + 1). The other orders rank
+ * the k-mers into a few classes first, and order the k-mers of a class by
+ * their hash, which picks the same k-mer in more consecutive windows and
+ * lowers the density, at the cost of some work per k-mer.
+ *
+ * An order has init(k, large_window), called once by the constructor of the
+ * scheme, reset(), called by new_seq(), and key<H>(dig, pos, hash), called for
+ * every k-mer in increasing order of position, which returns the value the
+ * data structure minimizes instead of the hash. The ranked keys keep the rank
+ * in the top bits of both halves of the 64-bit key, so the data structures
+ * that only compare the lower 32 bits order them the same way as the 64-bit
+ * ones. They replace the hashes passed on with the minimizers.
+ */
+namespace digest::order {
+
+/**
+ * @brief the key of a k-mer with rank rank, in [0, 2^bits), and hash hash.
+ * Lower ranks come first, then lower hashes.
+ *
+ * @param hash
+ * @param rank
+ * @param bits
+ *
+ * @return uint64_t
+ */
+inline uint64_t ranked(uint64_t hash, unsigned rank, unsigned bits) {
+	uint64_t prefix = (uint64_t)rank << (32 - bits);
+	uint64_t hi = (hash >> 32) >> bits | prefix;
+	uint64_t lo = (uint64_t)((uint32_t)hash >> bits) | prefix;
+	return hi << 32 | lo;
+}
+
+/**
+ * @brief orders the k-mers by their hash, the default. Costs nothing.
+ */
+class Hash {
+  public:
+	void init(unsigned, unsigned) {}
+
+	void reset() {}
+
+	template <MinimizedHashType H, class D>
+	uint64_t key(D &, size_t, uint64_t hash) {
+		return hash;
+	}
+};
+
+/**
+ * @brief the characters of the current k-mer of a digester, kept up to date
+ * with the one character that enters while the k-mers are consecutive, and
+ * read again with Digester::get_kmer() after a skipped character
+ */
+class KmerChars {
+  public:
+	void init(unsigned k) {
+		this->k = k;
+		size_t cap = 1;
+		while (cap < k + 1) {
+			cap <<= 1;
+		}
+		buf.resize(cap);
+		mask = cap - 1;
+		kmer.resize(k);
+		reset();
+	}
+
+	void reset() { has_prev = false; }
+
+	/**
+	 * @brief moves on to the k-mer at pos, the current k-mer of dig
+	 *
+	 * @return bool, true if it follows the previous k-mer, then at(pos - 1)
+	 * is the character that left it
+	 */
+	template <class D> bool update(D &dig, size_t pos) {
+		bool next = has_prev and pos == prev + 1;
+		has_prev = true;
+		prev = pos;
+		if (next) {
+			buf[(pos + k - 1) & mask] = dig.get_last_char();
+			return true;
+		}
+		dig.get_kmer(kmer.data());
+		for (unsigned i = 0; i < k; i++) {
+			buf[(pos + i) & mask] = kmer[i];
+		}
+		return false;
+	}
+
+	/**
+	 * @return char, the character at position i, in the current k-mer or
+	 * right before it
+	 */
+	char at(size_t i) const { return buf[i & mask]; }
+
+  private:
+	unsigned k = 0;
+	std::vector<char> buf;
+	size_t mask = 0;
+	std::vector<char> kmer;
+	bool has_prev = false;
+	size_t prev = 0;
+};
+
+/**
+ * @brief Miniception (Zheng, Kingsford and Marçais 2020). A k-mer ranks first
+ * if the smallest of its c-mers by hash is its first or its last one, i.e.
+ * if it is a closed syncmer of c-mers. The c-mers are hashed with ntHash,
+ * rolling along with the k-mers, and their minimum is kept in a MonoQueue,
+ * so a k-mer costs a c-mer hash and an insert. Reading a k-mer after a
+ * skipped character costs O(k).
+ *
+ * The density is lowest with k - c = large_window, and can be higher than
+ * ordering by hash with a smaller c, when a large window often holds none of
+ * the k-mers that rank first. So by default c is k - large_window, or 4 if
+ * that is less than 4, for large windows about as long as the k-mers or
+ * longer.
+ *
+ * @tparam C length of the c-mers, 0 to pick it from k and large_window. It is
+ * k if k is smaller.
+ */
+template <unsigned C = 0> class Miniception {
+  public:
+	void init(unsigned k, unsigned large_window) {
+		this->k = k;
+		if (C > 0) {
+			c = C;
+		} else if (k >= large_window + 4) {
+			c = k - large_window;
+		} else {
+			c = 4;
+		}
+		c = std::min(c, k);
+		chars.init(k);
+		size_t cap = 1;
+		while (cap < k) {
+			cap <<= 1;
+		}
+		hashes.resize(cap);
+		mask = cap - 1;
+		reset();
+	}
+
+	void reset() { chars.reset(); }
+
+	template <MinimizedHashType H, class D>
+	uint64_t key(D &dig, size_t pos, uint64_t hash) {
+		if (chars.update(dig, pos)) {
+			// only the last c-mer is new
+			add<H>(pos + k - c, chars.at(pos + k - c - 1),
+				   chars.at(pos + k - 1));
+		} else {
+			cmers = ds::MonoQueue<>(k - c + 1);
+			std::vector<char> cmer(c);
+			for (unsigned i = 0; i < c; i++) {
+				cmer[i] = chars.at(pos + i);
+			}
+			fhash = base_forward_hash(cmer.data(), c);
+			rhash = base_reverse_hash(cmer.data(), c);
+			insert<H>(pos);
+			for (size_t j = pos + 1; j <= pos + k - c; j++) {
+				add<H>(j, chars.at(j - 1), chars.at(j + c - 1));
+			}
+		}
+		uint32_t min = cmers.min_hash();
+		bool closed =
+			min == hashes[pos & mask] or min == hashes[(pos + k - c) & mask];
+		return ranked(hash, closed ? 0 : 1, 1);
+	}
+
+  private:
+	unsigned k = 0, c = 0;
+	KmerChars chars;
+	ds::MonoQueue<> cmers{1};
+
+	// hashes of the c-mers of the current k-mer by position, and the ntHash
+	// of the last one
+	std::vector<uint32_t> hashes;
+	size_t mask = 0;
+	uint64_t fhash = 0, rhash = 0;
+
+	template <MinimizedHashType H> void insert(size_t pos) {
+		uint32_t hash;
+		if (H == MinimizedHashType::CANON) {
+			hash = nthash::canonical(fhash, rhash);
+		} else if (H == MinimizedHashType::FORWARD) {
+			hash = fhash;
+		} else {
+			hash = rhash;
+		}
+		hashes[pos & mask] = hash;
+		cmers.insert(pos, hash);
+	}
+
+	template <MinimizedHashType H> void add(size_t pos, char out, char in) {
+		fhash = next_forward_hash(fhash, c, out, in);
+		rhash = next_reverse_hash(rhash, c, out, in);
+		insert<H>(pos);
+	}
+};
+
+/**
+ * @brief Orders based on a decycling set (Pellow et al. 2023). A k-mer x
+ * with the weight w(x) = sum of x_i e^(2 pi i j / k) is in Mykkeltveit's set
+ * D if the angle of w(x) is in (0, 2 pi / k], rotating x moves the angle by
+ * 2 pi / k, so D holds one k-mer of every cycle of rotations with a weight
+ * that is not 0. The k-mers of D rank first. With Double, the k-mers of the
+ * mirrored set, with the angle in (pi, pi + 2 pi / k], rank second, which is
+ * the double decycling order. The weight is moved along with the k-mers with
+ * one complex multiplication, and computed again every k k-mers and after a
+ * skipped character, O(k), so the rounding errors don't add up.
+ *
+ * The ranks only depend on the forward strand of the k-mer.
+ *
+ * @tparam Double
+ */
+template <bool Double = true> class Decycling {
+  public:
+	void init(unsigned k, unsigned) {
+		this->k = k;
+		chars.init(k);
+		const double pi = std::acos(-1.0);
+		cosines.resize(k);
+		sines.resize(k);
+		for (unsigned i = 0; i < k; i++) {
+			cosines[i] = std::cos(2 * pi * i / k);
+			sines[i] = std::sin(2 * pi * i / k);
+		}
+		cos1 = std::cos(2 * pi / k);
+		sin1 = std::sin(2 * pi / k);
+		reset();
+	}
+
+	void reset() { chars.reset(); }
+
+	template <MinimizedHashType H, class D>
+	uint64_t key(D &dig, size_t pos, uint64_t hash) {
+		if (chars.update(dig, pos) and rolled < k) {
+			// drop the first character, add the last one, and divide the
+			// weight by e^(2 pi i / k) to move every character down by one
+			double r = re - value(chars.at(pos - 1)) +
+					   value(chars.at(pos + k - 1));
+			re = r * cos1 + im * sin1;
+			im = im * cos1 - r * sin1;
+			rolled++;
+		} else {
+			re = im = 0;
+			for (unsigned i = 0; i < k; i++) {
+				re += value(chars.at(pos + i)) * cosines[i];
+				im += value(chars.at(pos + i)) * sines[i];
+			}
+			rolled = 0;
+		}
+		// the imaginary part of the weight of the k-mer rotated by one
+		double rot = im * cos1 - re * sin1;
+		unsigned rank;
+		if (im > eps and rot <= eps) {
+			rank = 0;
+		} else if (Double and im < -eps and rot >= -eps) {
+			rank = 1;
+		} else {
+			rank = Double ? 2 : 1;
+		}
+		return ranked(hash, rank, Double ? 2 : 1);
+	}
+
+  private:
+	// weights closer to the axis than this are on it
+	static constexpr double eps = 1e-9;
+
+	unsigned k = 0;
+	KmerChars chars;
+	std::vector<double> cosines, sines;
+	double cos1 = 1, sin1 = 0;
+	double re = 0, im = 0;
+	unsigned rolled = 0;
+
+	/**
+	 * @return double, A = 0, C = 1, T = 2 and G = 3, in upper or lower case.
+	 * Any values work for the decycling set.
+	 */
+	static double value(char c) { return (c >> 1) & 3; }
+};
+
+} // namespace digest::order
+
+#endif // ORDER_HPP
@@ -0,0 +1,127 @@
+#ifndef PACKED_SEQ_HPP
+#define PACKED_SEQ_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace digest {
+
+/**
+ * @brief Sorted, non-overlapping, half-open intervals [first, second) of the
+ * positions in a 2-bit packed sequence that hold an N (or any other non-ACTG
+ * character). The packed codes at those positions are ignored.
+ */
+typedef std::vector<std::pair<size_t, size_t>> NIntervals;
+
+/**
+ * @internal
+ * @brief the 4 bases stored in each possible packed byte
+ */
+inline constexpr std::array<std::array<char, 4>, 256> packed_bytes = [] {
+	std::array<std::array<char, 4>, 256> bytes{};
+	const char bases[] = {'A', 'C', 'G', 'T'};
+	for (unsigned b = 0; b < 256; b++) {
+		for (unsigned i = 0; i < 4; i++) {
+			bytes[b][i] = bases[(b >> (2 * i)) & 3];
+		}
+	}
+	return bytes;
+}();
+
+/**
+ * @brief unpacks bases [from, from + n) of a 2-bit packed sequence into ASCII,
+ * writing 'N' at the positions covered by n_intervals. <br>
+ * The encoding is A = 0, C = 1, G = 2, T = 3, 4 bases per byte, with base i
+ * stored in bits 2 * (i % 4) and 2 * (i % 4) + 1 of byte i / 4.
+ *
+ * @param packed
+ * @param from first base to unpack
+ * @param n number of bases to unpack
+ * @param n_intervals
+ * @param interval index of the first interval of n_intervals that may overlap
+ * [from, from + n), it is advanced past the intervals that end before
+ * from + n, so unpacking consecutive ranges doesn't search the list again
+ * @param out array of at least n chars
+ */
+inline void unpack_bases(const uint8_t *packed, size_t from, size_t n,
+						 const NIntervals &n_intervals, size_t &interval,
+						 char *out) {
+	size_t i = 0;
+	for (; i < n && (from + i) % 4 != 0; i++) {
+		out[i] = packed_bytes[packed[(from + i) / 4]][(from + i) % 4];
+	}
+	for (; i + 4 <= n; i += 4) {
+		std::memcpy(out + i, packed_bytes[packed[(from + i) / 4]].data(), 4);
+	}
+	for (; i < n; i++) {
+		out[i] = packed_bytes[packed[(from + i) / 4]][(from + i) % 4];
+	}
+
+	size_t to = from + n;
+	while (interval < n_intervals.size() &&
+		   n_intervals[interval].first < to) {
+		size_t first = std::max(n_intervals[interval].first, from);
+		size_t last = std::min(n_intervals[interval].second, to);
+		if (first < last) {
+			std::memset(out + (first - from), 'N', last - first);
+		}
+		if (n_intervals[interval].second > to) {
+			break;
+		}
+		interval++;
+	}
+}
+
+/**
+ * @brief packs an ASCII sequence into the 2-bit encoding used by
+ * unpack_bases(). Lower case bases are packed as upper case, and every
+ * non-ACTG character is recorded in n_intervals.
+ *
+ * @param seq
+ * @param len
+ * @param packed replaced by the (len + 3) / 4 packed bytes
+ * @param n_intervals replaced by the N intervals of seq
+ */
+inline void pack_bases(const char *seq, size_t len,
+					   std::vector<uint8_t> &packed, NIntervals &n_intervals) {
+	packed.assign((len + 3) / 4, 0);
+	n_intervals.clear();
+	for (size_t i = 0; i < len; i++) {
+		uint8_t code;
+		switch (seq[i]) {
+		case 'A':
+		case 'a':
+			code = 0;
+			break;
+		case 'C':
+		case 'c':
+			code = 1;
+			break;
+		case 'G':
+		case 'g':
+			code = 2;
+			break;
+		case 'T':
+		case 't':
+			code = 3;
+			break;
+		default:
+			code = 0;
+			if (!n_intervals.empty() && n_intervals.back().second == i) {
+				n_intervals.back().second++;
+			} else {
+				n_intervals.emplace_back(i, i + 1);
+			}
+		}
+		packed[i / 4] |= code << (2 * (i % 4));
+	}
+}
+
+} // namespace digest
+
+#endif // PACKED_SEQ_HPP
@@ -0,0 +1,348 @@
+#ifndef SMER_SYNCMER_HPP
+#define SMER_SYNCMER_HPP
+
+#include "digest/data_structure.hpp"
+#include "digest/digester.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace digest {
+
+/**
+ * @brief Exception thrown when initializing a SmerSyncmer with s-mers longer
+ * than the k-mers, or with an offset that is not the start of an s-mer of the
+ * k-mer.
+ *
+ *
+ */
+class BadSmerException : public std::exception {
+	const char *what() const throw() {
+		return "s cannot be greater than k, and offsets cannot be greater "
+			   "than k - s";
+	}
+};
+
+/**
+ * @param k
+ * @param s
+ *
+ * @return std::vector<unsigned>, the offsets of closed syncmers, the k-mers
+ * whose minimal s-mer is their first or their last one
+ */
+inline std::vector<unsigned> closed_offsets(unsigned k, unsigned s) {
+	return {0, k - s};
+}
+
+/**
+ * @param t
+ *
+ * @return std::vector<unsigned>, the offsets of open syncmers, the k-mers whose
+ * minimal s-mer starts t bases into them
+ */
+inline std::vector<unsigned> open_offsets(unsigned t) { return {t}; }
+
+/**
+ * @brief Child class of Digester that finds syncmers as defined with s-mers
+ * (Edgar 2021): a k-mer is a syncmer if its minimal s-mer, the one with the
+ * smallest hash of its k - s + 1 s-mers, starts at one of a set of offsets
+ * into it. That is {0, k - s} for closed syncmers, {t} for open syncmers and
+ * any set for parameterized syncmers, see closed_offsets() and
+ * open_offsets(). Whether a k-mer is a syncmer only depends on the k-mer
+ * itself, unlike Syncmer, which looks at a large window of k-mers. Parameters
+ * without a description are the same as the parameters in the Digester parent
+ * class. They are simply passed up to the parent constructor.
+ *
+ * The s-mers are hashed by a second digester rolling alongside the k-mers,
+ * with the same BadCharPolicy and hash type, and their minimum over the k-mer
+ * is found with T, so a k-mer costs an s-mer hash and an insert on top of its
+ * own hash. Ties go to the rightmost s-mer, like in the data structures.
+ *
+ * @tparam P
+ * @tparam T The data structure to use for finding the minimal s-mer, over a
+ * window of k - s + 1 s-mers
+ * @tparam K
+ */
+template <BadCharPolicy P, class T = ds::MonoQueue<>, unsigned K = 0>
+class SmerSyncmer : public Digester<P, K> {
+  public:
+	/**
+	 * @param seq
+	 * @param len
+	 * @param k
+	 * @param s length of the s-mers, at least 4 and at most k
+	 * @param offsets the offsets into the k-mer where its minimal s-mer makes
+	 * it a syncmer, each at most k - s
+	 * @param start
+	 * @param minimized_h
+	 *
+	 * @throws BadSmerException thrown when s is greater than k, or an offset
+	 * is greater than k - s
+	 * @throws BadConstructionException thrown when s is less than 4
+	 */
+	SmerSyncmer(const char *seq, size_t len, unsigned k, unsigned s,
+				const std::vector<unsigned> &offsets, size_t start = 0,
+				MinimizedHashType minimized_h = MinimizedHashType::CANON)
+		: Digester<P, K>(seq, len, k, start, minimized_h),
+		  smers(seq, len, s, start, minimized_h), s(s), ds(window()) {
+		init(offsets);
+	}
+
+	/**
+	 * @param seq
+	 * @param k
+	 * @param s length of the s-mers, at least 4 and at most k
+	 * @param offsets the offsets into the k-mer where its minimal s-mer makes
+	 * it a syncmer, each at most k - s
+	 * @param start
+	 * @param minimized_h
+	 *
+	 * @throws BadSmerException thrown when s is greater than k, or an offset
+	 * is greater than k - s
+	 * @throws BadConstructionException thrown when s is less than 4
+	 */
+	SmerSyncmer(const std::string &seq, unsigned k, unsigned s,
+				const std::vector<unsigned> &offsets, size_t start = 0,
+				MinimizedHashType minimized_h = MinimizedHashType::CANON)
+		: SmerSyncmer<P, T, K>(seq.c_str(), seq.size(), k, s, offsets, start,
+							   minimized_h) {}
+
+	/**
+	 * @param packed
+	 * @param len
+	 * @param n_intervals
+	 * @param k
+	 * @param s length of the s-mers, at least 4 and at most k
+	 * @param offsets the offsets into the k-mer where its minimal s-mer makes
+	 * it a syncmer, each at most k - s
+	 * @param start
+	 * @param minimized_h
+	 *
+	 * @throws BadSmerException thrown when s is greater than k, or an offset
+	 * is greater than k - s
+	 * @throws BadConstructionException thrown when s is less than 4
+	 */
+	SmerSyncmer(const uint8_t *packed, size_t len,
+				const NIntervals &n_intervals, unsigned k, unsigned s,
+				const std::vector<unsigned> &offsets, size_t start = 0,
+				MinimizedHashType minimized_h = MinimizedHashType::CANON)
+		: Digester<P, K>(packed, len, n_intervals, k, start, minimized_h),
+		  smers(packed, len, n_intervals, s, start, minimized_h), s(s),
+		  ds(window()) {
+		init(offsets);
+	}
+
+	/**
+	 * @brief adds up to amount of positions of syncmers into vec. Here a
+	 * k-mer is considered a syncmer if its minimal s-mer starts at one of the
+	 * offsets.
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void roll_minimizer(unsigned amount, std::vector<uint32_t> &vec) override {
+		roll_minimizer(amount, [&vec](uint32_t pos) { vec.emplace_back(pos); });
+	}
+
+	/**
+	 * @brief adds up to amount of positions and hashes of syncmers into vec.
+	 * The hashes are the hashes of the k-mers, not of their minimal s-mers.
+	 * Here a k-mer is considered a syncmer if its minimal s-mer starts at one
+	 * of the offsets.
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void
+	roll_minimizer(unsigned amount,
+				   std::vector<std::pair<uint32_t, uint32_t>> &vec) override {
+		roll_minimizer(amount, [&vec](uint32_t pos, uint32_t hash) {
+			vec.emplace_back(pos, hash);
+		});
+	}
+
+	/**
+	 * @brief adds up to amount of positions of syncmers into vec, without
+	 * truncating them to 32 bits. Here a k-mer is considered a syncmer if its
+	 * minimal s-mer starts at one of the offsets.
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void roll_minimizer(unsigned amount, std::vector<uint64_t> &vec) override {
+		roll_minimizer(amount, [&vec](uint64_t pos) { vec.emplace_back(pos); });
+	}
+
+	/**
+	 * @brief adds up to amount of positions and hashes of syncmers into vec,
+	 * without truncating them to 32 bits. The hashes are the full 64-bit
+	 * hashes of the k-mers. Here a k-mer is considered a syncmer if its
+	 * minimal s-mer starts at one of the offsets.
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void
+	roll_minimizer(unsigned amount,
+				   std::vector<std::pair<uint64_t, uint64_t>> &vec) override {
+		roll_minimizer(amount, [&vec](uint64_t pos, uint64_t hash) {
+			vec.emplace_back(pos, hash);
+		});
+	}
+
+	/**
+	 * @brief passes up to amount syncmers, the same ones the other
+	 * roll_minimizer functions would add to a vector, to sink, so they can go
+	 * straight into an index or a stream without being stored first. sink is
+	 * called as sink(position) if it accepts that, and as sink(position, hash)
+	 * otherwise. The position is a size_t, and the hash is the 64-bit hash of
+	 * the k-mer. If it returns bool, returning false stops rolling after that
+	 * syncmer, e.g. when a fixed size buffer is full, and the next call
+	 * continues from there.
+	 *
+	 * @param amount
+	 * @param sink
+	 *
+	 * @return size_t, the number of syncmers passed to sink
+	 */
+	template <class Sink> size_t roll_minimizer(unsigned amount, Sink &&sink) {
+		switch (this->get_minimized_h()) {
+		case MinimizedHashType::FORWARD:
+			return roll_sync<MinimizedHashType::FORWARD>(amount, sink);
+		case MinimizedHashType::REVERSE:
+			return roll_sync<MinimizedHashType::REVERSE>(amount, sink);
+		default:
+			return roll_sync<MinimizedHashType::CANON>(amount, sink);
+		}
+	}
+
+	void new_seq(const char *seq, size_t len, size_t start) override {
+		reset();
+		smers.new_seq(seq, len, start);
+		Digester<P, K>::new_seq(seq, len, start);
+	}
+
+	void new_seq(const std::string &seq, size_t pos) override {
+		new_seq(seq.c_str(), seq.size(), pos);
+	}
+
+	void new_seq(const uint8_t *packed, size_t len,
+				 const NIntervals &n_intervals, size_t start) override {
+		reset();
+		smers.new_seq(packed, len, n_intervals, start);
+		Digester<P, K>::new_seq(packed, len, n_intervals, start);
+	}
+
+	/**
+	 * @brief same as Digester::append_seq(), the s-mers are appended to as
+	 * well. These are not virtual, so call them on the SmerSyncmer rather
+	 * than through the Digester base class.
+	 *
+	 * @param seq
+	 * @param len
+	 *
+	 * @throws NotRolledTillEndException Thrown when the internal iterator is
+	 * not at the end of the current sequence
+	 */
+	void append_seq(const char *seq, size_t len) {
+		Digester<P, K>::append_seq(seq, len);
+		smers.insert_rest(ds);
+		smers.append_seq(seq, len);
+	}
+
+	/**
+	 * @brief same as the other append_seq
+	 *
+	 * @param seq
+	 *
+	 * @throws NotRolledTillEndException Thrown when the internal iterator is
+	 * not at the end of the current sequence
+	 */
+	void append_seq(const std::string &seq) {
+		append_seq(seq.c_str(), seq.size());
+	}
+
+	/**
+	 * @brief same as the other append_seq, for a 2-bit packed sequence
+	 *
+	 * @param packed
+	 * @param len
+	 * @param n_intervals
+	 *
+	 * @throws NotRolledTillEndException Thrown when the internal iterator is
+	 * not at the end of the current sequence
+	 */
+	void append_seq(const uint8_t *packed, size_t len,
+					const NIntervals &n_intervals) {
+		Digester<P, K>::append_seq(packed, len, n_intervals);
+		smers.insert_rest(ds);
+		smers.append_seq(packed, len, n_intervals);
+	}
+
+	/**
+	 *
+	 * @return unsigned, the value of s
+	 */
+	unsigned get_s() { return s; }
+
+  private:
+	SubHasher<P> smers;
+	unsigned s;
+
+	// minimum of the s-mers of the current k-mer
+	T ds;
+
+	// accept[j] is true if a minimal s-mer j bases into the k-mer makes it a
+	// syncmer
+	std::vector<bool> accept;
+
+	uint32_t window() {
+		if (s > this->k) {
+			throw BadSmerException();
+		}
+		return this->k - s + 1;
+	}
+
+	void init(const std::vector<unsigned> &offsets) {
+		accept.assign(window(), false);
+		for (unsigned offset : offsets) {
+			if (offset >= accept.size()) {
+				throw BadSmerException();
+			}
+			accept[offset] = true;
+		}
+	}
+
+	void reset() {
+		ds = T(window());
+	}
+
+	template <MinimizedHashType H, class Sink>
+	size_t roll_sync(unsigned amount, Sink &sink) {
+		size_t n = 0;
+		bool more = true;
+		while (this->is_valid_hash and n < amount and more) {
+			size_t pos = this->get_pos();
+			smers.template insert_until<H>(ds, pos + this->k - s);
+
+			// the s-mers of a valid k-mer are always consecutive, ds holds
+			// all of them and nothing else
+			if (smers.get_run() >= accept.size()) {
+				uint32_t offset = (uint32_t)ds.min() - (uint32_t)pos;
+				if (offset < accept.size() and accept[offset]) {
+					n++;
+					more = this->emit(sink, pos, [this] {
+						return this->template selected_hash<H>();
+					});
+				}
+			}
+
+			this->roll_one();
+		}
+		return n;
+	}
+};
+
+} // namespace digest
+
+#endif // SMER_SYNCMER_HPP
@@ -0,0 +1,437 @@
+#ifndef STROBEMER_HPP
+#define STROBEMER_HPP
+
+#include "digest/data_structure.hpp"
+#include "digest/digester.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace digest {
+
+/**
+ * @brief Exception thrown when initializing a Strobemer with an order other
+ * than 2 or 3, or with windows that are empty or start at the first strobe,
+ * i.e. w_min is 0 or greater than w_max.
+ *
+ *
+ */
+class BadStrobeException : public std::exception {
+	const char *what() const throw() {
+		return "order must be 2 or 3, and 0 < w_min <= w_max";
+	}
+};
+
+/**
+ * @brief how the strobes after the first one are picked from their windows
+ */
+enum class StrobeType {
+	/** the k-mer with the smallest hash in the window */
+	MINSTROBE,
+	/** the k-mer whose hash is smallest when combined with the strobes before
+	   it, so the strobes depend on each other */
+	RANDSTROBE
+};
+
+/**
+ * @brief a strobemer: the positions of its strobes, as defined by get_pos(),
+ * and its hash, which combines the hashes of all of them. pos[2] is only set
+ * for order 3 and is 0 otherwise.
+ */
+struct Strobes {
+	std::array<size_t, 3> pos;
+	uint64_t hash;
+
+	bool operator==(const Strobes &other) const {
+		return pos == other.pos and hash == other.hash;
+	}
+
+	bool operator!=(const Strobes &other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Child class of Digester that finds strobemers (Sahlin 2021): a
+ * strobemer of order 2 links the k-mer at i with one k-mer of the window
+ * [i + w_min, i + w_max], and one of order 3 adds one k-mer of
+ * [i + w_max + w_min, i + 2 w_max]. There is a strobemer for every k-mer whose
+ * windows are complete. Parameters without a description are the same as the
+ * parameters in the Digester parent class. They are simply passed up to the
+ * parent constructor.
+ *
+ * The windows are counted in k-mers, which are the positions of the k-mers
+ * as long as they are consecutive, and a strobemer never spans a skipped
+ * character, so sequences with non-ACTG characters give the strobemers of
+ * their ACTG parts. The k-mers are hashed once, and their hashes and
+ * positions are kept for the last (order - 1) * w_max + 1 of them, so a
+ * strobemer is found in the same pass over the sequence as its k-mers.
+ * Minstrobes keep the minimum of each window in T, so a k-mer costs one
+ * insert per window. Randstrobes depend on the strobes before them and can't
+ * use a sliding window minimum, their windows are scanned, which costs
+ * O(w_max - w_min + 1) per strobe.
+ *
+ * The hash of a strobemer is h1 ^ rotl(h2, 21) for order 2 and
+ * h1 ^ rotl(h2, 21) ^ rotl(h3, 42) for order 3, where hi is the hash of
+ * strobe i, selected by minimized_h.
+ *
+ * @tparam P
+ * @tparam T The data structure to use for finding the minimal k-mer of a
+ * window of minstrobes, over w_max - w_min + 1 k-mers. Ties go to the
+ * rightmost k-mer, and the 32-bit data structures compare the lower 32 bits
+ * of the hashes.
+ * @tparam K
+ */
+template <BadCharPolicy P, class T = ds::Adaptive, unsigned K = 0>
+class Strobemer : public Digester<P, K> {
+  public:
+	/**
+	 * @param seq
+	 * @param len
+	 * @param k
+	 * @param order number of strobes, 2 or 3
+	 * @param w_min offset of the first k-mer of a window from the end of the
+	 * previous window, or from the first strobe for the first window
+	 * @param w_max offset of the last k-mer of a window from the end of the
+	 * previous window, or from the first strobe for the first window
+	 * @param type minstrobes or randstrobes
+	 * @param start
+	 * @param minimized_h
+	 *
+	 * @throws BadStrobeException thrown when order is not 2 or 3, or w_min is
+	 * 0 or greater than w_max
+	 */
+	Strobemer(const char *seq, size_t len, unsigned k, unsigned order,
+			  unsigned w_min, unsigned w_max,
+			  StrobeType type = StrobeType::RANDSTROBE, size_t start = 0,
+			  MinimizedHashType minimized_h = MinimizedHashType::CANON)
+		: Digester<P, K>(seq, len, k, start, minimized_h), order(order),
+		  w_min(w_min), w_max(w_max), type(type), ds2(window()),
+		  ds3(window()) {
+		init();
+	}
+
+	/**
+	 * @param seq
+	 * @param k
+	 * @param order number of strobes, 2 or 3
+	 * @param w_min offset of the first k-mer of a window from the end of the
+	 * previous window, or from the first strobe for the first window
+	 * @param w_max offset of the last k-mer of a window from the end of the
+	 * previous window, or from the first strobe for the first window
+	 * @param type minstrobes or randstrobes
+	 * @param start
+	 * @param minimized_h
+	 *
+	 * @throws BadStrobeException thrown when order is not 2 or 3, or w_min is
+	 * 0 or greater than w_max
+	 */
+	Strobemer(const std::string &seq, unsigned k, unsigned order,
+			  unsigned w_min, unsigned w_max,
+			  StrobeType type = StrobeType::RANDSTROBE, size_t start = 0,
+			  MinimizedHashType minimized_h = MinimizedHashType::CANON)
+		: Strobemer<P, T, K>(seq.c_str(), seq.size(), k, order, w_min, w_max,
+							 type, start, minimized_h) {}
+
+	/**
+	 * @param packed
+	 * @param len
+	 * @param n_intervals
+	 * @param k
+	 * @param order number of strobes, 2 or 3
+	 * @param w_min offset of the first k-mer of a window from the end of the
+	 * previous window, or from the first strobe for the first window
+	 * @param w_max offset of the last k-mer of a window from the end of the
+	 * previous window, or from the first strobe for the first window
+	 * @param type minstrobes or randstrobes
+	 * @param start
+	 * @param minimized_h
+	 *
+	 * @throws BadStrobeException thrown when order is not 2 or 3, or w_min is
+	 * 0 or greater than w_max
+	 */
+	Strobemer(const uint8_t *packed, size_t len, const NIntervals &n_intervals,
+			  unsigned k, unsigned order, unsigned w_min, unsigned w_max,
+			  StrobeType type = StrobeType::RANDSTROBE, size_t start = 0,
+			  MinimizedHashType minimized_h = MinimizedHashType::CANON)
+		: Digester<P, K>(packed, len, n_intervals, k, start, minimized_h),
+		  order(order), w_min(w_min), w_max(w_max), type(type), ds2(window()),
+		  ds3(window()) {
+		init();
+	}
+
+	/**
+	 * @brief adds up to amount of positions of strobemers into vec, the
+	 * positions of their first strobes
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void roll_minimizer(unsigned amount, std::vector<uint32_t> &vec) override {
+		roll_minimizer(amount, [&vec](uint32_t pos) { vec.emplace_back(pos); });
+	}
+
+	/**
+	 * @brief adds up to amount of positions of the first strobes and hashes
+	 * of strobemers into vec. The hashes are truncated to 32 bits.
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void
+	roll_minimizer(unsigned amount,
+				   std::vector<std::pair<uint32_t, uint32_t>> &vec) override {
+		roll_minimizer(amount, [&vec](uint32_t pos, uint32_t hash) {
+			vec.emplace_back(pos, hash);
+		});
+	}
+
+	/**
+	 * @brief adds up to amount of positions of strobemers into vec, the
+	 * positions of their first strobes, without truncating them to 32 bits
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void roll_minimizer(unsigned amount, std::vector<uint64_t> &vec) override {
+		roll_minimizer(amount, [&vec](uint64_t pos) { vec.emplace_back(pos); });
+	}
+
+	/**
+	 * @brief adds up to amount of positions of the first strobes and hashes
+	 * of strobemers into vec, without truncating them to 32 bits
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void
+	roll_minimizer(unsigned amount,
+				   std::vector<std::pair<uint64_t, uint64_t>> &vec) override {
+		roll_minimizer(amount, [&vec](uint64_t pos, uint64_t hash) {
+			vec.emplace_back(pos, hash);
+		});
+	}
+
+	/**
+	 * @brief adds up to amount of strobemers into vec, with the positions of
+	 * all of their strobes
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void roll_minimizer(unsigned amount, std::vector<Strobes> &vec) {
+		roll_minimizer(amount,
+					   [&vec](const Strobes &s) { vec.emplace_back(s); });
+	}
+
+	/**
+	 * @brief passes up to amount strobemers, the same ones the other
+	 * roll_minimizer functions would add to a vector, to sink, so they can go
+	 * straight into an index or a stream without being stored first. sink is
+	 * called as sink(strobes) with a const Strobes & if it accepts that, as
+	 * sink(position) if it accepts that, and as sink(position, hash)
+	 * otherwise. The position is the size_t position of the first strobe, and
+	 * the hash is the 64-bit hash of the strobemer. If it returns bool,
+	 * returning false stops rolling after that strobemer, e.g. when a fixed
+	 * size buffer is full, and the next call continues from there.
+	 *
+	 * @param amount
+	 * @param sink
+	 *
+	 * @return size_t, the number of strobemers passed to sink
+	 */
+	template <class Sink> size_t roll_minimizer(unsigned amount, Sink &&sink) {
+		switch (this->get_minimized_h()) {
+		case MinimizedHashType::FORWARD:
+			return roll_strobe<MinimizedHashType::FORWARD>(amount, sink);
+		case MinimizedHashType::REVERSE:
+			return roll_strobe<MinimizedHashType::REVERSE>(amount, sink);
+		default:
+			return roll_strobe<MinimizedHashType::CANON>(amount, sink);
+		}
+	}
+
+	void new_seq(const char *seq, size_t len, size_t start) override {
+		reset();
+		Digester<P, K>::new_seq(seq, len, start);
+	}
+
+	void new_seq(const std::string &seq, size_t pos) override {
+		new_seq(seq.c_str(), seq.size(), pos);
+	}
+
+	void new_seq(const uint8_t *packed, size_t len,
+				 const NIntervals &n_intervals, size_t start) override {
+		reset();
+		Digester<P, K>::new_seq(packed, len, n_intervals, start);
+	}
+
+	/**
+	 *
+	 * @return unsigned, the number of strobes
+	 */
+	unsigned get_order() { return order; }
+
+	/**
+	 *
+	 * @return unsigned, the value of w_min
+	 */
+	unsigned get_w_min() { return w_min; }
+
+	/**
+	 *
+	 * @return unsigned, the value of w_max
+	 */
+	unsigned get_w_max() { return w_max; }
+
+	/**
+	 *
+	 * @return StrobeType, minstrobes or randstrobes
+	 */
+	StrobeType get_type() { return type; }
+
+  private:
+	unsigned order, w_min, w_max;
+	StrobeType type;
+
+	// minimum of the window of the second and the third strobe of minstrobes
+	T ds2, ds3;
+
+	// hashes and positions of the last k-mers, by number of k-mers rolled
+	std::vector<uint64_t> hashes;
+	std::vector<size_t> positions;
+	size_t mask = 0;
+
+	// number of k-mers rolled, number of consecutive k-mers up to the current
+	// one, and the position of the next one, so k-mers before a skipped
+	// character never count
+	size_t count = 0, run = 0, next_pos = 0;
+
+	uint32_t window() {
+		if ((order != 2 and order != 3) or w_min == 0 or w_min > w_max) {
+			throw BadStrobeException();
+		}
+		return w_max - w_min + 1;
+	}
+
+	void init() {
+		size_t cap = 1;
+		while (cap < (size_t)(order - 1) * w_max + 1) {
+			cap <<= 1;
+		}
+		hashes.resize(cap);
+		positions.resize(cap);
+		mask = cap - 1;
+	}
+
+	void reset() {
+		ds2 = T(window());
+		ds3 = T(window());
+		run = 0;
+		next_pos = 0;
+	}
+
+	static uint64_t rotl(uint64_t x, unsigned r) {
+		return x << r | x >> (64 - r);
+	}
+
+	/**
+	 * @return size_t, the k-mer of the window [first, last] with the smallest
+	 * base ^ hash, the rightmost one on ties
+	 */
+	size_t scan(size_t first, size_t last, uint64_t base) {
+		size_t best = first;
+		uint64_t best_key = base ^ hashes[first & mask];
+		for (size_t c = first + 1; c <= last; c++) {
+			uint64_t key = base ^ hashes[c & mask];
+			if (key <= best_key) {
+				best = c;
+				best_key = key;
+			}
+		}
+		return best;
+	}
+
+	/**
+	 * @brief the strobemer whose first strobe is the k-mer first, the last
+	 * k-mer of its last window was just rolled
+	 */
+	Strobes strobes(size_t first) {
+		size_t second, third = 0;
+		if (type == StrobeType::MINSTROBE) {
+			second = ds2.min() & mask;
+			if (order == 3) {
+				third = ds3.min() & mask;
+			}
+		} else {
+			uint64_t h1 = hashes[first & mask];
+			second = scan(first + w_min, first + w_max, h1);
+			if (order == 3) {
+				third = scan(first + w_max + w_min, first + 2 * w_max,
+							 h1 ^ hashes[second & mask]);
+			}
+		}
+		Strobes s;
+		s.pos = {positions[first & mask], positions[second & mask], 0};
+		s.hash = hashes[first & mask] ^ rotl(hashes[second & mask], 21);
+		if (order == 3) {
+			s.pos[2] = positions[third & mask];
+			s.hash ^= rotl(hashes[third & mask], 42);
+		}
+		return s;
+	}
+
+	template <MinimizedHashType H, class Sink>
+	size_t roll_strobe(unsigned amount, Sink &sink) {
+		size_t n = 0;
+		bool more = true;
+		size_t span = (size_t)(order - 1) * w_max;
+		while (this->is_valid_hash and n < amount and more) {
+			size_t pos = this->get_pos();
+			run = pos == next_pos ? run + 1 : 1;
+			next_pos = pos + 1;
+			hashes[count & mask] = this->template selected_hash<H>();
+			positions[count & mask] = pos;
+
+			if (type == StrobeType::MINSTROBE) {
+				// the windows end w_max apart, ds2 lags behind ds3
+				if (order == 2) {
+					ds2.insert(count, hashes[count & mask]);
+				} else {
+					ds3.insert(count, hashes[count & mask]);
+					if (count >= w_max) {
+						size_t lag = count - w_max;
+						ds2.insert(lag, hashes[lag & mask]);
+					}
+				}
+			}
+
+			// the windows only hold k-mers of the current run once it is
+			// longer than a strobemer
+			if (run > span) {
+				Strobes s = strobes(count - span);
+				n++;
+				if constexpr (std::is_invocable_v<Sink &, const Strobes &>) {
+					if constexpr (std::is_same_v<
+									  std::invoke_result_t<Sink &,
+														   const Strobes &>,
+									  bool>) {
+						more = sink(s);
+					} else {
+						sink(s);
+					}
+				} else {
+					more = this->emit(sink, s.pos[0], [&s] { return s.hash; });
+				}
+			}
+
+			count++;
+			this->roll_one();
+		}
+		return n;
+	}
+};
+
+} // namespace digest
+
+#endif // STROBEMER_HPP
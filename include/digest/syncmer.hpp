@@ -3,6 +3,8 @@
 
 #include "digest/digester.hpp"
 #include "digest/window_minimizer.hpp"
+#include <type_traits>
+#include <utility>
 
 namespace digest {
 
@@ -17,8 +19,13 @@ namespace digest {
  * @tparam P
  * @tparam T The data structure to use for performing range minimum queries to
  * find the minimal hash value.
+ * @tparam K
+ * @tparam O The order of the k-mers, see the order namespace. With an order
+ * other than order::Hash, a syncmer is a large window whose first or last
+ * k-mer has the minimal key, and the hashes passed on are those keys.
  */
-template <BadCharPolicy P, class T> class Syncmer : public WindowMin<P, T> {
+template <BadCharPolicy P, class T, unsigned K = 0, class O = order::Hash>
+class Syncmer : public WindowMin<P, T, K, O> {
   public:
 	/**
 	 *
@@ -35,7 +42,8 @@ template <BadCharPolicy P, class T> class Syncmer : public WindowMin<P, T> {
 	Syncmer(const char *seq, size_t len, unsigned k, unsigned large_window,
 			size_t start = 0,
 			MinimizedHashType minimized_h = MinimizedHashType::CANON)
-		: WindowMin<P, T>(seq, len, k, large_window, start, minimized_h) {}
+		: WindowMin<P, T, K, O>(seq, len, k, large_window, start,
+								minimized_h) {}
 
 	/**
 	 *
@@ -51,8 +59,27 @@ template <BadCharPolicy P, class T> class Syncmer : public WindowMin<P, T> {
 	Syncmer(const std::string &seq, unsigned k, unsigned large_window,
 			size_t start = 0,
 			MinimizedHashType minimized_h = MinimizedHashType::CANON)
-		: Syncmer<P, T>(seq.c_str(), seq.size(), k, large_window, start,
-						minimized_h) {}
+		: Syncmer<P, T, K, O>(seq.c_str(), seq.size(), k, large_window, start,
+							  minimized_h) {}
+
+	/**
+	 *
+	 * @param packed
+	 * @param len
+	 * @param n_intervals
+	 * @param k
+	 * @param large_window the number of kmers in the large window, i.e. the
+	 * number of kmers to be considered during the range minimum query.
+	 * @param start
+	 * @param minimized_h
+	 *
+	 * @throws BadWindowException Thrown when large_window is passed in as 0
+	 */
+	Syncmer(const uint8_t *packed, size_t len, const NIntervals &n_intervals,
+			unsigned k, unsigned large_window, size_t start = 0,
+			MinimizedHashType minimized_h = MinimizedHashType::CANON)
+		: WindowMin<P, T, K, O>(packed, len, n_intervals, k, large_window,
+								start, minimized_h) {}
 
 	/**
 	 * @brief adds up to amount of positions of syncmers into vec. Here
@@ -63,25 +90,7 @@ template <BadCharPolicy P, class T> class Syncmer : public WindowMin<P, T> {
 	 * @param vec
 	 */
 	void roll_minimizer(unsigned amount, std::vector<uint32_t> &vec) override {
-		amount += vec.size();
-
-		while (this->ds_size + 1 < this->large_window and this->is_valid_hash) {
-			if (this->get_minimized_h() == digest::MinimizedHashType::CANON) {
-				this->ds.insert(this->get_pos(), this->chash);
-			} else if (this->get_minimized_h() ==
-					   digest::MinimizedHashType::FORWARD) {
-				this->ds.insert(this->get_pos(), this->fhash);
-			} else {
-				this->ds.insert(this->get_pos(), this->rhash);
-			}
-
-			this->roll_one();
-			this->ds_size++;
-		}
-
-		while (this->is_valid_hash and vec.size() < amount) {
-			Syncmer::roll_ds_sync(vec);
-		}
+		roll_minimizer(amount, [&vec](uint32_t pos) { vec.emplace_back(pos); });
 	}
 
 	/**
@@ -95,65 +104,189 @@ template <BadCharPolicy P, class T> class Syncmer : public WindowMin<P, T> {
 	void
 	roll_minimizer(unsigned amount,
 				   std::vector<std::pair<uint32_t, uint32_t>> &vec) override {
-		amount += vec.size();
-
-		while (this->ds_size + 1 < this->large_window and this->is_valid_hash) {
-			if (this->get_minimized_h() == digest::MinimizedHashType::CANON) {
-				this->ds.insert(this->get_pos(), this->chash);
-			} else if (this->get_minimized_h() ==
-					   digest::MinimizedHashType::FORWARD) {
-				this->ds.insert(this->get_pos(), this->fhash);
-			} else {
-				this->ds.insert(this->get_pos(), this->rhash);
-			}
+		roll_minimizer(amount, [&vec](uint32_t pos, uint32_t hash) {
+			vec.emplace_back(pos, hash);
+		});
+	}
 
-			this->roll_one();
-			this->ds_size++;
-		}
+	/**
+	 * @brief adds up to amount of positions of syncmers into vec, without
+	 * truncating them to 32 bits. Here a large window is considered a syncmer
+	 * if the smallest hash in the large window is at the leftmost or rightmost
+	 * position.
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void roll_minimizer(unsigned amount, std::vector<uint64_t> &vec) override {
+		roll_minimizer(amount, [&vec](uint64_t pos) { vec.emplace_back(pos); });
+	}
 
-		while (this->is_valid_hash and vec.size() < amount) {
-			Syncmer::roll_ds_sync(vec);
-		}
+	/**
+	 * @brief adds up to amount of positions and hashes of syncmers into vec,
+	 * without truncating the positions to 32 bits. The hashes are only 64
+	 * bits wide if the data structure compares 64-bit hashes, e.g.
+	 * ds::Adaptive64. Here a large window is considered a syncmer if the
+	 * smallest hash in the large window is at the leftmost or rightmost
+	 * position.
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void
+	roll_minimizer(unsigned amount,
+				   std::vector<std::pair<uint64_t, uint64_t>> &vec) override {
+		roll_minimizer(amount, [&vec](uint64_t pos, uint64_t hash) {
+			vec.emplace_back(pos, hash);
+		});
 	}
 
-  private:
 	/**
-	 * @brief helper function which handles adding the next hash into the data
-	 * structure
+	 * @brief passes up to amount syncmers, the same ones the other
+	 * roll_minimizer functions would add to a vector, to sink, so they can go
+	 * straight into an index or a stream without being stored first. sink is
+	 * called as sink(position) if it accepts that, and as sink(position, hash)
+	 * otherwise. The position is a size_t, and the hash is the hash the data
+	 * structure compares, 32 or 64 bits wide. If it returns bool, returning
+	 * false stops rolling after that syncmer, e.g. when a fixed size buffer is
+	 * full, and the next call continues from there.
 	 *
+	 * @param amount
+	 * @param sink
+	 *
+	 * @return size_t, the number of syncmers passed to sink
 	 */
-	void roll_ds_sync(std::vector<uint32_t> &vec) {
-		if (this->get_minimized_h() == digest::MinimizedHashType::CANON) {
-			this->ds.insert(this->get_pos(), this->chash);
-		} else if (this->get_minimized_h() ==
-				   digest::MinimizedHashType::FORWARD) {
-			this->ds.insert(this->get_pos(), this->fhash);
-		} else {
-			this->ds.insert(this->get_pos(), this->rhash);
+	template <class Sink> size_t roll_minimizer(unsigned amount, Sink &&sink) {
+		switch (this->get_minimized_h()) {
+		case MinimizedHashType::FORWARD:
+			return roll_sync_sink<MinimizedHashType::FORWARD>(amount, sink);
+		case MinimizedHashType::REVERSE:
+			return roll_sync_sink<MinimizedHashType::REVERSE>(amount, sink);
+		default:
+			return roll_sync_sink<MinimizedHashType::CANON>(amount, sink);
 		}
-		this->ds.min_syncmer(vec);
+	}
 
-		this->roll_one();
+	/**
+	 * @brief applies the selection of roll_minimizer() to hashes and positions
+	 * that were already produced by roll_hashes() or roll_hashes_lanes(), and
+	 * adds the positions of the syncmers into vec. Only for order::Hash, like
+	 * WindowMin::select_minimizers()
+	 *
+	 * @param hashes
+	 * @param positions
+	 * @param n number of k-mers in hashes and positions
+	 * @param vec
+	 */
+	void select_minimizers(const uint64_t *hashes, const uint32_t *positions,
+						   size_t n, std::vector<uint32_t> &vec) {
+		static_assert(std::is_same_v<O, order::Hash>,
+					  "select_minimizers only orders k-mers by hash");
+		select_block(hashes, positions, n, vec);
 	}
 
 	/**
-	 * @brief helper function which handles adding the next hash into the data
-	 * structure
+	 * @brief same as the other select_minimizers, except the hashes of the
+	 * syncmers are added as well
 	 *
+	 * @param hashes
+	 * @param positions
+	 * @param n
+	 * @param vec
 	 */
-	void roll_ds_sync(std::vector<std::pair<uint32_t, uint32_t>> &vec) {
-		if (this->get_minimized_h() == digest::MinimizedHashType::CANON) {
-			this->ds.insert(this->get_pos(), this->chash);
-		} else if (this->get_minimized_h() ==
-				   digest::MinimizedHashType::FORWARD) {
-			this->ds.insert(this->get_pos(), this->fhash);
-		} else {
-			this->ds.insert(this->get_pos(), this->rhash);
+	void select_minimizers(const uint64_t *hashes, const uint32_t *positions,
+						   size_t n,
+						   std::vector<std::pair<uint32_t, uint32_t>> &vec) {
+		static_assert(std::is_same_v<O, order::Hash>,
+					  "select_minimizers only orders k-mers by hash");
+		select_block(hashes, positions, n, vec);
+	}
+
+  private:
+	/**
+	 * @brief helper function for select_minimizers(). The windows whose
+	 * oldest k-mer is in the block are checked against the minimum reported
+	 * by insert_many(), the ones before that with min_syncmer()
+	 *
+	 * @param hashes
+	 * @param positions
+	 * @param n
+	 * @param vec
+	 */
+	template <class Vec>
+	void select_block(const uint64_t *hashes, const uint32_t *positions,
+					  size_t n, Vec &vec) {
+		size_t i = 0;
+		for (; i < n && this->ds_size + 1 < this->large_window; i++) {
+			this->ds.insert(positions[i], hashes[i]);
+			this->ds_size++;
 		}
-		this->ds.min_syncmer(vec);
+		for (; i < n && i + 1 < this->large_window; i++) {
+			this->ds.insert(positions[i], hashes[i]);
+			this->ds.min_syncmer(found);
+			if (!found.empty()) {
+				add(vec, found[0].first, found[0].second);
+				found.clear();
+			}
+		}
+
+		typedef decltype(this->ds.min_hash()) Hash;
+		Hash min = this->ds.min_hash();
+		size_t next = i;
+		// the windows up to end, where the minimum stayed the same
+		auto check = [&](size_t end) {
+			for (; next < end; next++) {
+				size_t oldest = next + 1 - this->large_window;
+				if ((Hash)hashes[oldest] == min || (Hash)hashes[next] == min) {
+					add(vec, positions[oldest], min);
+				}
+			}
+		};
+		this->ds.insert_many(positions + i, hashes + i, n - i,
+							 [&](size_t j, auto, Hash hash) {
+								 check(i + j);
+								 min = hash;
+							 });
+		check(n);
+	}
+
+	static void add(std::vector<uint32_t> &vec, uint32_t index, uint64_t) {
+		vec.emplace_back(index);
+	}
 
-		this->roll_one();
+	static void add(std::vector<std::pair<uint32_t, uint32_t>> &vec,
+					uint32_t index, uint64_t hash) {
+		vec.emplace_back(index, hash);
 	}
+
+	template <MinimizedHashType H, class Sink>
+	size_t roll_sync_sink(unsigned amount, Sink &sink) {
+		this->template fill_window<H>();
+
+		size_t n = 0;
+		bool more = true;
+		while (this->is_valid_hash and n < amount and more) {
+			this->ds.insert(this->get_pos(), this->template key<H>());
+			this->ds.min_syncmer(found);
+			if (!found.empty()) {
+				auto hash = found[0].second;
+				n++;
+				more = this->emit(sink, this->widen(found[0].first),
+								  [hash] { return hash; });
+				found.clear();
+			}
+
+			this->roll_one();
+		}
+		return n;
+	}
+
+	// holds the syncmer found by the data structure until it is passed to a
+	// sink, keeps its capacity so rolling into a sink doesn't allocate. Its
+	// types are the index and hash types of the data structure
+	std::vector<std::pair<decltype(std::declval<T &>().min()),
+						  decltype(std::declval<T &>().min_hash())>>
+		found;
 };
 
 } // namespace digest
@@ -2,10 +2,13 @@
 #define THREAD_OUT_HPP
 
 #include "digest/mod_minimizer.hpp"
+#include "digest/strobemer.hpp"
 #include "digest/syncmer.hpp"
 #include "digest/window_minimizer.hpp"
+#include "digest/window_mod_minimizer.hpp"
 #include <cstdint>
 #include <future>
+#include <limits>
 #include <thread>
 #include <vector>
 
@@ -26,6 +29,12 @@
  * actually goes through the sequence, so it's going to try to partition the
  * sequence into ACTGANACNA, and ANACNACTGA and feed it into 2 digester objects
  * which now each have 0 valid large windows
+ *
+ * @par Output types:
+ * the functions that take a vector of vectors accept the same element types as
+ * roll_minimizer(), uint32_t or std::pair<uint32_t, uint32_t> for the 32-bit
+ * fast path, and uint64_t or std::pair<uint64_t, uint64_t> for sequences
+ * longer than 2^32 bases.
  */
 namespace digest::thread_out {
 
@@ -43,84 +52,147 @@ class BadThreadOutParams : public std::exception {
 
 //------------- WORKER FUNCTIONS ----------------
 
+/**
+ * @brief rolls dig until the end of its sequence. The digesters of the workers
+ * end where the part of the sequence given to their thread ends, but
+ * roll_minimizer() only takes an unsigned amount, which a part of a sequence
+ * longer than 2^32 bases can have more minimizers than.
+ */
+template <class D, class Out> void roll_to_end(D &dig, Out &out) {
+	do {
+		dig.roll_minimizer(std::numeric_limits<unsigned>::max(), out);
+	} while (dig.get_is_valid_hash());
+}
+
 // function that's passed to the thread for ModMinmizers
-template <digest::BadCharPolicy P>
-std::vector<uint32_t> thread_mod_roll1(const char *seq, size_t ind, unsigned k,
-									   uint32_t mod, uint32_t congruence,
-									   digest::MinimizedHashType minimized_h,
-									   unsigned assigned_kmer_am) {
-	std::vector<uint32_t> out;
+template <digest::BadCharPolicy P, class V>
+std::vector<V> thread_mod_roll(const char *seq, size_t ind, unsigned k,
+							   uint32_t mod, uint32_t congruence,
+							   digest::MinimizedHashType minimized_h,
+							   size_t assigned_kmer_am) {
+	std::vector<V> out;
 	digest::ModMin<P> dig(seq, ind + assigned_kmer_am + k - 1, k, mod,
 						  congruence, ind, minimized_h);
-	dig.roll_minimizer(assigned_kmer_am, out);
+	roll_to_end(dig, out);
 	return out;
 }
 
-template <digest::BadCharPolicy P>
-std::vector<std::pair<uint32_t, uint32_t>>
-thread_mod_roll2(const char *seq, size_t ind, unsigned k, uint32_t mod,
-				 uint32_t congruence, digest::MinimizedHashType minimized_h,
-				 unsigned assigned_kmer_am) {
-	std::vector<std::pair<uint32_t, uint32_t>> out;
-	digest::ModMin<P> dig(seq, ind + assigned_kmer_am + k - 1, k, mod,
-						  congruence, ind, minimized_h);
-	dig.roll_minimizer(assigned_kmer_am, out);
+// function that's passed to the thread for WindowMinimizers and
+// ModMinimizers, D is the digester
+template <class D, class V>
+std::vector<V> thread_wind_roll(const char *seq, size_t ind, unsigned k,
+								uint32_t large_wind_kmer_am,
+								digest::MinimizedHashType minimized_h,
+								size_t assigned_lwind_am) {
+	std::vector<V> out;
+	D dig(seq, ind + assigned_lwind_am + k + large_wind_kmer_am - 2, k,
+		  large_wind_kmer_am, ind, minimized_h);
+	roll_to_end(dig, out);
 	return out;
 }
 
-// function that's passed to the thread for WindowMinimizers
-template <digest::BadCharPolicy P, class T>
-std::vector<uint32_t> thread_wind_roll1(const char *seq, size_t ind, unsigned k,
-										uint32_t large_wind_kmer_am,
-										digest::MinimizedHashType minimized_h,
-										unsigned assigned_lwind_am) {
-	std::vector<uint32_t> out;
-	digest::WindowMin<P, T> dig(
-		seq, ind + assigned_lwind_am + k + large_wind_kmer_am - 1 - 1, k,
+// function that's passed to the thread for Syncmers
+template <digest::BadCharPolicy P, class T, class V>
+std::vector<V> thread_sync_roll(const char *seq, size_t ind, unsigned k,
+								uint32_t large_wind_kmer_am,
+								digest::MinimizedHashType minimized_h,
+								size_t assigned_lwind_am) {
+	std::vector<V> out;
+	digest::Syncmer<P, T> dig(
+		seq, ind + assigned_lwind_am + k + large_wind_kmer_am - 2, k,
 		large_wind_kmer_am, ind, minimized_h);
-	dig.roll_minimizer(assigned_lwind_am, out);
+	roll_to_end(dig, out);
 	return out;
 }
 
-template <digest::BadCharPolicy P, class T>
-std::vector<std::pair<uint32_t, uint32_t>> thread_wind_roll2(
-	const char *seq, size_t ind, unsigned k, uint32_t large_wind_kmer_am,
-	digest::MinimizedHashType minimized_h, unsigned assigned_lwind_am) {
-	std::vector<std::pair<uint32_t, uint32_t>> out;
-	digest::WindowMin<P, T> dig(
-		seq, ind + assigned_lwind_am + k + large_wind_kmer_am - 1 - 1, k,
-		large_wind_kmer_am, ind, minimized_h);
-	dig.roll_minimizer(assigned_lwind_am, out);
+// function that's passed to the thread for Strobemers
+template <digest::BadCharPolicy P, class T, class V>
+std::vector<V> thread_strobe_roll(const char *seq, size_t ind, unsigned k,
+								  unsigned order, unsigned w_min,
+								  unsigned w_max, digest::StrobeType type,
+								  digest::MinimizedHashType minimized_h,
+								  size_t assigned_strobe_am) {
+	std::vector<V> out;
+	digest::Strobemer<P, T> dig(
+		seq, ind + assigned_strobe_am + k + (size_t)(order - 1) * w_max - 1, k,
+		order, w_min, w_max, type, ind, minimized_h);
+	roll_to_end(dig, out);
 	return out;
 }
 
-// function that's passed to the thread for Syncmers
-template <digest::BadCharPolicy P, class T>
-std::vector<uint32_t> thread_sync_roll1(const char *seq, size_t ind, unsigned k,
-										uint32_t large_wind_kmer_am,
-										digest::MinimizedHashType minimized_h,
-										unsigned assigned_lwind_am) {
-	std::vector<uint32_t> out;
-	digest::Syncmer<P, T> dig(
-		seq, ind + assigned_lwind_am + k + large_wind_kmer_am - 1 - 1, k,
-		large_wind_kmer_am, ind, minimized_h);
-	dig.roll_minimizer(assigned_lwind_am, out);
-	return out;
+// functions that are passed to the threads when minimizers go to sinks
+template <digest::BadCharPolicy P, class Sink>
+void thread_mod_sink(const char *seq, size_t ind, unsigned k, uint32_t mod,
+					 uint32_t congruence, digest::MinimizedHashType minimized_h,
+					 size_t assigned_kmer_am, Sink *sink) {
+	digest::ModMin<P> dig(seq, ind + assigned_kmer_am + k - 1, k, mod,
+						  congruence, ind, minimized_h);
+	roll_to_end(dig, *sink);
 }
 
-template <digest::BadCharPolicy P, class T>
-std::vector<std::pair<uint32_t, uint32_t>> thread_sync_roll2(
-	const char *seq, size_t ind, unsigned k, uint32_t large_wind_kmer_am,
-	digest::MinimizedHashType minimized_h, unsigned assigned_lwind_am) {
-	std::vector<std::pair<uint32_t, uint32_t>> out;
+template <class D, class Sink>
+void thread_wind_sink(const char *seq, size_t ind, unsigned k,
+					  uint32_t large_wind_kmer_am,
+					  digest::MinimizedHashType minimized_h,
+					  size_t assigned_lwind_am, bool first, Sink *sink) {
+	// every thread but the first also digests the last large window of the
+	// previous thread without passing its minimizer on, so a minimizer
+	// shared by both threads only goes to the previous thread's sink
+	size_t from = first ? ind : ind - 1;
+	D dig(seq, ind + assigned_lwind_am + k + large_wind_kmer_am - 2, k,
+		  large_wind_kmer_am, from, minimized_h);
+	if (!first) {
+		dig.roll_minimizer(1, [](size_t) {});
+	}
+	roll_to_end(dig, *sink);
+}
+
+template <digest::BadCharPolicy P, class T, class Sink>
+void thread_sync_sink(const char *seq, size_t ind, unsigned k,
+					  uint32_t large_wind_kmer_am,
+					  digest::MinimizedHashType minimized_h,
+					  size_t assigned_lwind_am, Sink *sink) {
 	digest::Syncmer<P, T> dig(
-		seq, ind + assigned_lwind_am + k + large_wind_kmer_am - 1 - 1, k,
+		seq, ind + assigned_lwind_am + k + large_wind_kmer_am - 2, k,
 		large_wind_kmer_am, ind, minimized_h);
-	dig.roll_minimizer(assigned_lwind_am, out);
-	return out;
+	roll_to_end(dig, *sink);
+}
+
+template <digest::BadCharPolicy P, class T, class Sink>
+void thread_strobe_sink(const char *seq, size_t ind, unsigned k,
+						unsigned order, unsigned w_min, unsigned w_max,
+						digest::StrobeType type,
+						digest::MinimizedHashType minimized_h,
+						size_t assigned_strobe_am, Sink *sink) {
+	digest::Strobemer<P, T> dig(
+		seq, ind + assigned_strobe_am + k + (size_t)(order - 1) * w_max - 1, k,
+		order, w_min, w_max, type, ind, minimized_h);
+	roll_to_end(dig, *sink);
+}
+
+/**
+ * @brief number of k-mers (span = k), large windows
+ * (span = k + large_wind_kmer_am - 1) or strobemers
+ * (span = k + (order - 1) * w_max) in seq[start, len), computed in size_t
+ * so it doesn't overflow for sequences longer than 2^31 bases
+ *
+ * @throws BadThreadOutParams if there are fewer than thread_count of them
+ */
+inline size_t count_spans(size_t len, size_t start, size_t span,
+						  unsigned thread_count) {
+	if (start >= len || len - start < span ||
+		len - start - span + 1 < thread_count) {
+		throw BadThreadOutParams();
+	}
+	return len - start - span + 1;
 }
 
 /**
+ * @tparam P policy for dealing with non-ACTG characters
+ * @tparam V uint32_t or uint64_t for the positions of the minimizers, or
+ * std::pair<uint32_t, uint32_t> or std::pair<uint64_t, uint64_t> for their
+ * positions and hashes
+ *
  * @param thread_count the number of threads to use
  * @param vec a vector of vectors in which the minimizers will be placed.
  *      Each vector corresponds to one thread. The minimizers within each vector
@@ -140,34 +212,33 @@ std::vector<std::pair<uint32_t, uint32_t>> thread_sync_roll2(
  *
  * @throws BadThreadOutParams
  */
-template <digest::BadCharPolicy P>
+template <digest::BadCharPolicy P, class V>
 void thread_mod(
-	unsigned thread_count, std::vector<std::vector<uint32_t>> &vec,
-	const char *seq, size_t len, unsigned k, uint32_t mod,
-	uint32_t congruence = 0, size_t start = 0,
+	unsigned thread_count, std::vector<std::vector<V>> &vec, const char *seq,
+	size_t len, unsigned k, uint32_t mod, uint32_t congruence = 0,
+	size_t start = 0,
 	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
-	int num_kmers = (int)len - (int)start - (int)k + 1;
-	if (k < 4 || start >= len || num_kmers < 0 ||
-		(unsigned)num_kmers < thread_count) {
+	if (k < 4) {
 		throw BadThreadOutParams();
 	}
-	unsigned kmers_per_thread = num_kmers / thread_count;
-	unsigned extras = num_kmers % thread_count;
+	size_t num_kmers = count_spans(len, start, k, thread_count);
+	size_t kmers_per_thread = num_kmers / thread_count;
+	size_t extras = num_kmers % thread_count;
 	vec.reserve(thread_count);
-	std::vector<std::future<std::vector<uint32_t>>> thread_vector;
+	std::vector<std::future<std::vector<V>>> thread_vector;
 
 	size_t ind = start;
 	for (unsigned i = 0; i < thread_count; i++) {
 		// issue is here
 		// this will lead to a leak
-		unsigned assigned_kmer_am = kmers_per_thread;
+		size_t assigned_kmer_am = kmers_per_thread;
 		if (extras > 0) {
 			++(assigned_kmer_am);
 			extras--;
 		}
 
-		thread_vector.emplace_back(std::async(thread_mod_roll1<P>, seq, ind, k,
-											  mod, congruence, minimized_h,
+		thread_vector.emplace_back(std::async(thread_mod_roll<P, V>, seq, ind,
+											  k, mod, congruence, minimized_h,
 											  assigned_kmer_am));
 
 		ind += assigned_kmer_am;
@@ -183,9 +254,9 @@ void thread_mod(
  *
  * @param seq C++ string of DNA sequence to be hashed.
  */
-template <digest::BadCharPolicy P>
+template <digest::BadCharPolicy P, class V>
 void thread_mod(
-	unsigned thread_count, std::vector<std::vector<uint32_t>> &vec,
+	unsigned thread_count, std::vector<std::vector<V>> &vec,
 	const std::string &seq, unsigned k, uint32_t mod, uint32_t congruence = 0,
 	size_t start = 0,
 	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
@@ -194,120 +265,102 @@ void thread_mod(
 }
 
 /**
- * @brief same as other thread_mod that takes a c-string,
- * except here vec is a vector of vectors of pairs of uint32_ts
+ * @brief same as the other thread_mod functions, except the minimizers of
+ * thread i are passed to sinks[i] instead of being stored in a vector, see
+ * ModMin::roll_minimizer(unsigned, Sink &&). Each sink is only used by its own
+ * thread, so it doesn't need to be thread safe, and it receives its
+ * minimizers in ascending order by index. All minimizers passed to sinks[i]
+ * go before all minimizers passed to sinks[i + 1]. Every thread rolls to the
+ * end of its part of the sequence, so the return value of the sinks is
+ * ignored.
+ *
+ * @param sinks at least thread_count sinks
  *
- * @param vec vec will contain both the index and the hash of minimizers.
- * All other things previously stated about vec remain true
+ * @throws BadThreadOutParams
  */
-template <digest::BadCharPolicy P>
+template <digest::BadCharPolicy P, class Sink>
 void thread_mod(
-	unsigned thread_count,
-	std::vector<std::vector<std::pair<uint32_t, uint32_t>>> &vec,
-	const char *seq, size_t len, unsigned k, uint32_t mod,
-	uint32_t congruence = 0, size_t start = 0,
+	unsigned thread_count, std::vector<Sink> &sinks, const char *seq,
+	size_t len, unsigned k, uint32_t mod, uint32_t congruence = 0,
+	size_t start = 0,
 	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
-	int num_kmers = (int)len - (int)start - (int)k + 1;
-	if (k < 4 || start >= len || num_kmers < 0 ||
-		(unsigned)num_kmers < thread_count) {
+	if (k < 4 || sinks.size() < thread_count) {
 		throw BadThreadOutParams();
 	}
-	unsigned kmers_per_thread = num_kmers / thread_count;
-	unsigned extras = num_kmers % thread_count;
-	vec.reserve(thread_count);
-	std::vector<std::future<std::vector<std::pair<uint32_t, uint32_t>>>>
-		thread_vector;
+	size_t num_kmers = count_spans(len, start, k, thread_count);
+	size_t kmers_per_thread = num_kmers / thread_count;
+	size_t extras = num_kmers % thread_count;
+	std::vector<std::future<void>> thread_vector;
 
 	size_t ind = start;
 	for (unsigned i = 0; i < thread_count; i++) {
-		// issue is here
-		// this will lead to a leak
-		unsigned assigned_kmer_am = kmers_per_thread;
+		size_t assigned_kmer_am = kmers_per_thread;
 		if (extras > 0) {
 			++(assigned_kmer_am);
 			extras--;
 		}
 
-		thread_vector.emplace_back(std::async(thread_mod_roll2<P>, seq, ind, k,
-											  mod, congruence, minimized_h,
-											  assigned_kmer_am));
+		thread_vector.emplace_back(std::async(
+			thread_mod_sink<P, Sink>, seq, ind, k, mod, congruence,
+			minimized_h, assigned_kmer_am, &sinks[i]));
 
 		ind += assigned_kmer_am;
 	}
 	for (auto &t : thread_vector) {
-		vec.emplace_back(t.get());
+		t.get();
 	}
 }
 
 /**
- * @brief same as other thread_mod that takes a C++ string,
- * except here vec is a vector of vectors of pairs of uint32_ts
+ * @brief same as the other thread_mod that takes sinks, except it can take a
+ * C++ string, and does not need to be provided the length of the string
  *
- * @param vec vec will contain both the index and the hash of minimizers.
- * All other things previously stated about vec remain true
+ * @param seq C++ string of DNA sequence to be hashed.
  */
-template <digest::BadCharPolicy P>
+template <digest::BadCharPolicy P, class Sink>
 void thread_mod(
-	unsigned thread_count,
-	std::vector<std::vector<std::pair<uint32_t, uint32_t>>> &vec,
-	const std::string &seq, unsigned k, uint32_t mod, uint32_t congruence = 0,
-	size_t start = 0,
+	unsigned thread_count, std::vector<Sink> &sinks, const std::string &seq,
+	unsigned k, uint32_t mod, uint32_t congruence = 0, size_t start = 0,
 	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
-	thread_mod<P>(thread_count, vec, seq.c_str(), seq.size(), k, mod,
+	thread_mod<P>(thread_count, sinks, seq.c_str(), seq.size(), k, mod,
 				  congruence, start, minimized_h);
 }
 
 /**
- * @tparam P policy for dealing with non-ACTG characters
- * @tparam T min query data structure to use, refer to docs of the classes in
- * the ds namespace for more info
- *
- * @param thread_count the number of threads to use
- * @param vec a vector of vectors in which the minimizers will be placed.
- *      Each vector corresponds to one thread. The minimizers within each vector
- *      will be in ascending order by index, and the vectors themselves will
- * also be in ascending order by index, i.e. all minimizers in vector_i will go
- *      before all minimizers in vector_(i+1).
- * @param seq char pointer poitning to the c-string of DNA sequence to be
- * hashed.
- * @param len length of seq.
- * @param k k-mer size.
- * @param large_wind_kmer_am
- * @param start 0-indexed position in seq to start hashing from.
- * @param minimized_h hash to be minimized, 0 for canoncial, 1 for forward, 2
- * for reverse
+ * @brief splits the large windows of seq[start, len) between thread_count
+ * threads, each running a D, and stores the minimizers of thread i in vec[i].
+ * Shared by thread_wind and thread_modmin, D is WindowMin or ModMinimizer.
  *
  * @throws BadThreadOutParams
  */
-template <digest::BadCharPolicy P, class T>
-void thread_wind(
-	unsigned thread_count, std::vector<std::vector<uint32_t>> &vec,
-	const char *seq, size_t len, unsigned k, uint32_t large_wind_kmer_am,
-	size_t start = 0,
-	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
-	int num_lwinds = (int)len - (int)start - (int)(k + large_wind_kmer_am) + 2;
-	if (large_wind_kmer_am == 0 || k < 4 || start >= len || num_lwinds < 0 ||
-		(unsigned)num_lwinds < thread_count) {
+template <class D, class V>
+void lwind_threads(unsigned thread_count, std::vector<std::vector<V>> &vec,
+				   const char *seq, size_t len, unsigned k,
+				   uint32_t large_wind_kmer_am, size_t start,
+				   digest::MinimizedHashType minimized_h) {
+	if (large_wind_kmer_am == 0 || k < 4) {
 		throw BadThreadOutParams();
 	}
-	unsigned lwinds_per_thread = num_lwinds / thread_count;
-	unsigned extras = num_lwinds % thread_count;
+	size_t num_lwinds = count_spans(
+		len, start, (size_t)k + large_wind_kmer_am - 1, thread_count);
+	size_t lwinds_per_thread = num_lwinds / thread_count;
+	size_t extras = num_lwinds % thread_count;
 	vec.reserve(thread_count);
-	std::vector<std::future<std::vector<uint32_t>>> thread_vector;
+	std::vector<std::future<std::vector<V>>> thread_vector;
 
 	size_t ind = start;
 	for (unsigned i = 0; i < thread_count; i++) {
 		// issue is here
 		// this will lead to a leak
-		unsigned assigned_lwind_am = lwinds_per_thread;
+		size_t assigned_lwind_am = lwinds_per_thread;
 		if (extras > 0) {
 			++(assigned_lwind_am);
 			extras--;
 		}
 
-		thread_vector.emplace_back(std::async(thread_wind_roll1<P, T>, seq, ind,
-											  k, large_wind_kmer_am,
-											  minimized_h, assigned_lwind_am));
+		thread_vector.emplace_back(
+			std::async(thread_wind_roll<D, V>, seq, ind, k,
+					   large_wind_kmer_am, minimized_h, assigned_lwind_am));
 
 		ind += assigned_lwind_am;
 	}
@@ -320,96 +373,96 @@ void thread_wind(
 	// of vec[i] to equal the first value of vec[i+1] due to the fact
 	// that thread_i+1 can't know the last minimizer of thread_i
 	for (unsigned i = 0; i < thread_count - 1; i++) {
-		int last = (int)vec[i].size() - 1;
-		if (vec[i][last] == vec[i + 1][0]) {
+		if (!vec[i].empty() && !vec[i + 1].empty() &&
+			vec[i].back() == vec[i + 1][0]) {
 			vec[i].pop_back();
 		}
 	}
 }
 
 /**
- * @brief same as the other thread_wind, except it can take a C++ string, and
- * does not need to be provided the length of the string
+ * @brief same as the other lwind_threads, except the minimizers of thread i
+ * are passed to sinks[i]
  *
- * @param seq C++ string of DNA sequence to be hashed.
- */
-template <digest::BadCharPolicy P, class T>
-void thread_wind(
-	unsigned thread_count, std::vector<std::vector<uint32_t>> &vec,
-	const std::string &seq, unsigned k, uint32_t large_wind_kmer_am,
-	size_t start = 0,
-	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
-	thread_wind<P, T>(thread_count, vec, seq.c_str(), seq.size(), k,
-					  large_wind_kmer_am, start, minimized_h);
-}
-
-/**
- * @brief same as other thread_wind that takes a c-string,
- * except here vec is a vector of vectors of pairs of uint32_ts
- *
- * @param vec vec will contain both the index and the hash of minimizers.
- * All other things previously stated about vec remain true
+ * @throws BadThreadOutParams
  */
-template <digest::BadCharPolicy P, class T>
-void thread_wind(
-	unsigned thread_count,
-	std::vector<std::vector<std::pair<uint32_t, uint32_t>>> &vec,
-	const char *seq, size_t len, unsigned k, uint32_t large_wind_kmer_am,
-	size_t start = 0,
-	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
-	int num_lwinds = (int)len - (int)start - (int)(k + large_wind_kmer_am) + 2;
-	if (large_wind_kmer_am == 0 || k < 4 || start >= len || num_lwinds < 0 ||
-		(unsigned)num_lwinds < thread_count) {
+template <class D, class Sink>
+void lwind_threads(unsigned thread_count, std::vector<Sink> &sinks,
+				   const char *seq, size_t len, unsigned k,
+				   uint32_t large_wind_kmer_am, size_t start,
+				   digest::MinimizedHashType minimized_h) {
+	if (large_wind_kmer_am == 0 || k < 4 || sinks.size() < thread_count) {
 		throw BadThreadOutParams();
 	}
-	unsigned lwinds_per_thread = num_lwinds / thread_count;
-	unsigned extras = num_lwinds % thread_count;
-	vec.reserve(thread_count);
-	std::vector<std::future<std::pair<uint32_t, uint32_t>>> thread_vector;
+	size_t num_lwinds = count_spans(
+		len, start, (size_t)k + large_wind_kmer_am - 1, thread_count);
+	size_t lwinds_per_thread = num_lwinds / thread_count;
+	size_t extras = num_lwinds % thread_count;
+	std::vector<std::future<void>> thread_vector;
 
 	size_t ind = start;
 	for (unsigned i = 0; i < thread_count; i++) {
-		// issue is here
-		// this will lead to a leak
-		unsigned assigned_lwind_am = lwinds_per_thread;
+		size_t assigned_lwind_am = lwinds_per_thread;
 		if (extras > 0) {
 			++(assigned_lwind_am);
 			extras--;
 		}
 
-		thread_vector.emplace_back(std::async(thread_wind_roll2<P, T>, seq, ind,
-											  k, large_wind_kmer_am,
-											  minimized_h, assigned_lwind_am));
+		thread_vector.emplace_back(std::async(
+			thread_wind_sink<D, Sink>, seq, ind, k, large_wind_kmer_am,
+			minimized_h, assigned_lwind_am, i == 0, &sinks[i]));
 
 		ind += assigned_lwind_am;
 	}
 	for (auto &t : thread_vector) {
-		vec.emplace_back(t.get());
+		t.get();
 	}
+}
 
-	// handle duplicates
-	// the only possible place for a duplicate is for the last element
-	// of vec[i] to equal the first value of vec[i+1] due to the fact
-	// that thread_i+1 can't know the last minimizer of thread_i
-	for (unsigned i = 0; i < thread_count - 1; i++) {
-		int last = (int)vec[i].size() - 1;
-		if (vec[i][last] == vec[i + 1][0]) {
-			vec[i].pop_back();
-		}
-	}
+/**
+ * @tparam P policy for dealing with non-ACTG characters
+ * @tparam T min query data structure to use, refer to docs of the classes in
+ * the ds namespace for more info
+ * @tparam V uint32_t or uint64_t for the positions of the minimizers, or
+ * std::pair<uint32_t, uint32_t> or std::pair<uint64_t, uint64_t> for their
+ * positions and hashes
+ *
+ * @param thread_count the number of threads to use
+ * @param vec a vector of vectors in which the minimizers will be placed.
+ *      Each vector corresponds to one thread. The minimizers within each vector
+ *      will be in ascending order by index, and the vectors themselves will
+ * also be in ascending order by index, i.e. all minimizers in vector_i will go
+ *      before all minimizers in vector_(i+1).
+ * @param seq char pointer poitning to the c-string of DNA sequence to be
+ * hashed.
+ * @param len length of seq.
+ * @param k k-mer size.
+ * @param large_wind_kmer_am
+ * @param start 0-indexed position in seq to start hashing from.
+ * @param minimized_h hash to be minimized, 0 for canoncial, 1 for forward, 2
+ * for reverse
+ *
+ * @throws BadThreadOutParams
+ */
+template <digest::BadCharPolicy P, class T, class V>
+void thread_wind(
+	unsigned thread_count, std::vector<std::vector<V>> &vec, const char *seq,
+	size_t len, unsigned k, uint32_t large_wind_kmer_am, size_t start = 0,
+	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
+	lwind_threads<digest::WindowMin<P, T>>(thread_count, vec, seq, len, k,
+										   large_wind_kmer_am, start,
+										   minimized_h);
 }
 
 /**
- * @brief same as other thread_wind that takes a C++ string,
- * except here vec is a vector of vectors of pairs of uint32_ts
+ * @brief same as the other thread_wind, except it can take a C++ string, and
+ * does not need to be provided the length of the string
  *
- * @param vec vec will contain both the index and the hash of minimizers.
- * All other things previously stated about vec remain true
+ * @param seq C++ string of DNA sequence to be hashed.
  */
-template <digest::BadCharPolicy P, class T>
+template <digest::BadCharPolicy P, class T, class V>
 void thread_wind(
-	unsigned thread_count,
-	std::vector<std::vector<std::pair<uint32_t, uint32_t>>> &vec,
+	unsigned thread_count, std::vector<std::vector<V>> &vec,
 	const std::string &seq, unsigned k, uint32_t large_wind_kmer_am,
 	size_t start = 0,
 	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
@@ -417,10 +470,127 @@ void thread_wind(
 					  large_wind_kmer_am, start, minimized_h);
 }
 
+/**
+ * @brief same as the other thread_wind functions, except the minimizers of
+ * thread i are passed to sinks[i] instead of being stored in a vector, see
+ * WindowMin::roll_minimizer(unsigned, Sink &&). Each sink is only used by its
+ * own thread, so it doesn't need to be thread safe, and it receives its
+ * minimizers in ascending order by index. All minimizers passed to sinks[i]
+ * go before all minimizers passed to sinks[i + 1], and as with the vectors, a
+ * minimizer is only passed once even if it is the minimizer of large windows
+ * handled by two threads. Every thread rolls to the end of its part of the
+ * sequence, so the return value of the sinks is ignored.
+ *
+ * @param sinks at least thread_count sinks
+ *
+ * @throws BadThreadOutParams
+ */
+template <digest::BadCharPolicy P, class T, class Sink>
+void thread_wind(
+	unsigned thread_count, std::vector<Sink> &sinks, const char *seq,
+	size_t len, unsigned k, uint32_t large_wind_kmer_am, size_t start = 0,
+	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
+	lwind_threads<digest::WindowMin<P, T>>(thread_count, sinks, seq, len, k,
+										   large_wind_kmer_am, start,
+										   minimized_h);
+}
+
+/**
+ * @brief same as the other thread_wind that takes sinks, except it can take a
+ * C++ string, and does not need to be provided the length of the string
+ *
+ * @param seq C++ string of DNA sequence to be hashed.
+ */
+template <digest::BadCharPolicy P, class T, class Sink>
+void thread_wind(
+	unsigned thread_count, std::vector<Sink> &sinks, const std::string &seq,
+	unsigned k, uint32_t large_wind_kmer_am, size_t start = 0,
+	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
+	thread_wind<P, T>(thread_count, sinks, seq.c_str(), seq.size(), k,
+					  large_wind_kmer_am, start, minimized_h);
+}
+
+/**
+ * @brief same as thread_wind, except the minimizers are mod-minimizers, see
+ * ModMinimizer. The large windows are split between the threads the same
+ * way, with the default r of ModMinimizer.
+ *
+ * @tparam P policy for dealing with non-ACTG characters
+ * @tparam T min query data structure to use for the t-mers, refer to docs of
+ * the classes in the ds namespace for more info
+ * @tparam V uint32_t or uint64_t for the positions of the minimizers, or
+ * std::pair<uint32_t, uint32_t> or std::pair<uint64_t, uint64_t> for their
+ * positions and hashes
+ *
+ * @throws BadThreadOutParams
+ */
+template <digest::BadCharPolicy P, class T, class V>
+void thread_modmin(
+	unsigned thread_count, std::vector<std::vector<V>> &vec, const char *seq,
+	size_t len, unsigned k, uint32_t large_wind_kmer_am, size_t start = 0,
+	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
+	lwind_threads<digest::ModMinimizer<P, T>>(thread_count, vec, seq, len, k,
+											  large_wind_kmer_am, start,
+											  minimized_h);
+}
+
+/**
+ * @brief same as the other thread_modmin, except it can take a C++ string,
+ * and does not need to be provided the length of the string
+ *
+ * @param seq C++ string of DNA sequence to be hashed.
+ */
+template <digest::BadCharPolicy P, class T, class V>
+void thread_modmin(
+	unsigned thread_count, std::vector<std::vector<V>> &vec,
+	const std::string &seq, unsigned k, uint32_t large_wind_kmer_am,
+	size_t start = 0,
+	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
+	thread_modmin<P, T>(thread_count, vec, seq.c_str(), seq.size(), k,
+						large_wind_kmer_am, start, minimized_h);
+}
+
+/**
+ * @brief same as the other thread_modmin functions, except the minimizers of
+ * thread i are passed to sinks[i] instead of being stored in a vector, like
+ * the thread_wind functions that take sinks
+ *
+ * @param sinks at least thread_count sinks
+ *
+ * @throws BadThreadOutParams
+ */
+template <digest::BadCharPolicy P, class T, class Sink>
+void thread_modmin(
+	unsigned thread_count, std::vector<Sink> &sinks, const char *seq,
+	size_t len, unsigned k, uint32_t large_wind_kmer_am, size_t start = 0,
+	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
+	lwind_threads<digest::ModMinimizer<P, T>>(thread_count, sinks, seq, len,
+											  k, large_wind_kmer_am, start,
+											  minimized_h);
+}
+
+/**
+ * @brief same as the other thread_modmin that takes sinks, except it can take
+ * a C++ string, and does not need to be provided the length of the string
+ *
+ * @param seq C++ string of DNA sequence to be hashed.
+ */
+template <digest::BadCharPolicy P, class T, class Sink>
+void thread_modmin(
+	unsigned thread_count, std::vector<Sink> &sinks, const std::string &seq,
+	unsigned k, uint32_t large_wind_kmer_am, size_t start = 0,
+	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
+	thread_modmin<P, T>(thread_count, sinks, seq.c_str(), seq.size(), k,
+						large_wind_kmer_am, start, minimized_h);
+}
+
 /**
  * @tparam P policy for dealing with non-ACTG characters
  * @tparam T min query data structure to use, refer to docs of the classes in
  * the ds namespace for more info
+ * @tparam V uint32_t or uint64_t for the positions of the syncmers, or
+ * std::pair<uint32_t, uint32_t> or std::pair<uint64_t, uint64_t> for their
+ * positions and hashes
  *
  * @param thread_count the number of threads to use
  * @param vec a vector of vectors in which the minimizers will be placed.
@@ -439,40 +609,38 @@ void thread_wind(
  *
  * @throws BadThreadOutParams
  */
-template <digest::BadCharPolicy P, class T>
+template <digest::BadCharPolicy P, class T, class V>
 void thread_sync(
-	unsigned thread_count, std::vector<std::vector<uint32_t>> &vec,
-	const char *seq, size_t len, unsigned k, uint32_t large_wind_kmer_am,
-	size_t start = 0,
+	unsigned thread_count, std::vector<std::vector<V>> &vec, const char *seq,
+	size_t len, unsigned k, uint32_t large_wind_kmer_am, size_t start = 0,
 	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
-	int num_lwinds = (int)len - (int)start - (int)(k + large_wind_kmer_am) + 2;
-	if (large_wind_kmer_am == 0 || k < 4 || start >= len || num_lwinds < 0 ||
-		(unsigned)num_lwinds < thread_count) {
+	if (large_wind_kmer_am == 0 || k < 4) {
 		throw BadThreadOutParams();
 	}
-	unsigned lwinds_per_thread = num_lwinds / thread_count;
-	unsigned extras = num_lwinds % thread_count;
+	size_t num_lwinds = count_spans(
+		len, start, (size_t)k + large_wind_kmer_am - 1, thread_count);
+	size_t lwinds_per_thread = num_lwinds / thread_count;
+	size_t extras = num_lwinds % thread_count;
 	vec.reserve(thread_count);
-	std::vector<std::future<std::vector<uint32_t>>> thread_vector;
+	std::vector<std::future<std::vector<V>>> thread_vector;
 
 	size_t ind = start;
 	for (unsigned i = 0; i < thread_count; i++) {
 		// issue is here
 		// this will lead to a leak
-		unsigned assigned_lwind_am = lwinds_per_thread;
+		size_t assigned_lwind_am = lwinds_per_thread;
 		if (extras > 0) {
 			++(assigned_lwind_am);
 			extras--;
 		}
 
-		thread_vector.emplace_back(std::async(thread_sync_roll1<P, T>, seq, ind,
-											  k, large_wind_kmer_am,
-											  minimized_h, assigned_lwind_am));
+		thread_vector.emplace_back(
+			std::async(thread_sync_roll<P, T, V>, seq, ind, k,
+					   large_wind_kmer_am, minimized_h, assigned_lwind_am));
 
 		ind += assigned_lwind_am;
 	}
 	for (auto &t : thread_vector) {
-
 		vec.emplace_back(t.get());
 	}
 }
@@ -483,9 +651,9 @@ void thread_sync(
  *
  * @param seq C++ string of DNA sequence to be hashed.
  */
-template <digest::BadCharPolicy P, class T>
+template <digest::BadCharPolicy P, class T, class V>
 void thread_sync(
-	unsigned thread_count, std::vector<std::vector<uint32_t>> &vec,
+	unsigned thread_count, std::vector<std::vector<V>> &vec,
 	const std::string &seq, unsigned k, uint32_t large_wind_kmer_am,
 	size_t start = 0,
 	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
@@ -494,69 +662,227 @@ void thread_sync(
 }
 
 /**
- * @brief same as other thread_wind that takes a c-string,
- * except here vec is a vector of vectors of pairs of uint32_ts
+ * @brief same as the other thread_sync functions, except the syncmers of
+ * thread i are passed to sinks[i] instead of being stored in a vector, see
+ * Syncmer::roll_minimizer(unsigned, Sink &&). Each sink is only used by its
+ * own thread, so it doesn't need to be thread safe, and it receives its
+ * syncmers in ascending order by index. All syncmers passed to sinks[i] go
+ * before all syncmers passed to sinks[i + 1]. Every thread rolls to the end
+ * of its part of the sequence, so the return value of the sinks is ignored.
  *
- * @param vec vec will contain both the index and the hash of minimizers.
- * All other things previously stated about vec remain true
+ * @param sinks at least thread_count sinks
+ *
+ * @throws BadThreadOutParams
  */
-template <digest::BadCharPolicy P, class T>
+template <digest::BadCharPolicy P, class T, class Sink>
 void thread_sync(
-	unsigned thread_count,
-	std::vector<std::vector<std::pair<uint32_t, uint32_t>>> &vec,
-	const char *seq, size_t len, unsigned k, uint32_t large_wind_kmer_am,
-	size_t start = 0,
+	unsigned thread_count, std::vector<Sink> &sinks, const char *seq,
+	size_t len, unsigned k, uint32_t large_wind_kmer_am, size_t start = 0,
 	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
-	int num_lwinds = (int)len - (int)start - (int)(k + large_wind_kmer_am) + 2;
-	if (large_wind_kmer_am == 0 || k < 4 || start >= len || num_lwinds < 0 ||
-		(unsigned)num_lwinds < thread_count) {
+	if (large_wind_kmer_am == 0 || k < 4 || sinks.size() < thread_count) {
 		throw BadThreadOutParams();
 	}
-	unsigned lwinds_per_thread = num_lwinds / thread_count;
-	unsigned extras = num_lwinds % thread_count;
-	vec.reserve(thread_count);
-	std::vector<std::future<std::vector<std::pair<uint32_t, uint32_t>>>>
-		thread_vector;
+	size_t num_lwinds = count_spans(
+		len, start, (size_t)k + large_wind_kmer_am - 1, thread_count);
+	size_t lwinds_per_thread = num_lwinds / thread_count;
+	size_t extras = num_lwinds % thread_count;
+	std::vector<std::future<void>> thread_vector;
 
 	size_t ind = start;
 	for (unsigned i = 0; i < thread_count; i++) {
-		// issue is here
-		// this will lead to a leak
-		unsigned assigned_lwind_am = lwinds_per_thread;
+		size_t assigned_lwind_am = lwinds_per_thread;
 		if (extras > 0) {
 			++(assigned_lwind_am);
 			extras--;
 		}
 
-		thread_vector.emplace_back(std::async(thread_sync_roll2<P, T>, seq, ind,
-											  k, large_wind_kmer_am,
-											  minimized_h, assigned_lwind_am));
+		thread_vector.emplace_back(std::async(
+			thread_sync_sink<P, T, Sink>, seq, ind, k, large_wind_kmer_am,
+			minimized_h, assigned_lwind_am, &sinks[i]));
 
 		ind += assigned_lwind_am;
 	}
 	for (auto &t : thread_vector) {
-		vec.emplace_back(t.get());
+		t.get();
 	}
 }
 
 /**
- * @brief same as other thread_sync that takes a C++ string,
- * except here vec is a vector of vectors of pairs of uint32_ts
+ * @brief same as the other thread_sync that takes sinks, except it can take a
+ * C++ string, and does not need to be provided the length of the string
  *
- * @param vec vec will contain both the index and the hash of minimizers.
- * All other things previously stated about vec remain true
+ * @param seq C++ string of DNA sequence to be hashed.
  */
-template <digest::BadCharPolicy P, class T>
+template <digest::BadCharPolicy P, class T, class Sink>
 void thread_sync(
-	unsigned thread_count,
-	std::vector<std::vector<std::pair<uint32_t, uint32_t>>> &vec,
-	const std::string &seq, unsigned k, uint32_t large_wind_kmer_am,
-	size_t start = 0,
+	unsigned thread_count, std::vector<Sink> &sinks, const std::string &seq,
+	unsigned k, uint32_t large_wind_kmer_am, size_t start = 0,
 	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
-	thread_sync<P, T>(thread_count, vec, seq.c_str(), seq.size(), k,
+	thread_sync<P, T>(thread_count, sinks, seq.c_str(), seq.size(), k,
 					  large_wind_kmer_am, start, minimized_h);
 }
 
+/**
+ * @brief splits the strobemers of seq[start, len) between thread_count
+ * threads, see Strobemer. A strobemer only depends on the k-mers it spans,
+ * so thread i digests the k-mers of its strobemers and the windows of the
+ * last one, and no strobemer is found by two threads.
+ *
+ * @tparam P policy for dealing with non-ACTG characters
+ * @tparam T min query data structure to use for the windows of minstrobes,
+ * refer to docs of the classes in the ds namespace for more info
+ * @tparam V uint32_t or uint64_t for the positions of the first strobes,
+ * std::pair<uint32_t, uint32_t> or std::pair<uint64_t, uint64_t> for those
+ * and the hashes of the strobemers, or Strobes for the positions of all
+ * strobes and the hashes
+ *
+ * @param thread_count the number of threads to use
+ * @param vec a vector of vectors in which the strobemers will be placed.
+ *      Each vector corresponds to one thread. The strobemers within each
+ * vector will be in ascending order by the index of their first strobe, and
+ * all strobemers in vector_i will go before all strobemers in vector_(i+1).
+ * @param seq char pointer poitning to the c-string of DNA sequence to be
+ * hashed.
+ * @param len length of seq.
+ * @param k k-mer size.
+ * @param order number of strobes, 2 or 3
+ * @param w_min
+ * @param w_max
+ * @param type minstrobes or randstrobes
+ * @param start 0-indexed position in seq to start hashing from.
+ * @param minimized_h hash to be minimized, 0 for canoncial, 1 for forward, 2
+ * for reverse
+ *
+ * @throws BadThreadOutParams
+ * @throws BadStrobeException thrown when order is not 2 or 3, or w_min is 0
+ * or greater than w_max
+ */
+template <digest::BadCharPolicy P, class T, class V>
+void thread_strobe(
+	unsigned thread_count, std::vector<std::vector<V>> &vec, const char *seq,
+	size_t len, unsigned k, unsigned order, unsigned w_min, unsigned w_max,
+	digest::StrobeType type = digest::StrobeType::RANDSTROBE,
+	size_t start = 0,
+	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
+	if (k < 4) {
+		throw BadThreadOutParams();
+	}
+	if ((order != 2 && order != 3) || w_min == 0 || w_min > w_max) {
+		throw digest::BadStrobeException();
+	}
+	size_t num_strobes = count_spans(
+		len, start, k + (size_t)(order - 1) * w_max, thread_count);
+	size_t strobes_per_thread = num_strobes / thread_count;
+	size_t extras = num_strobes % thread_count;
+	vec.reserve(thread_count);
+	std::vector<std::future<std::vector<V>>> thread_vector;
+
+	size_t ind = start;
+	for (unsigned i = 0; i < thread_count; i++) {
+		size_t assigned_strobe_am = strobes_per_thread;
+		if (extras > 0) {
+			++(assigned_strobe_am);
+			extras--;
+		}
+
+		thread_vector.emplace_back(std::async(
+			thread_strobe_roll<P, T, V>, seq, ind, k, order, w_min, w_max,
+			type, minimized_h, assigned_strobe_am));
+
+		ind += assigned_strobe_am;
+	}
+	for (auto &t : thread_vector) {
+		vec.emplace_back(t.get());
+	}
+}
+
+/**
+ * @brief same as the other thread_strobe, except it can take a C++ string,
+ * and does not need to be provided the length of the string
+ *
+ * @param seq C++ string of DNA sequence to be hashed.
+ */
+template <digest::BadCharPolicy P, class T, class V>
+void thread_strobe(
+	unsigned thread_count, std::vector<std::vector<V>> &vec,
+	const std::string &seq, unsigned k, unsigned order, unsigned w_min,
+	unsigned w_max, digest::StrobeType type = digest::StrobeType::RANDSTROBE,
+	size_t start = 0,
+	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
+	thread_strobe<P, T>(thread_count, vec, seq.c_str(), seq.size(), k, order,
+						w_min, w_max, type, start, minimized_h);
+}
+
+/**
+ * @brief same as the other thread_strobe functions, except the strobemers of
+ * thread i are passed to sinks[i] instead of being stored in a vector, see
+ * Strobemer::roll_minimizer(unsigned, Sink &&). Each sink is only used by its
+ * own thread, so it doesn't need to be thread safe, and it receives its
+ * strobemers in ascending order by the index of their first strobe. All
+ * strobemers passed to sinks[i] go before all strobemers passed to
+ * sinks[i + 1]. Every thread rolls to the end of its part of the sequence,
+ * so the return value of the sinks is ignored.
+ *
+ * @param sinks at least thread_count sinks
+ *
+ * @throws BadThreadOutParams
+ * @throws BadStrobeException
+ */
+template <digest::BadCharPolicy P, class T, class Sink>
+void thread_strobe(
+	unsigned thread_count, std::vector<Sink> &sinks, const char *seq,
+	size_t len, unsigned k, unsigned order, unsigned w_min, unsigned w_max,
+	digest::StrobeType type = digest::StrobeType::RANDSTROBE,
+	size_t start = 0,
+	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
+	if (k < 4 || sinks.size() < thread_count) {
+		throw BadThreadOutParams();
+	}
+	if ((order != 2 && order != 3) || w_min == 0 || w_min > w_max) {
+		throw digest::BadStrobeException();
+	}
+	size_t num_strobes = count_spans(
+		len, start, k + (size_t)(order - 1) * w_max, thread_count);
+	size_t strobes_per_thread = num_strobes / thread_count;
+	size_t extras = num_strobes % thread_count;
+	std::vector<std::future<void>> thread_vector;
+
+	size_t ind = start;
+	for (unsigned i = 0; i < thread_count; i++) {
+		size_t assigned_strobe_am = strobes_per_thread;
+		if (extras > 0) {
+			++(assigned_strobe_am);
+			extras--;
+		}
+
+		thread_vector.emplace_back(std::async(
+			thread_strobe_sink<P, T, Sink>, seq, ind, k, order, w_min, w_max,
+			type, minimized_h, assigned_strobe_am, &sinks[i]));
+
+		ind += assigned_strobe_am;
+	}
+	for (auto &t : thread_vector) {
+		t.get();
+	}
+}
+
+/**
+ * @brief same as the other thread_strobe that takes sinks, except it can take
+ * a C++ string, and does not need to be provided the length of the string
+ *
+ * @param seq C++ string of DNA sequence to be hashed.
+ */
+template <digest::BadCharPolicy P, class T, class Sink>
+void thread_strobe(
+	unsigned thread_count, std::vector<Sink> &sinks, const std::string &seq,
+	unsigned k, unsigned order, unsigned w_min, unsigned w_max,
+	digest::StrobeType type = digest::StrobeType::RANDSTROBE,
+	size_t start = 0,
+	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON) {
+	thread_strobe<P, T>(thread_count, sinks, seq.c_str(), seq.size(), k,
+						order, w_min, w_max, type, start, minimized_h);
+}
+
 } // namespace digest::thread_out
 
 #endif // THREAD_OUT_HPP
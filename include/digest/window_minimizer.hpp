@@ -3,8 +3,10 @@
 
 #include "data_structure.hpp"
 #include "digest/digester.hpp"
+#include "digest/order.hpp"
 #include <cstddef>
 #include <cstdint>
+#include <type_traits>
 
 namespace digest {
 
@@ -29,8 +31,13 @@ class BadWindowSizeException : public std::exception {
  * @tparam P
  * @tparam T The data structure to use for performing range minimum queries to
  * find the minimal hash value.
+ * @tparam K
+ * @tparam O The order of the k-mers, see the order namespace. With an order
+ * other than order::Hash, the data structure minimizes the keys of the order,
+ * and the hashes passed on with the minimizers are those keys.
  */
-template <BadCharPolicy P, class T> class WindowMin : public Digester<P> {
+template <BadCharPolicy P, class T, unsigned K = 0, class O = order::Hash>
+class WindowMin : public Digester<P, K> {
   public:
 	/**
 	 * @param seq
@@ -46,11 +53,12 @@ template <BadCharPolicy P, class T> class WindowMin : public Digester<P> {
 	WindowMin(const char *seq, size_t len, unsigned k, unsigned large_window,
 			  size_t start = 0,
 			  MinimizedHashType minimized_h = MinimizedHashType::CANON)
-		: Digester<P>(seq, len, k, start, minimized_h), ds(large_window),
+		: Digester<P, K>(seq, len, k, start, minimized_h), ds(large_window),
 		  large_window(large_window), ds_size(0), is_minimized(false) {
 		if (large_window == 0) {
 			throw BadWindowSizeException();
 		}
+		order.init(k, large_window);
 	}
 
 	/**
@@ -66,8 +74,32 @@ template <BadCharPolicy P, class T> class WindowMin : public Digester<P> {
 	WindowMin(const std::string &seq, unsigned k, unsigned large_window,
 			  size_t start = 0,
 			  MinimizedHashType minimized_h = MinimizedHashType::CANON)
-		: WindowMin<P, T>(seq.c_str(), seq.size(), k, large_window, start,
-						  minimized_h) {}
+		: WindowMin<P, T, K, O>(seq.c_str(), seq.size(), k, large_window,
+								start, minimized_h) {}
+
+	/**
+	 * @param packed
+	 * @param len
+	 * @param n_intervals
+	 * @param k
+	 * @param large_window the number of kmers in the large window, i.e. the
+	 * number of kmers to be considered during the range minimum query.
+	 * @param start
+	 * @param minimized_h
+	 *
+	 * @throws BadWindowException thrown when large_window is passed in as 0
+	 */
+	WindowMin(const uint8_t *packed, size_t len, const NIntervals &n_intervals,
+			  unsigned k, unsigned large_window, size_t start = 0,
+			  MinimizedHashType minimized_h = MinimizedHashType::CANON)
+		: Digester<P, K>(packed, len, n_intervals, k, start, minimized_h),
+		  ds(large_window), large_window(large_window), ds_size(0),
+		  is_minimized(false) {
+		if (large_window == 0) {
+			throw BadWindowSizeException();
+		}
+		order.init(k, large_window);
+	}
 
 	/**
 	 * @brief adds up to amount of positions of minimizers into vec. Here a
@@ -78,25 +110,8 @@ template <BadCharPolicy P, class T> class WindowMin : public Digester<P> {
 	 * @param vec
 	 */
 	void roll_minimizer(unsigned amount, std::vector<uint32_t> &vec) override {
-		amount += vec.size();
-
-		while (ds_size + 1 < large_window and this->is_valid_hash) {
-			if (this->get_minimized_h() == digest::MinimizedHashType::CANON) {
-				ds.insert(this->get_pos(), this->chash);
-			} else if (this->get_minimized_h() ==
-					   digest::MinimizedHashType::FORWARD) {
-				ds.insert(this->get_pos(), this->fhash);
-			} else {
-				ds.insert(this->get_pos(), this->rhash);
-			}
-
-			this->roll_one();
-			ds_size++;
-		}
-
-		while (this->is_valid_hash and vec.size() < amount) {
-			roll_ds_wind(vec);
-		}
+		auto sink = [&vec](uint32_t pos) { vec.emplace_back(pos); };
+		roll_wind(amount, sink);
 	}
 
 	/**
@@ -110,35 +125,124 @@ template <BadCharPolicy P, class T> class WindowMin : public Digester<P> {
 	void
 	roll_minimizer(unsigned amount,
 				   std::vector<std::pair<uint32_t, uint32_t>> &vec) override {
-		amount += vec.size();
+		auto sink = [&vec](uint32_t pos, uint32_t hash) {
+			vec.emplace_back(pos, hash);
+		};
+		roll_wind(amount, sink);
+	}
 
-		while (ds_size + 1 < large_window and this->is_valid_hash) {
-			if (this->get_minimized_h() == digest::MinimizedHashType::CANON) {
-				ds.insert(this->get_pos(), this->chash);
-			} else if (this->get_minimized_h() ==
-					   digest::MinimizedHashType::FORWARD) {
-				ds.insert(this->get_pos(), this->fhash);
-			} else {
-				ds.insert(this->get_pos(), this->rhash);
-			}
+	/**
+	 * @brief adds up to amount of positions of minimizers into vec, without
+	 * truncating them to 32 bits. Here a k-mer is considered a minimizer if
+	 * its hash is the smallest in the large window. Rightmost index wins in
+	 * ties
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void roll_minimizer(unsigned amount, std::vector<uint64_t> &vec) override {
+		auto sink = [&vec](uint64_t pos) { vec.emplace_back(pos); };
+		roll_wind(amount, sink);
+	}
 
-			this->roll_one();
-			ds_size++;
-		}
+	/**
+	 * @brief adds up to amount of positions and hashes of minimizers into vec,
+	 * without truncating the positions to 32 bits. The hashes are only 64
+	 * bits wide if the data structure compares 64-bit hashes, e.g.
+	 * ds::Adaptive64. Here a k-mer is considered a minimizer if its hash is
+	 * the smallest in the large window. Rightmost index wins in ties
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void
+	roll_minimizer(unsigned amount,
+				   std::vector<std::pair<uint64_t, uint64_t>> &vec) override {
+		auto sink = [&vec](uint64_t pos, uint64_t hash) {
+			vec.emplace_back(pos, hash);
+		};
+		roll_wind(amount, sink);
+	}
 
-		while (this->is_valid_hash and vec.size() < amount) {
-			roll_ds_wind(vec);
-		}
+	/**
+	 * @brief passes up to amount minimizers, the same ones the other
+	 * roll_minimizer functions would add to a vector, to sink, so they can go
+	 * straight into an index or a stream without being stored first. sink is
+	 * called as sink(position) if it accepts that, and as sink(position, hash)
+	 * otherwise. The position is a size_t, and the hash is the hash the data
+	 * structure compares, 32 or 64 bits wide. If it returns bool, returning
+	 * false stops rolling after that minimizer, e.g. when a fixed size buffer
+	 * is full, and the next call continues from there.
+	 *
+	 * @param amount
+	 * @param sink
+	 *
+	 * @return size_t, the number of minimizers passed to sink
+	 */
+	template <class Sink> size_t roll_minimizer(unsigned amount, Sink &&sink) {
+		return roll_wind(amount, sink);
+	}
+
+	/**
+	 * @brief applies the selection of roll_minimizer() to hashes and positions
+	 * that were already produced by roll_hashes() or roll_hashes_lanes(), and
+	 * adds the positions of the minimizers into vec. The large window carries
+	 * over between calls, so feeding consecutive blocks gives the same result
+	 * as a single roll_minimizer() call over them. The block goes to the data
+	 * structure at once through its insert_many(). Only for order::Hash, since
+	 * the other orders need the characters of the k-mers.
+	 *
+	 * @param hashes
+	 * @param positions
+	 * @param n number of k-mers in hashes and positions
+	 * @param vec
+	 */
+	void select_minimizers(const uint64_t *hashes, const uint32_t *positions,
+						   size_t n, std::vector<uint32_t> &vec) {
+		static_assert(std::is_same_v<O, order::Hash>,
+					  "select_minimizers only orders k-mers by hash");
+		select_block(hashes, positions, n, [&vec](uint64_t index, uint64_t) {
+			vec.emplace_back(index);
+		});
+	}
+
+	/**
+	 * @brief same as the other select_minimizers, except the hashes of the
+	 * minimizers are added as well
+	 *
+	 * @param hashes
+	 * @param positions
+	 * @param n
+	 * @param vec
+	 */
+	void select_minimizers(const uint64_t *hashes, const uint32_t *positions,
+						   size_t n,
+						   std::vector<std::pair<uint32_t, uint32_t>> &vec) {
+		static_assert(std::is_same_v<O, order::Hash>,
+					  "select_minimizers only orders k-mers by hash");
+		select_block(hashes, positions, n,
+					 [&vec](uint64_t index, uint64_t hash) {
+						 vec.emplace_back(index, hash);
+					 });
 	}
 
 	void new_seq(const char *seq, size_t len, size_t start) override {
 		ds = T(large_window);
-		Digester<P>::new_seq(seq, len, start);
+		order.reset();
+		Digester<P, K>::new_seq(seq, len, start);
 	}
 
 	void new_seq(const std::string &seq, size_t pos) override {
 		ds = T(large_window);
-		Digester<P>::new_seq(seq.c_str(), seq.size(), pos);
+		order.reset();
+		Digester<P, K>::new_seq(seq.c_str(), seq.size(), pos);
+	}
+
+	void new_seq(const uint8_t *packed, size_t len,
+				 const NIntervals &n_intervals, size_t start) override {
+		ds = T(large_window);
+		order.reset();
+		Digester<P, K>::new_seq(packed, len, n_intervals, start);
 	}
 
 	/**
@@ -180,85 +284,131 @@ template <BadCharPolicy P, class T> class WindowMin : public Digester<P> {
 	// already in there
 	bool is_minimized;
 
+	// order of the k-mers
+	O order;
+
 	// the index of previous minimizer, a minimizer is only a new minimizer if
-	// it is different from the previous minimizer
-	uint32_t prev_mini;
+	// it is different from the previous minimizer. It is the index as stored
+	// by the data structure, so it may only hold the lower 32 bits
+	uint64_t prev_mini;
 
-  private:
 	/**
-	 * @brief helper function which handles adding the next hash into the data
-	 * structure
+	 * @brief restores the bits of an index from the data structure that were
+	 * cut off when it was stored as 32 bits. The index is in the current
+	 * large window, which ends at get_pos(), so it is get_pos() minus their
+	 * distance, and the distance is less than 2^32.
+	 *
+	 * @param index
 	 *
+	 * @return size_t, the full position
 	 */
-	void roll_ds_wind(std::vector<uint32_t> &vec) {
-		if (this->get_minimized_h() == digest::MinimizedHashType::CANON) {
-			ds.insert(this->get_pos(), this->chash);
-		} else if (this->get_minimized_h() ==
-				   digest::MinimizedHashType::FORWARD) {
-			ds.insert(this->get_pos(), this->fhash);
-		} else {
-			ds.insert(this->get_pos(), this->rhash);
-		}
-		check(vec);
+	size_t widen(uint64_t index) {
+		size_t pos = this->get_pos();
+		return pos - (uint32_t)((uint32_t)pos - (uint32_t)index);
+	}
 
-		this->roll_one();
+	/**
+	 * @brief the value of the current k-mer that the data structure minimizes,
+	 * its hash with order::Hash
+	 *
+	 * @tparam H the hash type, fixed at compile time
+	 *
+	 * @return uint64_t
+	 */
+	template <MinimizedHashType H> uint64_t key() {
+		return order.template key<H>(*this, this->get_pos(),
+									 this->template selected_hash<H>());
 	}
 
 	/**
-	 * @brief helper function which handles adding the next hash into the data
-	 * structure
+	 * @brief inserts hashes into the data structure until it is one short of
+	 * a full large window
 	 *
+	 * @tparam H the hash type to insert, fixed at compile time
 	 */
-	void roll_ds_wind(std::vector<std::pair<uint32_t, uint32_t>> &vec) {
-		if (this->get_minimized_h() == digest::MinimizedHashType::CANON) {
-			ds.insert(this->get_pos(), this->chash);
-		} else if (this->get_minimized_h() ==
-				   digest::MinimizedHashType::FORWARD) {
-			ds.insert(this->get_pos(), this->fhash);
-		} else {
-			ds.insert(this->get_pos(), this->rhash);
-		}
-		check(vec);
+	template <MinimizedHashType H> void fill_window() {
+		while (ds_size + 1 < large_window and this->is_valid_hash) {
+			ds.insert(this->get_pos(), key<H>());
 
-		this->roll_one();
+			this->roll_one();
+			ds_size++;
+		}
 	}
 
+  private:
 	/**
-	 * @brief helper function that checks to see if the current minimizer is a
-	 * new minimizer, and should thus be added to the vec
+	 * @brief picks the hash type once, so the loops in roll_wind_impl() don't
+	 * have to check it for every k-mer
 	 *
-	 * @param vec
+	 * @param amount
+	 * @param sink
+	 *
+	 * @return size_t, the number of minimizers passed to sink
 	 */
-	void check(std::vector<uint32_t> &vec) {
-		if (is_minimized) {
-			if (ds.min() != prev_mini) {
+	template <class Sink> size_t roll_wind(unsigned amount, Sink &sink) {
+		switch (this->get_minimized_h()) {
+		case MinimizedHashType::FORWARD:
+			return roll_wind_impl<MinimizedHashType::FORWARD>(amount, sink);
+		case MinimizedHashType::REVERSE:
+			return roll_wind_impl<MinimizedHashType::REVERSE>(amount, sink);
+		default:
+			return roll_wind_impl<MinimizedHashType::CANON>(amount, sink);
+		}
+	}
+
+	template <MinimizedHashType H, class Sink>
+	size_t roll_wind_impl(unsigned amount, Sink &sink) {
+		this->template fill_window<H>();
+
+		size_t n = 0;
+		bool more = true;
+		while (this->is_valid_hash and n < amount and more) {
+			ds.insert(this->get_pos(), key<H>());
+			// a minimizer is only a new minimizer if it is different from the
+			// previous one
+			if (!is_minimized or ds.min() != prev_mini) {
+				is_minimized = true;
 				prev_mini = ds.min();
-				vec.emplace_back(prev_mini);
+				n++;
+				more = this->emit(sink, widen(prev_mini),
+								  [this] { return ds.min_hash(); });
 			}
-		} else {
-			is_minimized = true;
-			prev_mini = ds.min();
-			vec.emplace_back(prev_mini);
+
+			this->roll_one();
 		}
+		return n;
 	}
 
 	/**
-	 * @brief helper function that checks to see if the current minimizer is a
-	 * new minimizer, and should thus be added to the vec
+	 * @brief helper function for select_minimizers(), passes the index and the
+	 * hash of every new minimizer to found
 	 *
-	 * @param vec
+	 * @param hashes
+	 * @param positions
+	 * @param n
+	 * @param found
 	 */
-	void check(std::vector<std::pair<uint32_t, uint32_t>> &vec) {
-		if (is_minimized) {
-			if (ds.min() != prev_mini) {
-				prev_mini = ds.min();
-				vec.emplace_back(prev_mini, ds.min_hash());
-			}
-		} else {
+	template <class Found>
+	void select_block(const uint64_t *hashes, const uint32_t *positions,
+					  size_t n, Found &&found) {
+		size_t i = 0;
+		for (; i < n && ds_size + 1 < large_window; i++) {
+			ds.insert(positions[i], hashes[i]);
+			ds_size++;
+		}
+		if (i < n && !is_minimized) {
+			ds.insert(positions[i], hashes[i]);
 			is_minimized = true;
 			prev_mini = ds.min();
-			vec.emplace_back(prev_mini, ds.min_hash());
+			found(prev_mini, ds.min_hash());
+			i++;
 		}
+		// the minimum of every window from here on is only new if it changed
+		ds.insert_many(positions + i, hashes + i, n - i,
+					   [&](size_t, auto index, auto hash) {
+						   prev_mini = index;
+						   found(index, hash);
+					   });
 	}
 };
 
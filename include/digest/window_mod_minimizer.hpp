@@ -0,0 +1,345 @@
+#ifndef WINDOW_MOD_MINIMIZER_HPP
+#define WINDOW_MOD_MINIMIZER_HPP
+
+#include "digest/data_structure.hpp"
+#include "digest/digester.hpp"
+#include "digest/window_minimizer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace digest {
+
+/**
+ * @brief Child class of Digester that finds mod-minimizers (Groot Koerkamp and
+ * Pibiri 2024). Like WindowMin, every large window of large_window k-mers
+ * picks one of its k-mers, but instead of the k-mer with the smallest hash,
+ * it finds the t-mer with the smallest hash in the window, t = r + ((k - r)
+ * mod large_window), and picks the k-mer whose position is the position of
+ * that t-mer mod large_window. Consecutive windows pick the same k-mer more
+ * often than with WindowMin, so the density approaches 1 / large_window for
+ * large k, where WindowMin stays near 2 / (large_window + 1). Unlike ModMin,
+ * which samples k-mers whose hash is congruent to a value, every large window
+ * still contains a minimizer. Parameters without a description are the same
+ * as the parameters in the Digester parent class. They are simply passed up
+ * to the parent constructor.
+ *
+ * The t-mers are hashed by a second digester rolling alongside the k-mers,
+ * with the same BadCharPolicy and hash type, and their minimum over the large
+ * window is found with T. The position of the t-mer is what matters, so a
+ * large window only picks a k-mer if its k-mers are consecutive in the
+ * sequence. With BadCharPolicy::SKIPOVER, large windows that contain a
+ * non-ACTG character have no minimizer, unlike with WindowMin.
+ *
+ * @tparam P
+ * @tparam T The data structure to use for finding the minimal t-mer, over a
+ * window of large_window + k - t t-mers
+ * @tparam K
+ */
+template <BadCharPolicy P, class T, unsigned K = 0>
+class ModMinimizer : public Digester<P, K> {
+  public:
+	/**
+	 * @param seq
+	 * @param len
+	 * @param k
+	 * @param large_window the number of kmers in the large window, i.e. the
+	 * number of kmers one minimizer is picked from.
+	 * @param start
+	 * @param minimized_h
+	 * @param r the smallest length of the t-mers, t is k if k is less than r
+	 *
+	 * @throws BadWindowException thrown when large_window is passed in as 0
+	 * @throws BadConstructionException thrown when t is less than 4
+	 */
+	ModMinimizer(const char *seq, size_t len, unsigned k,
+				 unsigned large_window, size_t start = 0,
+				 MinimizedHashType minimized_h = MinimizedHashType::CANON,
+				 unsigned r = 4)
+		: Digester<P, K>(seq, len, k, start, minimized_h),
+		  large_window(large_window), t(tmer_len(k, large_window, r)),
+		  tmers(seq, len, t, start, minimized_h), ds(window()) {
+		init();
+	}
+
+	/**
+	 * @param seq
+	 * @param k
+	 * @param large_window the number of kmers in the large window, i.e. the
+	 * number of kmers one minimizer is picked from.
+	 * @param start
+	 * @param minimized_h
+	 * @param r the smallest length of the t-mers, t is k if k is less than r
+	 *
+	 * @throws BadWindowException thrown when large_window is passed in as 0
+	 * @throws BadConstructionException thrown when t is less than 4
+	 */
+	ModMinimizer(const std::string &seq, unsigned k, unsigned large_window,
+				 size_t start = 0,
+				 MinimizedHashType minimized_h = MinimizedHashType::CANON,
+				 unsigned r = 4)
+		: ModMinimizer<P, T, K>(seq.c_str(), seq.size(), k, large_window,
+								start, minimized_h, r) {}
+
+	/**
+	 * @param packed
+	 * @param len
+	 * @param n_intervals
+	 * @param k
+	 * @param large_window the number of kmers in the large window, i.e. the
+	 * number of kmers one minimizer is picked from.
+	 * @param start
+	 * @param minimized_h
+	 * @param r the smallest length of the t-mers, t is k if k is less than r
+	 *
+	 * @throws BadWindowException thrown when large_window is passed in as 0
+	 * @throws BadConstructionException thrown when t is less than 4
+	 */
+	ModMinimizer(const uint8_t *packed, size_t len,
+				 const NIntervals &n_intervals, unsigned k,
+				 unsigned large_window, size_t start = 0,
+				 MinimizedHashType minimized_h = MinimizedHashType::CANON,
+				 unsigned r = 4)
+		: Digester<P, K>(packed, len, n_intervals, k, start, minimized_h),
+		  large_window(large_window), t(tmer_len(k, large_window, r)),
+		  tmers(packed, len, n_intervals, t, start, minimized_h),
+		  ds(window()) {
+		init();
+	}
+
+	/**
+	 * @brief adds up to amount of positions of minimizers into vec. Here a
+	 * k-mer is considered a minimizer if its position is the position of the
+	 * minimal t-mer of the large window mod large_window. Rightmost t-mer
+	 * wins in ties
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void roll_minimizer(unsigned amount, std::vector<uint32_t> &vec) override {
+		roll_minimizer(amount, [&vec](uint32_t pos) { vec.emplace_back(pos); });
+	}
+
+	/**
+	 * @brief adds up to amount of positions and hashes of minimizers into vec.
+	 * The hashes are the hashes of the k-mers, not of the t-mers. Here a k-mer
+	 * is considered a minimizer if its position is the position of the
+	 * minimal t-mer of the large window mod large_window. Rightmost t-mer
+	 * wins in ties
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void
+	roll_minimizer(unsigned amount,
+				   std::vector<std::pair<uint32_t, uint32_t>> &vec) override {
+		roll_minimizer(amount, [&vec](uint32_t pos, uint32_t hash) {
+			vec.emplace_back(pos, hash);
+		});
+	}
+
+	/**
+	 * @brief adds up to amount of positions of minimizers into vec, without
+	 * truncating them to 32 bits. Here a k-mer is considered a minimizer if
+	 * its position is the position of the minimal t-mer of the large window
+	 * mod large_window. Rightmost t-mer wins in ties
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void roll_minimizer(unsigned amount, std::vector<uint64_t> &vec) override {
+		roll_minimizer(amount, [&vec](uint64_t pos) { vec.emplace_back(pos); });
+	}
+
+	/**
+	 * @brief adds up to amount of positions and hashes of minimizers into vec,
+	 * without truncating them to 32 bits. The hashes are the full 64-bit
+	 * hashes of the k-mers. Here a k-mer is considered a minimizer if its
+	 * position is the position of the minimal t-mer of the large window mod
+	 * large_window. Rightmost t-mer wins in ties
+	 *
+	 * @param amount
+	 * @param vec
+	 */
+	void
+	roll_minimizer(unsigned amount,
+				   std::vector<std::pair<uint64_t, uint64_t>> &vec) override {
+		roll_minimizer(amount, [&vec](uint64_t pos, uint64_t hash) {
+			vec.emplace_back(pos, hash);
+		});
+	}
+
+	/**
+	 * @brief passes up to amount minimizers, the same ones the other
+	 * roll_minimizer functions would add to a vector, to sink, so they can go
+	 * straight into an index or a stream without being stored first. sink is
+	 * called as sink(position) if it accepts that, and as sink(position, hash)
+	 * otherwise. The position is a size_t, and the hash is the 64-bit hash of
+	 * the k-mer. If it returns bool, returning false stops rolling after that
+	 * minimizer, e.g. when a fixed size buffer is full, and the next call
+	 * continues from there.
+	 *
+	 * @param amount
+	 * @param sink
+	 *
+	 * @return size_t, the number of minimizers passed to sink
+	 */
+	template <class Sink> size_t roll_minimizer(unsigned amount, Sink &&sink) {
+		switch (this->get_minimized_h()) {
+		case MinimizedHashType::FORWARD:
+			return roll_mod<MinimizedHashType::FORWARD>(amount, sink);
+		case MinimizedHashType::REVERSE:
+			return roll_mod<MinimizedHashType::REVERSE>(amount, sink);
+		default:
+			return roll_mod<MinimizedHashType::CANON>(amount, sink);
+		}
+	}
+
+	void new_seq(const char *seq, size_t len, size_t start) override {
+		reset();
+		tmers.new_seq(seq, len, start);
+		Digester<P, K>::new_seq(seq, len, start);
+	}
+
+	void new_seq(const std::string &seq, size_t pos) override {
+		new_seq(seq.c_str(), seq.size(), pos);
+	}
+
+	void new_seq(const uint8_t *packed, size_t len,
+				 const NIntervals &n_intervals, size_t start) override {
+		reset();
+		tmers.new_seq(packed, len, n_intervals, start);
+		Digester<P, K>::new_seq(packed, len, n_intervals, start);
+	}
+
+	/**
+	 * @brief same as Digester::append_seq(), the t-mers are appended to as
+	 * well. These are not virtual, so call them on the ModMinimizer rather
+	 * than through the Digester base class.
+	 *
+	 * @param seq
+	 * @param len
+	 *
+	 * @throws NotRolledTillEndException Thrown when the internal iterator is
+	 * not at the end of the current sequence
+	 */
+	void append_seq(const char *seq, size_t len) {
+		Digester<P, K>::append_seq(seq, len);
+		tmers.insert_rest(ds);
+		tmers.append_seq(seq, len);
+	}
+
+	/**
+	 * @brief same as the other append_seq
+	 *
+	 * @param seq
+	 *
+	 * @throws NotRolledTillEndException Thrown when the internal iterator is
+	 * not at the end of the current sequence
+	 */
+	void append_seq(const std::string &seq) {
+		append_seq(seq.c_str(), seq.size());
+	}
+
+	/**
+	 * @brief same as the other append_seq, for a 2-bit packed sequence
+	 *
+	 * @param packed
+	 * @param len
+	 * @param n_intervals
+	 *
+	 * @throws NotRolledTillEndException Thrown when the internal iterator is
+	 * not at the end of the current sequence
+	 */
+	void append_seq(const uint8_t *packed, size_t len,
+					const NIntervals &n_intervals) {
+		Digester<P, K>::append_seq(packed, len, n_intervals);
+		tmers.insert_rest(ds);
+		tmers.append_seq(packed, len, n_intervals);
+	}
+
+	/**
+	 *
+	 * @return unsigned, the value of large_window
+	 */
+	unsigned get_large_wind_kmer_am() { return large_window; }
+
+	/**
+	 *
+	 * @return unsigned, the length of the t-mers
+	 */
+	unsigned get_t() { return t; }
+
+  private:
+	uint32_t large_window;
+	unsigned t;
+	SubHasher<P> tmers;
+
+	// minimum of the t-mers of the current large window
+	T ds;
+
+	// hashes of the last large_window k-mers, the current one at head
+	std::vector<uint64_t> hashes;
+	size_t head = 0;
+
+	// whether a minimizer was found yet, and the position of the last one
+	bool is_minimized = false;
+	size_t prev_mini = 0;
+
+	static unsigned tmer_len(unsigned k, unsigned large_window, unsigned r) {
+		if (large_window == 0) {
+			throw BadWindowSizeException();
+		}
+		return k < r ? k : r + (k - r) % large_window;
+	}
+
+	uint32_t window() { return large_window + this->k - t; }
+
+	void init() {
+		hashes.resize(large_window);
+		reset();
+	}
+
+	void reset() {
+		ds = T(window());
+		head = 0;
+		is_minimized = false;
+	}
+
+	template <MinimizedHashType H, class Sink>
+	size_t roll_mod(unsigned amount, Sink &sink) {
+		size_t n = 0;
+		bool more = true;
+		while (this->is_valid_hash and n < amount and more) {
+			size_t pos = this->get_pos();
+			head = head + 1 == large_window ? 0 : head + 1;
+			hashes[head] = this->template selected_hash<H>();
+			tmers.template insert_until<H>(ds, pos + this->k - t);
+
+			// the large window ending at pos, if its t-mers are consecutive,
+			// ds holds all of them and nothing else
+			if (tmers.get_run() >= window()) {
+				size_t first = pos + 1 - large_window;
+				uint32_t j =
+					((uint32_t)ds.min() - (uint32_t)first) % large_window;
+				if (!is_minimized or first + j != prev_mini) {
+					is_minimized = true;
+					prev_mini = first + j;
+					n++;
+					size_t back = large_window - 1 - j;
+					size_t slot = head >= back ? head - back
+											   : head + large_window - back;
+					more = this->emit(sink, prev_mini,
+									  [this, slot] { return hashes[slot]; });
+				}
+			}
+
+			this->roll_one();
+		}
+		return n;
+	}
+};
+
+} // namespace digest
+
+#endif // WINDOW_MOD_MINIMIZER_HPP
@@ -1,20 +1,25 @@
+#include <digest/factory.hpp>
 #include <digest/mod_minimizer.hpp>
-#include <digest/syncmer.hpp>
-#include <digest/window_minimizer.hpp>
 #include <variant>
 
+// largest large window with its own digester in the factory tables, larger
+// ones use ds::Adaptive. Every entry is compiled into the module, and the
+// gains over ds::Adaptive are largest for windows up to 16.
+constexpr unsigned FACTORY_MAX_WINDOW = 16;
+
 std::variant<std::vector<uint32_t>, std::vector<std::pair<uint32_t, uint32_t>>>
 window_minimizer(const std::string &seq, unsigned k, unsigned large_window,
 				 bool include_hash = false) {
-	digest::WindowMin<digest::BadCharPolicy::SKIPOVER, digest::ds::Adaptive>
-		digester(seq, k, large_window);
+	auto digester =
+		digest::factory::window_min<digest::BadCharPolicy::SKIPOVER, 0,
+									FACTORY_MAX_WINDOW>(seq, k, large_window);
 	if (include_hash) {
 		std::vector<std::pair<uint32_t, uint32_t>> output;
-		digester.roll_minimizer(seq.length(), output);
+		digester->roll_minimizer(seq.length(), output);
 		return output;
 	} else {
 		std::vector<uint32_t> output;
-		digester.roll_minimizer(seq.length(), output);
+		digester->roll_minimizer(seq.length(), output);
 		return output;
 	}
 }
@@ -38,15 +43,16 @@ modimizer(const std::string &seq, unsigned k, uint32_t mod,
 std::variant<std::vector<uint32_t>, std::vector<std::pair<uint32_t, uint32_t>>>
 syncmer(const std::string &seq, unsigned k, unsigned large_window,
 		bool include_hash = false) {
-	digest::Syncmer<digest::BadCharPolicy::WRITEOVER, digest::ds::Adaptive>
-		digester(seq, k, large_window);
+	auto digester =
+		digest::factory::syncmer<digest::BadCharPolicy::WRITEOVER, 0,
+								 FACTORY_MAX_WINDOW>(seq, k, large_window);
 	if (include_hash) {
 		std::vector<std::pair<uint32_t, uint32_t>> output;
-		digester.roll_minimizer(seq.length(), output);
+		digester->roll_minimizer(seq.length(), output);
 		return output;
 	} else {
 		std::vector<uint32_t> output;
-		digester.roll_minimizer(seq.length(), output);
+		digester->roll_minimizer(seq.length(), output);
 		return output;
 	}
 }
\ No newline at end of file
@@ -2,13 +2,22 @@
 // perf record --call-graph dwarf bench
 // perf report -g
 
+#include <array>
 #include <benchmark/benchmark.h>
 #include <cstdint>
+#include <digest/block_minimizer.hpp>
 #include <digest/data_structure.hpp>
+#include <digest/factory.hpp>
 #include <digest/mod_minimizer.hpp>
+#include <digest/multi_lane.hpp>
+#include <digest/order.hpp>
+#include <digest/packed_seq.hpp>
+#include <digest/smer_syncmer.hpp>
+#include <digest/strobemer.hpp>
 #include <digest/syncmer.hpp>
 #include <digest/thread_out.hpp>
 #include <digest/window_minimizer.hpp>
+#include <digest/window_mod_minimizer.hpp>
 #include <fstream>
 #include <nthash/nthash.hpp>
 
@@ -54,6 +63,47 @@ BENCHMARK(BM_NtHashRoll)
 	->Args({31})
 	->Iterations(16); // kraken v1
 
+// per k-mer path: roll_one() followed by a getter
+static void BM_RollOne(benchmark::State &state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		digest::ModMin<digest::BadCharPolicy::SKIPOVER> dig(s, state.range(0),
+															17);
+		state.ResumeTiming();
+		do {
+			benchmark::DoNotOptimize(dig.get_chash());
+		} while (dig.roll_one());
+	}
+}
+BENCHMARK(BM_RollOne)
+	->Args({4})	 // spumoni2
+	->Args({15}) // minimap
+	->Args({31})
+	->Iterations(16); // kraken v1
+
+// bulk path: roll_hashes() into a caller owned buffer
+static void BM_RollHashes(benchmark::State &state) {
+	const size_t block = 4096;
+	std::vector<uint64_t> hashes(block);
+	std::vector<uint32_t> positions(block);
+	for (auto _ : state) {
+		state.PauseTiming();
+		digest::ModMin<digest::BadCharPolicy::SKIPOVER> dig(s, state.range(0),
+															17);
+		state.ResumeTiming();
+		while (dig.roll_hashes(block, hashes.data(), positions.data()) ==
+			   block) {
+			benchmark::DoNotOptimize(hashes.data());
+			benchmark::ClobberMemory();
+		}
+	}
+}
+BENCHMARK(BM_RollHashes)
+	->Args({4})	 // spumoni2
+	->Args({15}) // minimap
+	->Args({31})
+	->Iterations(16); // kraken v1
+
 static void BM_ModMinRoll(benchmark::State &state) {
 	for (auto _ : state) {
 		state.PauseTiming();
@@ -75,6 +125,26 @@ BENCHMARK(BM_ModMinRoll)
 	->Args({16})
 	->Iterations(16); // comparison for threads
 
+// the congruence test alone, over hashes rolled beforehand, with a mod that
+// needs the multiply-shift reduction and with powers of two, which are masked
+static void BM_ModMinSelect(benchmark::State &state) {
+	const size_t block = 1 << 16;
+	std::vector<uint64_t> hashes(block);
+	std::vector<uint32_t> positions(block);
+	digest::ModMin<digest::BadCharPolicy::SKIPOVER> dig(s, 15, state.range(0));
+	size_t n = dig.roll_hashes(block, hashes.data(), positions.data());
+	std::vector<uint32_t> vec;
+	vec.reserve(n);
+	for (auto _ : state) {
+		vec.clear();
+		dig.select_minimizers(hashes.data(), positions.data(), n, vec);
+		benchmark::DoNotOptimize(vec.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_ModMinSelect)->Args({17})->Args({1000003})->Args({16});
+
 static void BM_WindowMinRoll(benchmark::State &state) {
 	for (auto _ : state) {
 		state.PauseTiming();
@@ -137,6 +207,604 @@ BENCHMARK(BM_SyncmerRoll)
 	->Args({16, 16})
 	->Iterations(16); // comparison for threads
 
+// mod-minimizers with the same large windows as BM_WindowMinRoll
+static void BM_ModMinimizerRoll(benchmark::State &state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		digest::ModMinimizer<digest::BadCharPolicy::SKIPOVER,
+							 digest::ds::Adaptive>
+			dig(s, state.range(0), state.range(1));
+		std::vector<uint32_t> vec;
+		vec.reserve(STR_LEN);
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(vec);
+		dig.roll_minimizer(STR_LEN, vec);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_ModMinimizerRoll)
+	->Args({15, 10}) // minimap
+	->Args({31, 15}) // kraken v1
+	->Args({16, 16})
+	->Iterations(16);
+
+// window minimizers with the k-mer orders of digest::order, the same large
+// windows as BM_WindowMinRoll
+template <class O> static void BM_WindowMinOrderRoll(benchmark::State &state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		digest::WindowMin<digest::BadCharPolicy::SKIPOVER, digest::ds::Adaptive,
+						  0, O>
+			dig(s, state.range(0), state.range(1));
+		std::vector<uint32_t> vec;
+		vec.reserve(STR_LEN);
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(vec);
+		dig.roll_minimizer(STR_LEN, vec);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK_TEMPLATE(BM_WindowMinOrderRoll, digest::order::Miniception<>)
+	->Args({15, 10}) // minimap
+	->Args({31, 15}) // kraken v1
+	->Args({16, 16})
+	->Iterations(16);
+BENCHMARK_TEMPLATE(BM_WindowMinOrderRoll, digest::order::Decycling<>)
+	->Args({15, 10}) // minimap
+	->Args({31, 15}) // kraken v1
+	->Args({16, 16})
+	->Iterations(16);
+
+// syncmers defined by the position of the minimal s-mer in the k-mer,
+// state.range(2) == 0 for closed syncmers and 1 for open syncmers with the
+// minimal s-mer in the middle
+static void BM_SmerSyncmerRoll(benchmark::State &state) {
+	unsigned k = state.range(0), s_len = state.range(1);
+	std::vector<unsigned> offsets =
+		state.range(2) ? digest::open_offsets((k - s_len) / 2)
+					   : digest::closed_offsets(k, s_len);
+	for (auto _ : state) {
+		state.PauseTiming();
+		digest::SmerSyncmer<digest::BadCharPolicy::SKIPOVER> dig(s, k, s_len,
+																offsets);
+		std::vector<uint32_t> vec;
+		vec.reserve(STR_LEN);
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(vec);
+		dig.roll_minimizer(STR_LEN, vec);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_SmerSyncmerRoll)
+	->Args({15, 5, 0})
+	->Args({15, 5, 1})
+	->Args({31, 8, 0})
+	->Args({31, 8, 1})
+	->Iterations(16);
+
+// strobemers with the positions of all strobes, arguments are k, the order,
+// w_min, w_max and 0 for minstrobes or 1 for randstrobes
+static void BM_StrobemerRoll(benchmark::State &state) {
+	auto type = state.range(4) ? digest::StrobeType::RANDSTROBE
+							   : digest::StrobeType::MINSTROBE;
+	for (auto _ : state) {
+		state.PauseTiming();
+		digest::Strobemer<digest::BadCharPolicy::SKIPOVER> dig(
+			s, state.range(0), state.range(1), state.range(2), state.range(3),
+			type);
+		std::vector<digest::Strobes> vec;
+		vec.reserve(STR_LEN);
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(vec);
+		dig.roll_minimizer(STR_LEN, vec);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_StrobemerRoll)
+	->Args({20, 2, 5, 11, 0})
+	->Args({20, 2, 5, 11, 1})
+	->Args({15, 3, 2, 12, 0})
+	->Args({15, 3, 2, 12, 1})
+	->Args({15, 3, 20, 70, 1})
+	->Iterations(16);
+
+// same as BM_ModMinRoll and BM_WindowMinRoll, but with k fixed at compile
+// time
+template <unsigned K> static void BM_ModMinRollFixedK(benchmark::State &state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		digest::ModMin<digest::BadCharPolicy::SKIPOVER, K> dig(s, K, 17);
+		std::vector<uint32_t> vec;
+		vec.reserve(STR_LEN);
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(vec);
+		dig.roll_minimizer(STR_LEN, vec);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK_TEMPLATE(BM_ModMinRollFixedK, 4)->Iterations(16);	 // spumoni2
+BENCHMARK_TEMPLATE(BM_ModMinRollFixedK, 15)->Iterations(16); // minimap
+BENCHMARK_TEMPLATE(BM_ModMinRollFixedK, 31)->Iterations(16); // kraken v1
+BENCHMARK_TEMPLATE(BM_ModMinRollFixedK, 16)->Iterations(16);
+
+template <unsigned K, int W>
+static void BM_WindowMinRollFixedK(benchmark::State &state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+						  digest::ds::SegmentTree<W>, K>
+			dig(s, K, W);
+		std::vector<uint32_t> vec;
+		vec.reserve(STR_LEN);
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(vec);
+		dig.roll_minimizer(STR_LEN, vec);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK_TEMPLATE(BM_WindowMinRollFixedK, 4, 11)->Iterations(16);	// spumoni2
+BENCHMARK_TEMPLATE(BM_WindowMinRollFixedK, 15, 10)->Iterations(16); // minimap
+BENCHMARK_TEMPLATE(BM_WindowMinRollFixedK, 31, 15)->Iterations(16); // kraken v1
+BENCHMARK_TEMPLATE(BM_WindowMinRollFixedK, 16, 16)->Iterations(16);
+
+// state.range(1) picks the minimized hash: 0 canonical, 1 forward, 2 reverse
+static const digest::MinimizedHashType hash_types[] = {
+	digest::MinimizedHashType::CANON, digest::MinimizedHashType::FORWARD,
+	digest::MinimizedHashType::REVERSE};
+
+static void BM_WindowMinHashType(benchmark::State &state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+						  digest::ds::Adaptive>
+			dig(s, state.range(0), DEFAULT_LARGE_WIND, 0,
+				hash_types[state.range(1)]);
+		std::vector<uint32_t> vec;
+		vec.reserve(STR_LEN);
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(vec);
+		dig.roll_minimizer(STR_LEN, vec);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_WindowMinHashType)
+	->ArgsProduct({{15, 31}, {0, 1, 2}})
+	->Iterations(16);
+
+static void BM_SyncmerHashType(benchmark::State &state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		digest::Syncmer<digest::BadCharPolicy::SKIPOVER, digest::ds::Adaptive>
+			dig(s, state.range(0), DEFAULT_LARGE_WIND, 0,
+				hash_types[state.range(1)]);
+		std::vector<uint32_t> vec;
+		vec.reserve(STR_LEN);
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(vec);
+		dig.roll_minimizer(STR_LEN, vec);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_SyncmerHashType)
+	->ArgsProduct({{15, 31}, {0, 1, 2}})
+	->Iterations(16);
+
+// appends the sequence chunk by chunk, like a streaming FASTA reader would
+static void BM_AppendSeqRoll(benchmark::State &state) {
+	size_t chunk = state.range(1);
+	for (auto _ : state) {
+		state.PauseTiming();
+		digest::ModMin<digest::BadCharPolicy::SKIPOVER> dig(
+			s.c_str(), chunk, state.range(0), 17);
+		std::vector<uint32_t> vec;
+		vec.reserve(STR_LEN);
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(vec);
+		dig.roll_minimizer(STR_LEN, vec);
+		for (size_t i = chunk; i < s.size(); i += chunk) {
+			dig.append_seq(s.c_str() + i, std::min(chunk, s.size() - i));
+			dig.roll_minimizer(STR_LEN, vec);
+		}
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_AppendSeqRoll)
+	->Args({15, 150}) // short read sized chunks
+	->Args({15, 4096})
+	->Args({31, 150})
+	->Args({31, 4096})
+	->Iterations(16);
+
+// same as BM_WindowMinRoll and BM_SyncmerRoll, but the minimizers go to a
+// sink that folds them into a checksum instead of into a vector
+template <int W> static void BM_WindowMinRollSink(benchmark::State &state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+						  digest::ds::SegmentTree<W>>
+			dig(s, state.range(0), W);
+		uint64_t sum = 0;
+		state.ResumeTiming();
+
+		dig.roll_minimizer(STR_LEN, [&sum](uint32_t pos) { sum += pos; });
+		benchmark::DoNotOptimize(sum);
+	}
+}
+BENCHMARK_TEMPLATE(BM_WindowMinRollSink, 11)->Args({4})->Iterations(16);
+BENCHMARK_TEMPLATE(BM_WindowMinRollSink, 10)->Args({15})->Iterations(16);
+BENCHMARK_TEMPLATE(BM_WindowMinRollSink, 15)->Args({31})->Iterations(16);
+BENCHMARK_TEMPLATE(BM_WindowMinRollSink, 16)->Args({16})->Iterations(16);
+
+template <int W> static void BM_SyncmerRollSink(benchmark::State &state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		digest::Syncmer<digest::BadCharPolicy::SKIPOVER,
+						digest::ds::SegmentTree<W>>
+			dig(s, state.range(0), W);
+		uint64_t sum = 0;
+		state.ResumeTiming();
+
+		dig.roll_minimizer(STR_LEN, [&sum](uint32_t pos) { sum += pos; });
+		benchmark::DoNotOptimize(sum);
+	}
+}
+BENCHMARK_TEMPLATE(BM_SyncmerRollSink, 12)->Args({4})->Iterations(16);
+BENCHMARK_TEMPLATE(BM_SyncmerRollSink, 11)->Args({15})->Iterations(16);
+BENCHMARK_TEMPLATE(BM_SyncmerRollSink, 16)->Args({31})->Iterations(16);
+BENCHMARK_TEMPLATE(BM_SyncmerRollSink, 16)->Args({16})->Iterations(16);
+
+// the large window is only known at runtime, state.range(1) == 0 uses
+// ds::Adaptive, state.range(1) == 1 uses the data structure the factory picks
+static void BM_WindowMinFactory(benchmark::State &state) {
+	const digest::BadCharPolicy P = digest::BadCharPolicy::SKIPOVER;
+	for (auto _ : state) {
+		state.PauseTiming();
+		std::unique_ptr<digest::Digester<P>> dig;
+		if (state.range(1)) {
+			dig = digest::factory::window_min<P>(s, DEFAULT_KMER_LEN,
+												 state.range(0));
+		} else {
+			dig = std::make_unique<digest::WindowMin<P, digest::ds::Adaptive>>(
+				s, DEFAULT_KMER_LEN, state.range(0));
+		}
+		std::vector<uint32_t> vec;
+		vec.reserve(STR_LEN);
+		state.ResumeTiming();
+		benchmark::DoNotOptimize(vec);
+		dig->roll_minimizer(STR_LEN, vec);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_WindowMinFactory)
+	->ArgsProduct({{8, 11, 14, 16, 24, 32, 64}, {0, 1}})
+	->Iterations(4);
+
+// state.range(1) == 0 uses WindowMin with ds::Adaptive, one k-mer at a time,
+// state.range(1) == 1 uses BlockWindowMin, which finds the same minimizers a
+// block of k-mers at a time
+static void BM_WindowMinBlock(benchmark::State &state) {
+	const digest::BadCharPolicy P = digest::BadCharPolicy::SKIPOVER;
+	for (auto _ : state) {
+		state.PauseTiming();
+		std::unique_ptr<digest::Digester<P>> dig;
+		if (state.range(1)) {
+			dig = std::make_unique<digest::BlockWindowMin<P>>(
+				s, DEFAULT_KMER_LEN, state.range(0));
+		} else {
+			dig = std::make_unique<digest::WindowMin<P, digest::ds::Adaptive>>(
+				s, DEFAULT_KMER_LEN, state.range(0));
+		}
+		std::vector<uint32_t> vec;
+		vec.reserve(STR_LEN);
+		state.ResumeTiming();
+		benchmark::DoNotOptimize(vec);
+		dig->roll_minimizer(STR_LEN, vec);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_WindowMinBlock)
+	->ArgsProduct({{4, 11, 16, 32, 64, 256}, {0, 1}})
+	->Iterations(4);
+
+// same as BM_WindowMinBlock, but the minimizers go to a sink that folds them
+// into a checksum, so the comparison doesn't include growing a vector
+static void BM_WindowMinBlockSink(benchmark::State &state) {
+	const digest::BadCharPolicy P = digest::BadCharPolicy::SKIPOVER;
+	for (auto _ : state) {
+		uint64_t sum = 0;
+		auto sink = [&sum](uint32_t pos) { sum += pos; };
+		if (state.range(1)) {
+			digest::BlockWindowMin<P> dig(s, DEFAULT_KMER_LEN, state.range(0));
+			dig.roll_minimizer(STR_LEN, sink);
+		} else {
+			digest::WindowMin<P, digest::ds::Adaptive> dig(s, DEFAULT_KMER_LEN,
+														   state.range(0));
+			dig.roll_minimizer(STR_LEN, sink);
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+}
+BENCHMARK(BM_WindowMinBlockSink)
+	->ArgsProduct({{4, 11, 16, 32, 64, 256}, {0, 1}})
+	->Iterations(4);
+
+// state.range(1) == 0 uses ModMin, one k-mer at a time, state.range(1) == 1
+// uses BlockModMin, which finds the same minimizers a block of k-mers at a
+// time and packs them with select_congruent(). state.range(0) is the mod.
+static void BM_ModMinBlock(benchmark::State &state) {
+	const digest::BadCharPolicy P = digest::BadCharPolicy::SKIPOVER;
+	for (auto _ : state) {
+		state.PauseTiming();
+		std::unique_ptr<digest::Digester<P>> dig;
+		if (state.range(1)) {
+			dig = std::make_unique<digest::BlockModMin<P>>(s, DEFAULT_KMER_LEN,
+														   state.range(0));
+		} else {
+			dig = std::make_unique<digest::ModMin<P>>(s, DEFAULT_KMER_LEN,
+													  state.range(0));
+		}
+		std::vector<uint32_t> vec;
+		vec.reserve(STR_LEN);
+		state.ResumeTiming();
+		benchmark::DoNotOptimize(vec);
+		dig->roll_minimizer(STR_LEN, vec);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_ModMinBlock)
+	->ArgsProduct({{2, 8, 17, 64, 1000}, {0, 1}})
+	->Iterations(4);
+
+// per read digestion
+// ---------------------------------------------------------------
+// chrY cut into 150 bp reads, each digested with new_seq() and a small
+// roll_minimizer() call, so the cost of each call matters. range(0) == 0 goes
+// through a Digester reference, so every call is virtual, range(0) == 1 uses
+// Static, so every call is bound at compile time.
+#define READ_LEN 150
+#define READ_COUNT 100000
+
+template <class D>
+static void per_read(benchmark::State &state, D &dig,
+					 std::vector<uint32_t> &vec) {
+	digest::Digester<digest::BadCharPolicy::SKIPOVER> *base = &dig;
+	benchmark::DoNotOptimize(base);
+	for (auto _ : state) {
+		for (size_t r = 0; r < READ_COUNT; r++) {
+			const char *read = s.c_str() + r * READ_LEN;
+			vec.clear();
+			if (state.range(0) == 0) {
+				base->new_seq(read, READ_LEN, 0);
+				base->roll_minimizer(READ_LEN, vec);
+			} else {
+				dig.new_seq(read, READ_LEN, 0);
+				dig.roll_minimizer(READ_LEN, vec);
+			}
+			benchmark::DoNotOptimize(vec.data());
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * READ_COUNT);
+}
+
+static void BM_PerReadModMin(benchmark::State &state) {
+	digest::Static<digest::ModMin<digest::BadCharPolicy::SKIPOVER>> dig(
+		s.c_str(), READ_LEN, DEFAULT_KMER_LEN, 17);
+	std::vector<uint32_t> vec;
+	per_read(state, dig, vec);
+}
+BENCHMARK(BM_PerReadModMin)->Arg(0)->Arg(1);
+
+static void BM_PerReadWindowMin(benchmark::State &state) {
+	digest::Static<digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+									 digest::ds::Adaptive>>
+		dig(s.c_str(), READ_LEN, DEFAULT_KMER_LEN, 11);
+	std::vector<uint32_t> vec;
+	per_read(state, dig, vec);
+}
+BENCHMARK(BM_PerReadWindowMin)->Arg(0)->Arg(1);
+
+static void BM_PerReadSyncmer(benchmark::State &state) {
+	digest::Static<digest::Syncmer<digest::BadCharPolicy::SKIPOVER,
+								   digest::ds::Adaptive>>
+		dig(s.c_str(), READ_LEN, DEFAULT_KMER_LEN, 11);
+	std::vector<uint32_t> vec;
+	per_read(state, dig, vec);
+}
+BENCHMARK(BM_PerReadSyncmer)->Arg(0)->Arg(1);
+
+// non-ACTG scanning
+// ---------------------------------------------------------------
+// chrY with a run of n_run N's after every 1000 bases, like the gaps of an
+// assembly
+static std::string with_n_runs(size_t n_run) {
+	std::string str;
+	for (size_t i = 0; i < s.size(); i += 1000) {
+		str += s.substr(i, 1000);
+		str += std::string(n_run, 'N');
+	}
+	return str;
+}
+
+// walks the runs of ACTG and non-ACTG characters with a lookup table, one
+// byte at a time, the way init_hash_skip_over() used to
+static void BM_ScanNonACTGTable(benchmark::State &state) {
+	std::string str = with_n_runs(state.range(0));
+	std::array<bool, 256> actg{};
+	for (unsigned char c : std::string("ACGTacgt")) {
+		actg[c] = true;
+	}
+	for (auto _ : state) {
+		size_t runs = 0;
+		size_t i = 0;
+		while (i < str.size()) {
+			while (i < str.size() && actg[(unsigned char)str[i]]) {
+				i++;
+			}
+			while (i < str.size() && !actg[(unsigned char)str[i]]) {
+				i++;
+			}
+			runs++;
+		}
+		benchmark::DoNotOptimize(runs);
+	}
+}
+BENCHMARK(BM_ScanNonACTGTable)->Args({100})->Args({10000});
+
+// same walk with find_non_ACTG() and find_ACTG()
+static void BM_ScanNonACTG(benchmark::State &state) {
+	std::string str = with_n_runs(state.range(0));
+	for (auto _ : state) {
+		size_t runs = 0;
+		size_t i = 0;
+		while (i < str.size()) {
+			i = digest::find_non_ACTG(str.c_str(), i, str.size());
+			i = digest::find_ACTG(str.c_str(), i, str.size());
+			runs++;
+		}
+		benchmark::DoNotOptimize(runs);
+	}
+}
+BENCHMARK(BM_ScanNonACTG)->Args({100})->Args({10000});
+
+// end to end, every N run makes the digester re-seed
+static void BM_ModMinRollNRuns(benchmark::State &state) {
+	std::string str = with_n_runs(state.range(1));
+	for (auto _ : state) {
+		state.PauseTiming();
+		digest::ModMin<digest::BadCharPolicy::SKIPOVER> dig(
+			str, state.range(0), 17);
+		std::vector<uint32_t> vec;
+		vec.reserve(str.size());
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(vec);
+		dig.roll_minimizer(str.size(), vec);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_ModMinRollNRuns)
+	->ArgsProduct({{15, 31}, {100, 10000}})
+	->Iterations(16);
+
+// 2-bit packed input
+// ---------------------------------------------------------------
+// unpacks the whole sequence into a temporary buffer, then digests it
+static void BM_UnpackThenRoll(benchmark::State &state) {
+	std::vector<uint8_t> packed;
+	digest::NIntervals n_intervals;
+	digest::pack_bases(s.c_str(), s.size(), packed, n_intervals);
+	for (auto _ : state) {
+		state.PauseTiming();
+		std::vector<uint32_t> vec;
+		vec.reserve(STR_LEN);
+		state.ResumeTiming();
+
+		std::string unpacked(s.size(), 0);
+		size_t interval = 0;
+		digest::unpack_bases(packed.data(), 0, s.size(), n_intervals, interval,
+							 &unpacked[0]);
+		digest::ModMin<digest::BadCharPolicy::SKIPOVER> dig(
+			unpacked, state.range(0), 17);
+		benchmark::DoNotOptimize(vec);
+		dig.roll_minimizer(STR_LEN, vec);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_UnpackThenRoll)->Args({15})->Args({31})->Iterations(16);
+
+// digests the packed sequence directly
+static void BM_PackedRoll(benchmark::State &state) {
+	std::vector<uint8_t> packed;
+	digest::NIntervals n_intervals;
+	digest::pack_bases(s.c_str(), s.size(), packed, n_intervals);
+	for (auto _ : state) {
+		state.PauseTiming();
+		std::vector<uint32_t> vec;
+		vec.reserve(STR_LEN);
+		state.ResumeTiming();
+
+		digest::ModMin<digest::BadCharPolicy::SKIPOVER> dig(
+			packed.data(), s.size(), n_intervals, state.range(0), 17);
+		benchmark::DoNotOptimize(vec);
+		dig.roll_minimizer(STR_LEN, vec);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_PackedRoll)->Args({15})->Args({31})->Iterations(16);
+
+// multi lane benchmarking
+// ------------------------------------------------------------------
+// chrY split into state.range(1) segments, digested one after the other
+// (range(2) == 0) or in lockstep lanes (range(2) == 1)
+static void BM_MultiLaneMod(benchmark::State &state) {
+	size_t segs = state.range(1);
+	size_t seg_len = s.size() / segs;
+	for (auto _ : state) {
+		state.PauseTiming();
+		std::vector<digest::ModMin<digest::BadCharPolicy::SKIPOVER>> digs;
+		for (size_t i = 0; i < segs; i++) {
+			digs.emplace_back(s.c_str() + i * seg_len, seg_len, state.range(0),
+							  17);
+		}
+		std::vector<std::vector<uint32_t>> vec(segs);
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(vec);
+		if (state.range(2)) {
+			digest::multi_lane::roll_minimizer<
+				digest::BadCharPolicy::SKIPOVER>(digs, vec);
+		} else {
+			for (size_t i = 0; i < segs; i++) {
+				digs[i].roll_minimizer(STR_LEN, vec[i]);
+			}
+		}
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_MultiLaneMod)
+	->ArgsProduct({{15, 31}, {8}, {0, 1}})
+	->Iterations(16);
+
+static void BM_MultiLaneWind(benchmark::State &state) {
+	size_t segs = state.range(1);
+	size_t seg_len = s.size() / segs;
+	for (auto _ : state) {
+		state.PauseTiming();
+		std::vector<digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+									  digest::ds::Adaptive>>
+			digs;
+		for (size_t i = 0; i < segs; i++) {
+			digs.emplace_back(s.c_str() + i * seg_len, seg_len, state.range(0),
+							  DEFAULT_LARGE_WIND);
+		}
+		std::vector<std::vector<uint32_t>> vec(segs);
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(vec);
+		if (state.range(2)) {
+			digest::multi_lane::roll_minimizer<
+				digest::BadCharPolicy::SKIPOVER>(digs, vec);
+		} else {
+			for (size_t i = 0; i < segs; i++) {
+				digs[i].roll_minimizer(STR_LEN, vec[i]);
+			}
+		}
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_MultiLaneWind)
+	->ArgsProduct({{15, 31}, {8}, {0, 1}})
+	->Iterations(16);
+
 // thread benchmarking
 // ---------------------------------------------------------------------
 static void BM_ThreadMod(benchmark::State &state) {
@@ -197,6 +865,25 @@ BENCHMARK(BM_ThreadSync)
 	->UseRealTime()
 	->Iterations(16);
 
+static void BM_ThreadStrobe(benchmark::State &state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		std::vector<std::vector<digest::Strobes>> vec;
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(vec);
+		digest::thread_out::thread_strobe<digest::BadCharPolicy::SKIPOVER,
+										  digest::ds::Adaptive>(
+			state.range(0), vec, s, 20, 2, 5, 11);
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_ThreadStrobe)
+	->Args({1})
+	->ArgsProduct({benchmark::CreateDenseRange(2, 64, 2)})
+	->UseRealTime()
+	->Iterations(16);
+
 // constructor sanity check grouping
 // -----------------------------------------------------
 /*
@@ -11,52 +11,6 @@
 
 namespace digest::ds {
 
-template <uint32_t k> struct MonoQueue {
-	int head = 0, tail = 0;
-	// one extra slot so empty() works when full
-	// {hash, index, time}
-	std::array<std::array<uint32_t, k + 1>, 3> queue;
-	uint32_t time = 0;
-
-	bool empty() { return head == tail; }
-
-	MonoQueue(uint32_t) {
-		queue[2].fill(0); // necessary to avoid 1 in a billion collision
-		queue[0].fill(0); // gets rid of warning
-	}
-	MonoQueue(const MonoQueue &other) = default;
-	MonoQueue &operator=(const MonoQueue &other) = default;
-
-	void insert(uint32_t index, uint32_t hash) {
-		if (queue[2][head] == time - k) {
-			if (++head == k + 1) {
-				head = 0;
-			}
-		}
-
-		while (not empty() and queue[0][tail == 0 ? k : tail - 1] >= hash) {
-			if (--tail == -1) {
-				tail = k;
-			}
-		}
-
-		queue[0][tail] = hash;
-		queue[1][tail] = index;
-		queue[2][tail] = time++;
-
-		if (++tail == k + 1)
-			tail = 0;
-	}
-
-	uint32_t min() { return queue[1][head]; }
-
-	// void min_syncmer(std::vector<uint32_t> &vec) {
-	// 	if (queue[2][head] == time - k or queue[2][head] == time - 1) {
-	// 		vec.emplace_back(queue[1][head]);
-	// 	}
-	// }
-};
-
 template <uint32_t k> struct Set {
 	std::set<uint64_t> mset;
 	std::array<std::set<uint64_t>::iterator, k> vec;
@@ -102,6 +56,11 @@ void setupInput() {
 	// for (int i = 0; i < 2*INPUT_SIZE; i++) {
 	// 	hashes[i] = hashes[0];
 	// }
+
+	// worst case for Naive2 and Adaptive, runs of increasing hashes
+	// for (int i = 0; i < 2*INPUT_SIZE; i++) {
+	// 	hashes[i] = i % 4096 * 1000;
+	// }
 }
 
 template <int k, class T, int out> static void BM(benchmark::State &state) {
@@ -157,8 +116,12 @@ test(digest::ds::Naive, 0) test(digest::ds::Naive2, 1)
 	test(digest::ds::MonoQueue, 2) test(digest::ds::SegmentTree, 3)
 		test(digest::ds::Set, 4) test2(digest::ds::Adaptive, 5)
 			test2(digest::ds::Adaptive64, 6)
+				test2(digest::ds::MonoQueue<>, 7)
+					test(digest::ds::MonoQueue64, 8)
+						test2(digest::ds::SegmentTree<>, 9)
+							test(digest::ds::SegmentTree64, 10)
 
-				int main(int argc, char **argv) {
+								int main(int argc, char **argv) {
 	setupInput();
 	benchmark::Initialize(&argc, argv);
 	benchmark::RunSpecifiedBenchmarks();
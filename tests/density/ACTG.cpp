@@ -2,6 +2,7 @@
 
 #include "digest/data_structure.hpp"
 #include "digest/mod_minimizer.hpp"
+#include "digest/order.hpp"
 #include "digest/syncmer.hpp"
 #include "digest/window_minimizer.hpp"
 
@@ -46,6 +47,8 @@ int main() {
 	std::vector<std::vector<double>> mod_min_vec(4, std::vector<double>());
 	std::vector<std::vector<double>> wind_min_vec(4, std::vector<double>());
 	std::vector<std::vector<double>> sync_vec(4, std::vector<double>());
+	std::vector<std::vector<double>> mini_vec(4, std::vector<double>());
+	std::vector<std::vector<double>> decyc_vec(4, std::vector<double>());
 
 	uint64_t mods[4] = {109, 128, 1009, 1024};
 	unsigned l_winds[4] = {7, 8, 17, 16};
@@ -91,6 +94,37 @@ int main() {
 			sync_vec[i].pb(am);
 		}
 	}
+
+	// window minimizers with the Miniception and double decycling orders
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 100; j++) {
+			digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+							  digest::ds::Adaptive, 0,
+							  digest::order::Miniception<>>
+				wm(strs[j], 16, l_winds[i], 0,
+				   digest::MinimizedHashType::CANON);
+			std::vector<uint32_t> temp;
+			wm.roll_minimizer(100000, temp);
+			double am = temp.size();
+			am /= kmers;
+			mini_vec[i].pb(am);
+		}
+	}
+
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 100; j++) {
+			digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+							  digest::ds::Adaptive, 0,
+							  digest::order::Decycling<>>
+				wm(strs[j], 16, l_winds[i], 0,
+				   digest::MinimizedHashType::CANON);
+			std::vector<uint32_t> temp;
+			wm.roll_minimizer(100000, temp);
+			double am = temp.size();
+			am /= kmers;
+			decyc_vec[i].pb(am);
+		}
+	}
 	assert(freopen("../tests/density/out1.txt", "w", stdout));
 	for (int i = 0; i < 4; i++) {
 		for (size_t j = 0; j < 100; j++) {
@@ -113,5 +147,19 @@ int main() {
 		std::cout << std::endl;
 	}
 
+	for (int i = 0; i < 4; i++) {
+		for (size_t j = 0; j < 100; j++) {
+			std::cout << mini_vec[i][j] << " ";
+		}
+		std::cout << std::endl;
+	}
+
+	for (int i = 0; i < 4; i++) {
+		for (size_t j = 0; j < 100; j++) {
+			std::cout << decyc_vec[i][j] << " ";
+		}
+		std::cout << std::endl;
+	}
+
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include <cassert>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "digest/data_structure.hpp"
+#include "digest/window_minimizer.hpp"
+#include "digest/window_mod_minimizer.hpp"
+
+// density of mod-minimizers next to window minimizers on the ACTG only
+// sequences, for the k-mer lengths where the t-mers of the mod-minimizer are
+// shorter than the k-mers, and the theoretical density of window minimizers,
+// 2 / (w + 1), and the lower bound of any scheme, 1 / w, for comparison
+int main() {
+	std::cout << std::fixed << std::setprecision(8);
+
+	std::vector<std::string> strs;
+	assert(freopen("../tests/density/ACTG.txt", "r", stdin));
+	for (int i = 0; i < 100; i++) {
+		std::string str;
+		std::cin >> str;
+		strs.push_back(str);
+	}
+
+	unsigned ks[3] = {16, 31, 63};
+	unsigned l_winds[4] = {5, 8, 11, 16};
+
+	assert(freopen("../tests/density/mod_minimizer_out.txt", "w", stdout));
+	std::cout << "k w 1/w 2/(w+1) window mod" << std::endl;
+	for (unsigned k : ks) {
+		for (unsigned w : l_winds) {
+			double wind_sum = 0, mod_sum = 0;
+			for (auto &str : strs) {
+				double kmers = str.size() - k + 1;
+				std::vector<uint32_t> temp;
+				digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+								  digest::ds::Adaptive>
+					wm(str, k, w, 0, digest::MinimizedHashType::CANON);
+				wm.roll_minimizer(str.size(), temp);
+				wind_sum += temp.size() / kmers;
+
+				temp.clear();
+				digest::ModMinimizer<digest::BadCharPolicy::SKIPOVER,
+									 digest::ds::Adaptive>
+					mm(str, k, w, 0, digest::MinimizedHashType::CANON);
+				mm.roll_minimizer(str.size(), temp);
+				mod_sum += temp.size() / kmers;
+			}
+			std::cout << k << " " << w << " " << 1.0 / w << " "
+					  << 2.0 / (w + 1) << " " << wind_sum / strs.size() << " "
+					  << mod_sum / strs.size() << std::endl;
+		}
+	}
+
+	return 0;
+}
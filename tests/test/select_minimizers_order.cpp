@@ -0,0 +1,35 @@
+// Must not compile: select_minimizers() only supports order::Hash, and hits a
+// static_assert for any other order. The compile suite of `meson test` checks
+// that this file fails to compile as is, and compiles with
+// -DSELECT_ORDER=digest::order::Hash, so the failure comes from the assert.
+#include "digest/data_structure.hpp"
+#include "digest/order.hpp"
+#include "digest/syncmer.hpp"
+#include "digest/window_minimizer.hpp"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#ifndef SELECT_ORDER
+#define SELECT_ORDER digest::order::Miniception<>
+#endif
+
+template <class D> void select(D &dig) {
+	uint64_t hashes[1] = {0};
+	uint32_t positions[1] = {0};
+	std::vector<uint32_t> vec1;
+	std::vector<std::pair<uint32_t, uint32_t>> vec2;
+	dig.select_minimizers(hashes, positions, 1, vec1);
+	dig.select_minimizers(hashes, positions, 1, vec2);
+}
+
+int main() {
+	const digest::BadCharPolicy P = digest::BadCharPolicy::SKIPOVER;
+	digest::WindowMin<P, digest::ds::Adaptive, 0, SELECT_ORDER> wind(
+		"ACTGACTGACTG", 4, 4);
+	digest::Syncmer<P, digest::ds::Adaptive, 0, SELECT_ORDER> sync(
+		"ACTGACTGACTG", 4, 4);
+	select(wind);
+	select(sync);
+	return 0;
+}
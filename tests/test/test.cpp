@@ -1,12 +1,26 @@
+#include "digest/block_minimizer.hpp"
+#include "digest/calibrate.hpp"
 #include "digest/data_structure.hpp"
+#include "digest/factory.hpp"
 #include "digest/mod_minimizer.hpp"
+#include "digest/multi_lane.hpp"
+#include "digest/order.hpp"
+#include "digest/packed_seq.hpp"
+#include "digest/smer_syncmer.hpp"
+#include "digest/strobemer.hpp"
 #include "digest/syncmer.hpp"
 #include "digest/window_minimizer.hpp"
+#include "digest/window_mod_minimizer.hpp"
 #include <catch2/catch_test_macros.hpp>
+#include <cctype>
+#include <cmath>
 #include <cstdint>
+#include <cstdio>
 #include <fstream>
 #include <iterator>
 #include <map>
+#include <random>
+#include <tuple>
 #include <vector>
 
 std::vector<std::string> test_strs;
@@ -254,6 +268,32 @@ void roll_one_write_over(digest::Digester<P> &dig, std::string &str,
 	CHECK(dig.get_is_valid_hash() == worked);
 }
 
+template <digest::BadCharPolicy P>
+void roll_hashes_comp(digest::Digester<P> &dig1, digest::Digester<P> &dig2,
+					  size_t chunk) {
+	std::vector<uint64_t> hashes(chunk);
+	std::vector<uint32_t> positions(chunk);
+	size_t n;
+	do {
+		n = dig2.roll_hashes(chunk, hashes.data(), positions.data());
+		for (size_t i = 0; i < n; i++) {
+			CHECK(dig1.get_is_valid_hash());
+			CHECK(positions[i] == dig1.get_pos());
+			if (dig1.get_minimized_h() == digest::MinimizedHashType::CANON) {
+				CHECK(hashes[i] == dig1.get_chash());
+			} else if (dig1.get_minimized_h() ==
+					   digest::MinimizedHashType::FORWARD) {
+				CHECK(hashes[i] == dig1.get_fhash());
+			} else {
+				CHECK(hashes[i] == dig1.get_rhash());
+			}
+			dig1.roll_one();
+		}
+	} while (n == chunk);
+	CHECK(dig1.get_is_valid_hash() == dig2.get_is_valid_hash());
+	CHECK(dig2.get_is_valid_hash() == false);
+}
+
 template <digest::BadCharPolicy P>
 void ModMin_roll_minimizer(digest::ModMin<P> &dig, std::string &str, unsigned k,
 						   digest::MinimizedHashType minimized_h,
@@ -926,6 +966,79 @@ TEST_CASE("Digester Testing") {
 		}
 	}
 
+	SECTION("Testing roll_hashes()") {
+		for (int i = 0; i < 7; i++) {
+			for (int j = 0; j < 8; j++) {
+				for (int p = 0; p < 3; p++) {
+					digest::MinimizedHashType minimized_h =
+						static_cast<digest::MinimizedHashType>(p);
+					digest::ModMin<digest::BadCharPolicy::SKIPOVER> dig1(
+						test_strs[i], ks[j], 17, 0, 0, minimized_h);
+					digest::ModMin<digest::BadCharPolicy::SKIPOVER> dig2(
+						test_strs[i], ks[j], 17, 0, 0, minimized_h);
+					roll_hashes_comp(dig1, dig2, 7);
+				}
+			}
+		}
+
+		for (int j = 0; j < 8; j++) {
+			digest::ModMin<digest::BadCharPolicy::WRITEOVER> dig1(
+				test_strs[4], ks[j], 17, 0, 0,
+				digest::MinimizedHashType::FORWARD);
+			digest::ModMin<digest::BadCharPolicy::WRITEOVER> dig2(
+				test_strs[4], ks[j], 17, 0, 0,
+				digest::MinimizedHashType::FORWARD);
+			roll_hashes_comp(dig1, dig2, 1000);
+		}
+
+		// characters carried over by append_seq
+		for (int i = 0; i < 7; i += 2) {
+			for (int j = 0; j < 8; j++) {
+				std::string str1 = test_strs[i].substr(0, 45);
+				std::string str2 = test_strs[i].substr(45, 100);
+				digest::ModMin<digest::BadCharPolicy::SKIPOVER> dig1(
+					str1, ks[j], 17, 0, 0, digest::MinimizedHashType::CANON);
+				digest::ModMin<digest::BadCharPolicy::SKIPOVER> dig2(
+					str1, ks[j], 17, 0, 0, digest::MinimizedHashType::CANON);
+				roll_hashes_comp(dig1, dig2, 5);
+				dig1.append_seq(str2);
+				dig2.append_seq(str2);
+				roll_hashes_comp(dig1, dig2, 5);
+			}
+		}
+	}
+
+	SECTION("Testing find_non_ACTG() and find_ACTG()") {
+		std::string actg = "ACGTacgt";
+		for (uint i = 0; i < test_strs.size(); i++) {
+			const std::string &str = test_strs[i];
+			// every start and a few ends, so the SIMD loops and the scalar
+			// tail both get hit
+			for (size_t from = 0; from < std::min<size_t>(str.size(), 70);
+				 from++) {
+				for (size_t to : {from, from + 15, from + 33, str.size()}) {
+					to = std::min(to, str.size());
+					size_t bad = from, good = from;
+					while (bad < to &&
+						   actg.find(str[bad]) != std::string::npos) {
+						bad++;
+					}
+					while (good < to &&
+						   actg.find(str[good]) == std::string::npos) {
+						good++;
+					}
+					CHECK(digest::find_non_ACTG(str.c_str(), from, to) == bad);
+					CHECK(digest::find_ACTG(str.c_str(), from, to) == good);
+					// the fallback on CPUs without AVX2
+					CHECK(digest::find_by_ACTG_sse2<false>(str.c_str(), from,
+														   to) == bad);
+					CHECK(digest::find_by_ACTG_sse2<true>(str.c_str(), from,
+														  to) == good);
+				}
+			}
+		}
+	}
+
 	SECTION("Testing append_seq()") {
 		append_seq_small_cases();
 		// Throws NotRolledTillEndException()
@@ -1229,6 +1342,12 @@ TEST_CASE("ModMin Testing") {
 	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::SegmentTree<33>, 33) }    \
 	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::SegmentTree<63>, 63) }    \
 	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::SegmentTree<64>, 64) }    \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::SegmentTree<>, 4) }       \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::SegmentTree<>, 31) }      \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::SegmentTree<>, 32) }      \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::SegmentTree<>, 33) }      \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::SegmentTree<>, 63) }      \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::SegmentTree<>, 64) }      \
 	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::Naive<4>, 4) }            \
 	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::Naive<31>, 31) }          \
 	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::Naive<32>, 32) }          \
@@ -1246,7 +1365,19 @@ TEST_CASE("ModMin Testing") {
 	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::Adaptive, 32) }           \
 	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::Adaptive, 33) }           \
 	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::Adaptive, 63) }           \
-	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::Adaptive, 64) }
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::Adaptive, 64) }           \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::MonoQueue<4>, 4) }        \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::MonoQueue<31>, 31) }      \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::MonoQueue<32>, 32) }      \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::MonoQueue<33>, 33) }      \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::MonoQueue<63>, 63) }      \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::MonoQueue<64>, 64) }      \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::MonoQueue<>, 4) }         \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::MonoQueue<>, 31) }        \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::MonoQueue<>, 32) }        \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::MonoQueue<>, 33) }        \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::MonoQueue<>, 63) }        \
+	{ F(digest::BadCharPolicy::SKIPOVER, digest::ds::MonoQueue<>, 64) }
 
 TEST_CASE("WindowMin Testing") {
 	SECTION("Constructor Testing") {
@@ -1520,6 +1651,473 @@ TEST_CASE("Syncmer Testing") {
 	}
 }
 
+template <digest::BadCharPolicy P, class D>
+void multi_lane_comp(std::vector<D> &digs, size_t block) {
+	std::vector<D> single_digs(digs);
+	std::vector<std::vector<uint32_t>> single1(digs.size());
+	std::vector<std::vector<std::pair<uint32_t, uint32_t>>> single2(
+		digs.size());
+	for (size_t i = 0; i < digs.size(); i++) {
+		D copy(single_digs[i]);
+		single_digs[i].roll_minimizer(1e6, single1[i]);
+		copy.roll_minimizer(1e6, single2[i]);
+	}
+
+	// every instruction set this CPU can run
+	for (int isa = 0; isa <= (int)digest::get_isa(); isa++) {
+		std::vector<D> digs1(digs), digs2(digs);
+		std::vector<std::vector<uint32_t>> vec1;
+		std::vector<std::vector<std::pair<uint32_t, uint32_t>>> vec2;
+		digest::multi_lane::roll_minimizer<P>(
+			digs1, vec1, block, static_cast<digest::Isa>(isa));
+		digest::multi_lane::roll_minimizer<P>(
+			digs2, vec2, block, static_cast<digest::Isa>(isa));
+		CHECK(vec1 == single1);
+		CHECK(vec2 == single2);
+		for (size_t i = 0; i < digs.size(); i++) {
+			CHECK(digs1[i].get_is_valid_hash() == false);
+		}
+	}
+}
+
+TEST_CASE("MultiLane Testing") {
+	setupStrings();
+	SECTION("Output matches roll_minimizer()") {
+		for (int j = 0; j < 8; j++) {
+			for (int l = 0; l < 3; l++) {
+				digest::MinimizedHashType minimized_h =
+					static_cast<digest::MinimizedHashType>(l);
+				std::vector<digest::ModMin<digest::BadCharPolicy::SKIPOVER>>
+					mods;
+				std::vector<digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+											  digest::ds::Adaptive>>
+					winds;
+				std::vector<digest::Syncmer<digest::BadCharPolicy::SKIPOVER,
+											digest::ds::Adaptive>>
+					syncs;
+				// more digesters than lanes, so the last group is partial
+				for (uint i = 0; i < test_strs.size(); i++) {
+					for (size_t start = 0; start < 30; start += 15) {
+						mods.emplace_back(test_strs[i], ks[j], 17, 0, start,
+										  minimized_h);
+						winds.emplace_back(test_strs[i], ks[j], 11, start,
+										   minimized_h);
+						syncs.emplace_back(test_strs[i], ks[j], 11, start,
+										   minimized_h);
+					}
+				}
+				for (size_t block : {7, 4096}) {
+					multi_lane_comp<digest::BadCharPolicy::SKIPOVER>(mods,
+																	 block);
+					multi_lane_comp<digest::BadCharPolicy::SKIPOVER>(winds,
+																	 block);
+					multi_lane_comp<digest::BadCharPolicy::SKIPOVER>(syncs,
+																	 block);
+				}
+			}
+		}
+	}
+
+	SECTION("WRITEOVER policy") {
+		for (int j = 0; j < 8; j++) {
+			std::vector<digest::ModMin<digest::BadCharPolicy::WRITEOVER>> mods;
+			std::vector<digest::WindowMin<digest::BadCharPolicy::WRITEOVER,
+										  digest::ds::Adaptive>>
+				winds;
+			for (uint i = 0; i < test_strs.size(); i++) {
+				mods.emplace_back(test_strs[i], ks[j], 17);
+				winds.emplace_back(test_strs[i], ks[j], 11);
+			}
+			multi_lane_comp<digest::BadCharPolicy::WRITEOVER>(mods, 7);
+			multi_lane_comp<digest::BadCharPolicy::WRITEOVER>(winds, 4096);
+		}
+	}
+
+	SECTION("Characters left over from append_seq()") {
+		for (int j = 0; j < 8; j++) {
+			std::vector<digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+										  digest::ds::Adaptive>>
+				winds;
+			std::vector<std::string> str2s;
+			for (int i = 0; i < 7; i += 2) {
+				str2s.push_back(test_strs[i].substr(45, 100));
+			}
+			for (int i = 0; i < 7; i += 2) {
+				std::string str1 = test_strs[i].substr(0, 45);
+				winds.emplace_back(str1, ks[j], 11);
+				std::vector<uint32_t> vec;
+				winds.back().roll_minimizer(1000, vec);
+				winds.back().append_seq(str2s[i / 2]);
+			}
+			multi_lane_comp<digest::BadCharPolicy::SKIPOVER>(winds, 7);
+		}
+	}
+
+	SECTION("Mixed hash types, cases and k in a group") {
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+	(defined(__GNUC__) || defined(__clang__))
+		// otherwise the vector step is never taken
+		CHECK(digest::multi_lane::nthash_is_split_rotation());
+#endif
+		for (int j = 0; j < 8; j++) {
+			std::vector<digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+										  digest::ds::Adaptive>>
+				same_k, mixed_k;
+			std::vector<std::string> strs;
+			for (uint i = 0; i < test_strs.size(); i++) {
+				std::string lower = test_strs[i];
+				for (size_t c = 0; c < lower.size(); c += 3) {
+					lower[c] = std::tolower(lower[c]);
+				}
+				strs.push_back(lower);
+			}
+			for (uint i = 0; i < strs.size(); i++) {
+				digest::MinimizedHashType minimized_h =
+					static_cast<digest::MinimizedHashType>(i % 3);
+				same_k.emplace_back(strs[i], ks[j], 11, 0, minimized_h);
+				mixed_k.emplace_back(strs[i], ks[(j + i) % 8], 11, 0,
+									 minimized_h);
+			}
+			multi_lane_comp<digest::BadCharPolicy::SKIPOVER>(same_k, 4096);
+			multi_lane_comp<digest::BadCharPolicy::SKIPOVER>(mixed_k, 9);
+		}
+	}
+}
+
+template <digest::BadCharPolicy P, unsigned K> void fixed_k_comp() {
+	for (uint i = 0; i < test_strs.size(); i++) {
+		for (int l = 0; l < 3; l++) {
+			digest::MinimizedHashType minimized_h =
+				static_cast<digest::MinimizedHashType>(l);
+			std::vector<std::pair<uint32_t, uint32_t>> vec1, vec2, vec3, vec4,
+				vec5, vec6;
+
+			digest::ModMin<P> mod1(test_strs[i], K, 17, 0, 0, minimized_h);
+			digest::ModMin<P, K> mod2(test_strs[i], K, 17, 0, 0, minimized_h);
+			mod1.roll_minimizer(1e6, vec1);
+			mod2.roll_minimizer(1e6, vec2);
+			CHECK(vec1 == vec2);
+
+			digest::WindowMin<P, digest::ds::Adaptive> wind1(
+				test_strs[i], K, 11, 0, minimized_h);
+			digest::WindowMin<P, digest::ds::Adaptive, K> wind2(
+				test_strs[i], K, 11, 0, minimized_h);
+			wind1.roll_minimizer(1e6, vec3);
+			wind2.roll_minimizer(1e6, vec4);
+			CHECK(vec3 == vec4);
+
+			digest::Syncmer<P, digest::ds::Adaptive> sync1(test_strs[i], K, 11,
+														   0, minimized_h);
+			digest::Syncmer<P, digest::ds::Adaptive, K> sync2(
+				test_strs[i], K, 11, 0, minimized_h);
+			sync1.roll_minimizer(1e6, vec5);
+			sync2.roll_minimizer(1e6, vec6);
+			CHECK(vec5 == vec6);
+		}
+	}
+}
+
+TEST_CASE("Fixed K Testing") {
+	setupStrings();
+	SECTION("Testing Constructors") {
+		// k has to match K
+		CHECK_THROWS_AS(
+			(digest::ModMin<digest::BadCharPolicy::SKIPOVER, 16>(test_strs[0],
+																 15, 17)),
+			digest::BadConstructionException);
+		CHECK_THROWS_AS((digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+										   digest::ds::Adaptive, 16>(
+							test_strs[0], 15, 11)),
+						digest::BadConstructionException);
+		digest::ModMin<digest::BadCharPolicy::SKIPOVER, 16> dig(test_strs[0],
+																 16, 17);
+		CHECK(dig.get_k() == 16);
+	}
+
+	SECTION("Output matches runtime k") {
+		fixed_k_comp<digest::BadCharPolicy::SKIPOVER, 4>();
+		fixed_k_comp<digest::BadCharPolicy::SKIPOVER, 16>();
+		fixed_k_comp<digest::BadCharPolicy::SKIPOVER, 25>();
+		fixed_k_comp<digest::BadCharPolicy::SKIPOVER, 64>();
+		fixed_k_comp<digest::BadCharPolicy::WRITEOVER, 4>();
+		fixed_k_comp<digest::BadCharPolicy::WRITEOVER, 16>();
+		fixed_k_comp<digest::BadCharPolicy::WRITEOVER, 25>();
+		fixed_k_comp<digest::BadCharPolicy::WRITEOVER, 64>();
+	}
+
+	SECTION("Multi lane") {
+		std::vector<digest::ModMin<digest::BadCharPolicy::SKIPOVER, 16>> mods;
+		for (uint i = 0; i < test_strs.size(); i++) {
+			mods.emplace_back(test_strs[i], 16, 17);
+		}
+		multi_lane_comp<digest::BadCharPolicy::SKIPOVER>(mods, 7);
+	}
+}
+
+template <class D>
+std::vector<std::pair<uint32_t, uint32_t>> all_minimizers(D &dig) {
+	std::vector<std::pair<uint32_t, uint32_t>> vec;
+	dig.roll_minimizer(1e7, vec);
+	return vec;
+}
+
+template <digest::BadCharPolicy P>
+void packed_comp(const std::string &str, unsigned k, size_t start,
+				 digest::MinimizedHashType minimized_h) {
+	std::vector<uint8_t> packed;
+	digest::NIntervals n_intervals;
+	digest::pack_bases(str.c_str(), str.size(), packed, n_intervals);
+
+	digest::ModMin<P> mod1(str, k, 17, 0, start, minimized_h);
+	digest::ModMin<P> mod2(packed.data(), str.size(), n_intervals, k, 17, 0,
+						   start, minimized_h);
+	CHECK(mod1.get_is_valid_hash() == mod2.get_is_valid_hash());
+	CHECK(all_minimizers(mod1) == all_minimizers(mod2));
+
+	digest::WindowMin<P, digest::ds::Adaptive> wind1(str, k, 11, start,
+													 minimized_h);
+	digest::WindowMin<P, digest::ds::Adaptive> wind2(
+		packed.data(), str.size(), n_intervals, k, 11, start, minimized_h);
+	CHECK(all_minimizers(wind1) == all_minimizers(wind2));
+
+	digest::Syncmer<P, digest::ds::Adaptive> sync1(str, k, 11, start,
+												   minimized_h);
+	digest::Syncmer<P, digest::ds::Adaptive> sync2(
+		packed.data(), str.size(), n_intervals, k, 11, start, minimized_h);
+	CHECK(all_minimizers(sync1) == all_minimizers(sync2));
+
+	digest::ModMin<P> mod3(str, k, 17, 0, start, minimized_h);
+	digest::ModMin<P> mod4(packed.data(), str.size(), n_intervals, k, 17, 0,
+						   start, minimized_h);
+	roll_hashes_comp(mod3, mod4, 1000);
+}
+
+TEST_CASE("Packed Testing") {
+	setupStrings();
+
+	// long enough to be unpacked in several blocks, with N runs on and
+	// around the block boundaries
+	std::string big;
+	while (big.size() < 200000) {
+		for (auto &str : test_strs) {
+			big += str;
+		}
+	}
+	for (size_t i = 65436; i < 65636; i++) {
+		big[i] = 'N';
+	}
+	for (size_t i = 131069; i < 131074; i++) {
+		big[i] = 'N';
+	}
+	for (size_t i = 196608; i < 196700; i++) {
+		big[i] = 'N';
+	}
+
+	SECTION("Testing pack_bases() and unpack_bases()") {
+		std::vector<uint8_t> packed;
+		digest::NIntervals n_intervals;
+		digest::pack_bases(big.c_str(), big.size(), packed, n_intervals);
+		CHECK(packed.size() == (big.size() + 3) / 4);
+		for (size_t from : {0, 1, 2, 3, 65437, 131070}) {
+			for (size_t n : {0, 1, 5, 64, 70000}) {
+				n = std::min(n, big.size() - from);
+				std::string out(n, 0);
+				size_t interval = 0;
+				digest::unpack_bases(packed.data(), from, n, n_intervals,
+									 interval, &out[0]);
+				for (size_t i = 0; i < n; i++) {
+					char c = big[from + i];
+					c = c >= 'a' ? c - 'a' + 'A' : c;
+					c = c == 'A' || c == 'C' || c == 'G' || c == 'T' ? c : 'N';
+					CHECK(out[i] == c);
+				}
+			}
+		}
+	}
+
+	SECTION("Output matches the unpacked sequence") {
+		for (uint i = 0; i < test_strs.size(); i++) {
+			for (int j = 0; j < 8; j++) {
+				packed_comp<digest::BadCharPolicy::SKIPOVER>(
+					test_strs[i], ks[j], 0, digest::MinimizedHashType::CANON);
+				packed_comp<digest::BadCharPolicy::WRITEOVER>(
+					test_strs[i], ks[j], 3, digest::MinimizedHashType::FORWARD);
+			}
+		}
+		for (int j = 0; j < 8; j++) {
+			for (int l = 0; l < 3; l++) {
+				digest::MinimizedHashType minimized_h =
+					static_cast<digest::MinimizedHashType>(l);
+				packed_comp<digest::BadCharPolicy::SKIPOVER>(big, ks[j], 0,
+															 minimized_h);
+				packed_comp<digest::BadCharPolicy::WRITEOVER>(big, ks[j], 0,
+															  minimized_h);
+			}
+			packed_comp<digest::BadCharPolicy::SKIPOVER>(
+				big, ks[j], 65530, digest::MinimizedHashType::CANON);
+			packed_comp<digest::BadCharPolicy::WRITEOVER>(
+				big, ks[j], 131000, digest::MinimizedHashType::CANON);
+		}
+	}
+
+	SECTION("Testing append_seq()") {
+		size_t half = 131070;
+		std::string str1 = big.substr(0, half);
+		std::string str2 = big.substr(half);
+		std::vector<uint8_t> packed1, packed2;
+		digest::NIntervals n_intervals1, n_intervals2;
+		digest::pack_bases(str1.c_str(), str1.size(), packed1, n_intervals1);
+		digest::pack_bases(str2.c_str(), str2.size(), packed2, n_intervals2);
+		// blocks of packed1 are still to be unpacked
+		digest::ModMin<digest::BadCharPolicy::SKIPOVER> dig(
+			packed1.data(), str1.size(), n_intervals1, 16, 17);
+		CHECK_THROWS_AS(dig.append_seq(str2),
+						digest::NotRolledTillEndException);
+		CHECK_THROWS_AS(
+			dig.append_seq(packed2.data(), str2.size(), n_intervals2),
+			digest::NotRolledTillEndException);
+
+		for (int j = 0; j < 8; j++) {
+			digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+							  digest::ds::Adaptive>
+				whole(big, ks[j], 11);
+			std::vector<std::pair<uint32_t, uint32_t>> expected =
+				all_minimizers(whole);
+
+			// packed then packed
+			digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+							  digest::ds::Adaptive>
+				dig1(packed1.data(), str1.size(), n_intervals1, ks[j], 11);
+			std::vector<std::pair<uint32_t, uint32_t>> vec1 =
+				all_minimizers(dig1);
+			dig1.append_seq(packed2.data(), str2.size(), n_intervals2);
+			dig1.roll_minimizer(1e7, vec1);
+			CHECK(vec1 == expected);
+
+			// characters then packed
+			digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+							  digest::ds::Adaptive>
+				dig2(str1, ks[j], 11);
+			std::vector<std::pair<uint32_t, uint32_t>> vec2 =
+				all_minimizers(dig2);
+			dig2.append_seq(packed2.data(), str2.size(), n_intervals2);
+			dig2.roll_minimizer(1e7, vec2);
+			CHECK(vec2 == expected);
+
+			// packed then characters
+			digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+							  digest::ds::Adaptive>
+				dig3(packed1.data(), str1.size(), n_intervals1, ks[j], 11);
+			std::vector<std::pair<uint32_t, uint32_t>> vec3 =
+				all_minimizers(dig3);
+			dig3.append_seq(str2);
+			dig3.roll_minimizer(1e7, vec3);
+			CHECK(vec3 == expected);
+		}
+	}
+
+	SECTION("Copies unpack on their own") {
+		std::vector<uint8_t> packed;
+		digest::NIntervals n_intervals;
+		digest::pack_bases(big.c_str(), big.size(), packed, n_intervals);
+		digest::ModMin<digest::BadCharPolicy::SKIPOVER> whole(big, 16, 17);
+		std::vector<std::pair<uint32_t, uint32_t>> expected =
+			all_minimizers(whole);
+
+		digest::ModMin<digest::BadCharPolicy::SKIPOVER> dig1(
+			packed.data(), big.size(), n_intervals, 16, 17);
+		std::vector<std::pair<uint32_t, uint32_t>> vec1, vec2;
+		dig1.roll_minimizer(5000, vec1);
+		digest::ModMin<digest::BadCharPolicy::SKIPOVER> dig2(dig1);
+		vec2 = vec1;
+		dig1.roll_minimizer(1e7, vec1);
+		dig2.roll_minimizer(1e7, vec2);
+		CHECK(vec1 == expected);
+		CHECK(vec2 == expected);
+
+		std::vector<digest::ModMin<digest::BadCharPolicy::SKIPOVER>> digs;
+		for (int i = 0; i < 9; i++) {
+			digs.emplace_back(packed.data(), big.size(), n_intervals, 16, 17);
+		}
+		multi_lane_comp<digest::BadCharPolicy::SKIPOVER>(digs, 4096);
+	}
+}
+
+template <class D> void sink_comp(const D &dig) {
+	D dig1(dig), dig2(dig), dig3(dig), dig4(dig);
+	std::vector<uint32_t> vec1, sink1;
+	std::vector<std::pair<uint32_t, uint32_t>> vec2, sink2, sink3;
+	dig1.roll_minimizer(1e6, vec1);
+	dig1 = dig;
+	dig1.roll_minimizer(1e6, vec2);
+
+	// sink that only takes the position
+	size_t n = dig2.roll_minimizer(
+		1e6, [&sink1](uint32_t pos) { sink1.push_back(pos); });
+	CHECK(sink1 == vec1);
+	CHECK(n == vec1.size());
+	CHECK(dig2.get_is_valid_hash() == false);
+
+	// sink that takes the position and the hash
+	dig3.roll_minimizer(1e6, [&sink2](uint32_t pos, uint32_t hash) {
+		sink2.emplace_back(pos, hash);
+	});
+	CHECK(sink2 == vec2);
+
+	// sink that stops rolling every 3 minimizers, e.g. a full buffer
+	size_t count = 0;
+	auto stop = [&](uint32_t pos, uint32_t hash) {
+		sink3.emplace_back(pos, hash);
+		return ++count % 3 != 0;
+	};
+	while (dig4.roll_minimizer(1e6, stop) == 3) {
+	}
+	CHECK(sink3 == vec2);
+}
+
+TEST_CASE("Sink Testing") {
+	setupStrings();
+	SECTION("Output matches roll_minimizer() with a vector") {
+		for (uint i = 0; i < test_strs.size(); i++) {
+			for (int j = 0; j < 8; j += 3) {
+				for (int l = 0; l < 3; l++) {
+					digest::MinimizedHashType minimized_h =
+						static_cast<digest::MinimizedHashType>(l);
+					sink_comp(digest::ModMin<digest::BadCharPolicy::SKIPOVER>(
+						test_strs[i], ks[j], 17, 0, 0, minimized_h));
+					sink_comp(digest::ModMin<digest::BadCharPolicy::WRITEOVER>(
+						test_strs[i], ks[j], 17, 0, 0, minimized_h));
+					sink_comp(digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+												digest::ds::Adaptive>(
+						test_strs[i], ks[j], 11, 0, minimized_h));
+					sink_comp(digest::WindowMin<digest::BadCharPolicy::SKIPOVER,
+												digest::ds::SegmentTree<4>>(
+						test_strs[i], ks[j], 4, 0, minimized_h));
+					sink_comp(digest::Syncmer<digest::BadCharPolicy::SKIPOVER,
+											  digest::ds::Adaptive>(
+						test_strs[i], ks[j], 11, 0, minimized_h));
+					sink_comp(digest::Syncmer<digest::BadCharPolicy::WRITEOVER,
+											  digest::ds::Naive<6>>(
+						test_strs[i], ks[j], 6, 0, minimized_h));
+				}
+			}
+		}
+	}
+
+	SECTION("Amount") {
+		digest::WindowMin<digest::BadCharPolicy::SKIPOVER, digest::ds::Adaptive>
+			dig(test_strs[2], 16, 11);
+		std::vector<uint32_t> vec, sink;
+		digest::WindowMin<digest::BadCharPolicy::SKIPOVER, digest::ds::Adaptive>
+			copy(dig);
+		dig.roll_minimizer(20, vec);
+		CHECK(copy.roll_minimizer(
+				  20, [&sink](uint32_t pos) { sink.push_back(pos); }) == 20);
+		CHECK(sink == vec);
+		CHECK(copy.get_pos() == dig.get_pos());
+	}
+}
+
 // #include <iostream>
 //
 // template <int k>
@@ -1564,3 +2162,1655 @@ TEST_CASE("Syncmer Testing") {
 //     return 0;
 // }
 //
+
+// shifts every position of a digester by shift, as if shift bases had been
+// digested before its sequence, to test positions past 2^32 without a 4 Gbp
+// sequence
+template <class D> struct Shifted : D {
+	using D::D;
+	void shift(size_t shift) { this->offset += shift; }
+};
+
+template <class D> void wide_comp(const D &dig, size_t shift) {
+	D dig1(dig), dig2(dig), dig3(dig), dig4(dig);
+	std::vector<uint32_t> vec1;
+	std::vector<std::pair<uint32_t, uint32_t>> vec2;
+	std::vector<uint64_t> vec3;
+	std::vector<std::pair<uint64_t, uint64_t>> vec4;
+	dig1.roll_minimizer(1e6, vec1);
+	dig2.roll_minimizer(1e6, vec2);
+	dig3.shift(shift);
+	dig3.roll_minimizer(1e6, vec3);
+	dig4.shift(shift);
+	dig4.roll_minimizer(1e6, vec4);
+
+	REQUIRE(vec3.size() == vec1.size());
+	REQUIRE(vec4.size() == vec2.size());
+	for (size_t i = 0; i < vec1.size(); i++) {
+		CHECK(vec3[i] == vec1[i] + shift);
+		CHECK(vec4[i].first == vec2[i].first + shift);
+		CHECK((uint32_t)vec4[i].second == vec2[i].second);
+	}
+}
+
+// the vector versions of roll_minimizer() of ModMin fill the vector up to
+// amount, counting what is already in it, and dig does the same, e.g. a
+// BlockModMin
+template <class D, class R> void mod_amount_comp(const D &dig, const R &ref) {
+	D dig1(dig), dig2(dig), dig3(dig), dig4(dig);
+	R ref1(ref), ref2(ref), ref3(ref), ref4(ref);
+	std::vector<uint32_t> vec1(5), exp1(5);
+	std::vector<std::pair<uint32_t, uint32_t>> vec2(5), exp2(5);
+	std::vector<uint64_t> vec3(5), exp3(5);
+	std::vector<std::pair<uint64_t, uint64_t>> vec4(5), exp4(5);
+	for (unsigned amount = 8;; amount += 7) {
+		dig1.roll_minimizer(amount, vec1);
+		dig2.roll_minimizer(amount, vec2);
+		dig3.roll_minimizer(amount, vec3);
+		dig4.roll_minimizer(amount, vec4);
+		ref1.roll_minimizer(amount, exp1);
+		ref2.roll_minimizer(amount, exp2);
+		ref3.roll_minimizer(amount, exp3);
+		ref4.roll_minimizer(amount, exp4);
+		CHECK(exp1.size() <= amount);
+		REQUIRE(exp3.size() == exp1.size());
+		REQUIRE(exp4.size() == exp1.size());
+		if (exp1.size() < amount) {
+			break;
+		}
+	}
+	CHECK(vec1 == exp1);
+	CHECK(vec2 == exp2);
+	CHECK(vec3 == exp3);
+	CHECK(vec4 == exp4);
+	for (size_t i = 5; i < exp1.size(); i++) {
+		CHECK(exp3[i] == exp1[i]);
+		CHECK(exp4[i].first == exp2[i].first);
+		CHECK((uint32_t)exp4[i].second == exp2[i].second);
+	}
+
+	// with a full vector, one more k-mer is rolled
+	R full_ref1(ref), full_ref2(ref);
+	std::vector<uint64_t> full2(5);
+	std::vector<uint32_t> full3(5);
+	full_ref1.roll_minimizer(3, full2);
+	full_ref2.roll_minimizer(3, full3);
+	CHECK(full2.size() <= 6);
+	CHECK(full3.size() == full2.size());
+}
+
+TEST_CASE("64-bit Output Testing") {
+	setupStrings();
+	const digest::BadCharPolicy P = digest::BadCharPolicy::SKIPOVER;
+	size_t shifts[] = {0, (1ull << 32) - 7, 5ull << 32};
+	SECTION("Positions past 2^32") {
+		typedef Shifted<digest::ModMin<P>> Mod;
+		typedef Shifted<digest::WindowMin<P, digest::ds::Adaptive>> Wind;
+		typedef Shifted<digest::WindowMin<P, digest::ds::SegmentTree<4>>> Tree;
+		typedef Shifted<digest::Syncmer<P, digest::ds::Adaptive>> Sync;
+		typedef Shifted<digest::WindowMin<P, digest::ds::Adaptive64>> Wind64;
+		typedef Shifted<digest::Syncmer<P, digest::ds::Adaptive64>> Sync64;
+		typedef Shifted<digest::WindowMin<P, digest::ds::MonoQueue64<>>>
+			Queue64;
+		typedef Shifted<digest::WindowMin<P, digest::ds::SegmentTree64<>>>
+			Tree64;
+		for (size_t shift : shifts) {
+			// these strings have no ties within a window that could straddle
+			// a multiple of 2^32, see ds::Interface
+			for (int i = 2; i < 6; i++) {
+				for (int j = 0; j < 8; j += 3) {
+					wide_comp(Mod(test_strs[i], ks[j], 17), shift);
+					wide_comp(Wind(test_strs[i], ks[j], 11), shift);
+					wide_comp(Tree(test_strs[i], ks[j], 4), shift);
+					wide_comp(Sync(test_strs[i], ks[j], 11), shift);
+				}
+			}
+			// 64-bit indices break ties the same way past 2^32
+			for (uint i = 0; i < test_strs.size(); i++) {
+				for (unsigned w : {6u, 20u}) {
+					wide_comp(Wind64(test_strs[i], 16, w), shift);
+					wide_comp(Sync64(test_strs[i], 16, w), shift);
+					wide_comp(Queue64(test_strs[i], 16, w), shift);
+					wide_comp(Tree64(test_strs[i], 16, w), shift);
+				}
+			}
+		}
+	}
+
+	SECTION("ModMin counts what the vector already holds") {
+		for (uint i = 0; i < test_strs.size(); i++) {
+			for (uint32_t mod : {2u, 17u}) {
+				mod_amount_comp(digest::ModMin<P>(test_strs[i], 16, mod),
+								digest::ModMin<P>(test_strs[i], 16, mod));
+			}
+		}
+	}
+
+	SECTION("Full 64-bit hashes") {
+		for (uint i = 0; i < test_strs.size(); i++) {
+			std::string &str = test_strs[i];
+			digest::ModMin<P> mod(str, 16, 17);
+			std::vector<std::pair<uint64_t, uint64_t>> vec;
+			mod.roll_minimizer(1e6, vec);
+			for (auto &p : vec) {
+				nthash::NtHash tHash(str.substr(p.first, 16), 1, 16, 0);
+				tHash.roll();
+				CHECK(p.second == *tHash.hashes());
+			}
+
+			// Adaptive64 picks by the full hash
+			digest::WindowMin<P, digest::ds::Adaptive64> wind(str, 16, 20);
+			std::vector<std::pair<uint64_t, uint64_t>> wind_vec;
+			wind.roll_minimizer(1e6, wind_vec);
+			std::vector<uint64_t> hashes(str.size());
+			nthash::NtHash tHash(str, 1, 16, 0);
+			while (tHash.roll()) {
+				hashes[tHash.get_pos()] = *tHash.hashes();
+			}
+			for (auto &p : wind_vec) {
+				CHECK(p.second == hashes[p.first]);
+			}
+
+			// and so does MonoQueue64, for windows and syncmers
+			for (unsigned w : {4u, 20u, 50u, 200u}) {
+				std::vector<std::pair<uint64_t, uint64_t>> vec1, vec2, vec3,
+					vec4;
+				digest::WindowMin<P, digest::ds::Adaptive64> wind1(str, 16, w);
+				digest::WindowMin<P, digest::ds::MonoQueue64<>> wind2(str, 16,
+																	  w);
+				digest::Syncmer<P, digest::ds::Adaptive64> sync1(str, 16, w);
+				digest::Syncmer<P, digest::ds::MonoQueue64<>> sync2(str, 16,
+																	w);
+				wind1.roll_minimizer(1e6, vec1);
+				wind2.roll_minimizer(1e6, vec2);
+				sync1.roll_minimizer(1e6, vec3);
+				sync2.roll_minimizer(1e6, vec4);
+				CHECK(vec1 == vec2);
+				CHECK(vec3 == vec4);
+
+				// and SegmentTree64
+				std::vector<std::pair<uint64_t, uint64_t>> vec5, vec6;
+				digest::WindowMin<P, digest::ds::SegmentTree64<>> wind3(str, 16,
+																		w);
+				digest::Syncmer<P, digest::ds::SegmentTree64<>> sync3(str, 16,
+																	  w);
+				wind3.roll_minimizer(1e6, vec5);
+				sync3.roll_minimizer(1e6, vec6);
+				CHECK(vec1 == vec5);
+				CHECK(vec3 == vec6);
+
+				// and the structures with the large window at compile time
+				if (w == 20) {
+					typedef digest::ds::Naive<20, uint64_t> Naive64;
+					typedef digest::ds::Naive2<20, uint64_t> Naive2_64;
+					std::vector<std::pair<uint64_t, uint64_t>> vec7, vec8,
+						vec9, vec10;
+					digest::WindowMin<P, Naive64>(str, 16, w)
+						.roll_minimizer(1e6, vec7);
+					digest::WindowMin<P, Naive2_64>(str, 16, w)
+						.roll_minimizer(1e6, vec8);
+					digest::Syncmer<P, Naive64>(str, 16, w)
+						.roll_minimizer(1e6, vec9);
+					digest::Syncmer<P, Naive2_64>(str, 16, w)
+						.roll_minimizer(1e6, vec10);
+					CHECK(vec1 == vec7);
+					CHECK(vec1 == vec8);
+					CHECK(vec3 == vec9);
+					CHECK(vec3 == vec10);
+				}
+			}
+		}
+	}
+}
+
+// compares a data structure with 64-bit hashes or indices to R, by default
+// MonoQueue64, with the outputs of R cut to the widths of D
+template <class D, class R = digest::ds::MonoQueue64<>>
+void ds64_comp(uint32_t w) {
+	typedef decltype(std::declval<D &>().min()) I;
+	typedef decltype(std::declval<D &>().min_hash()) T;
+	// few distinct hashes, some of them above 2^32, so there are ties for the
+	// index to break, and indices past 2^32
+	std::mt19937_64 gen(13);
+	D ds(w);
+	R ref(w);
+	for (uint64_t j = 0; j < 5000; j++) {
+		uint64_t hash = gen() % 8 << (j & 1 ? 40 : 0);
+		uint64_t index = (5ull << 32) + j;
+		ds.insert(index, hash);
+		ref.insert(index, hash);
+		if (j + 1 < w) {
+			continue;
+		}
+		CHECK(ds.min() == (I)ref.min());
+		CHECK(ds.min_hash() == (T)ref.min_hash());
+		std::vector<std::pair<I, T>> vec1, vec2;
+		std::vector<std::pair<decltype(ref.min()), decltype(ref.min_hash())>>
+			found;
+		ds.min_syncmer(vec1);
+		ref.min_syncmer(found);
+		for (auto &p : found) {
+			vec2.emplace_back(p.first, p.second);
+		}
+		CHECK(vec1 == vec2);
+	}
+}
+
+TEST_CASE("64-bit Data Structure Testing") {
+	using namespace digest::ds;
+	// 32-bit hashes with 64-bit indices
+	typedef MonoQueue<0, uint32_t, uint64_t> Ref32;
+	for (uint32_t w : {1, 4, 13, 16, 33, 200}) {
+		ds64_comp<Adaptive64>(w);
+		ds64_comp<SegmentTree64<>>(w);
+		ds64_comp<SegmentTree<0, uint64_t, uint32_t>>(w);
+		ds64_comp<MonoQueue<0, uint64_t, uint32_t>>(w);
+		ds64_comp<SegmentTree<0, uint32_t, uint64_t>, Ref32>(w);
+	}
+	ds64_comp<SegmentTree64<1>>(1);
+	ds64_comp<SegmentTree64<13>>(13);
+	ds64_comp<SegmentTree64<16>>(16);
+
+	ds64_comp<Naive<1, uint64_t>>(1);
+	ds64_comp<Naive<13, uint64_t>>(13);
+	ds64_comp<Naive<13, uint64_t, uint32_t>>(13);
+	ds64_comp<Naive<13, uint32_t, uint64_t>, Ref32>(13);
+	ds64_comp<Naive2<1, uint64_t>>(1);
+	ds64_comp<Naive2<33, uint64_t>>(33);
+	ds64_comp<Naive2<33, uint64_t, uint32_t>>(33);
+	ds64_comp<Naive2<33, uint32_t, uint64_t>, Ref32>(33);
+	ds64_comp<MonoQueue<13, uint64_t, uint32_t>>(13);
+}
+
+template <class D> void static_comp(const D &dig, const std::string &next) {
+	digest::Static<D> stat(dig);
+	D copy(dig);
+	std::vector<uint32_t> vec1, vec2;
+	std::vector<std::pair<uint64_t, uint64_t>> vec3, vec4;
+	copy.roll_minimizer(1e6, vec1);
+	stat.roll_minimizer(1e6, vec2);
+	CHECK(vec1 == vec2);
+
+	// through the virtual base, as a type-erased digester
+	copy.new_seq(next, 0);
+	digest::Digester<digest::BadCharPolicy::SKIPOVER> &base = stat;
+	base.new_seq(next, 0);
+	copy.roll_minimizer(1e6, vec3);
+	base.roll_minimizer(1e6, vec4);
+	CHECK(vec3 == vec4);
+}
+
+TEST_CASE("Static Testing") {
+	setupStrings();
+	const digest::BadCharPolicy P = digest::BadCharPolicy::SKIPOVER;
+	typedef digest::WindowMin<P, digest::ds::Adaptive> Wind;
+	typedef digest::Syncmer<P, digest::ds::Adaptive> Sync;
+	for (uint i = 0; i < test_strs.size(); i++) {
+		std::string &next = test_strs[(i + 1) % test_strs.size()];
+		for (int j = 0; j < 8; j += 3) {
+			static_comp(digest::ModMin<P>(test_strs[i], ks[j], 17), next);
+			static_comp(Wind(test_strs[i], ks[j], 11), next);
+			static_comp(Sync(test_strs[i], ks[j], 11), next);
+		}
+	}
+
+	// the sink overloads are still there
+	digest::Static<Wind> dig(test_strs[2], 16, 11);
+	size_t n = 0;
+	dig.roll_minimizer(1e6, [&n](uint32_t) { n++; });
+	CHECK(n > 0);
+}
+
+void argmax_comp(std::vector<uint64_t> &arr, uint32_t n) {
+	uint32_t slot = digest::ds::max_slot_scalar(arr.data(), n);
+	CHECK(digest::ds::max_slot(arr.data(), n) == slot);
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+	(defined(__GNUC__) || defined(__clang__))
+	if (__builtin_cpu_supports("avx2")) {
+		CHECK(digest::ds::max_slot_avx2(arr.data(), n) == slot);
+	}
+	if (__builtin_cpu_supports("avx512f")) {
+		CHECK(digest::ds::max_slot_avx512(arr.data(), n) == slot);
+	}
+#endif
+}
+
+TEST_CASE("Argmax Kernel Testing") {
+	std::mt19937_64 gen(7);
+	for (uint32_t n = 1; n <= 70; n++) {
+		std::vector<uint64_t> arr(n);
+		for (int r = 0; r < 100; r++) {
+			// few distinct hashes, so there are ties for the index to break
+			for (uint32_t j = 0; j < n; j++) {
+				uint64_t hash = gen() % 4 + (r & 1 ? UINT32_MAX - 3 : 0);
+				uint64_t index = gen() % (2 * n);
+				arr[j] = hash << 32 | index;
+			}
+			argmax_comp(arr, n);
+		}
+	}
+}
+
+template <class T, class D, digest::BadCharPolicy P>
+void factory_comp(D &dig, const std::unique_ptr<digest::Digester<P>> &made) {
+	CHECK(dynamic_cast<T *>(made.get()) != nullptr);
+	std::vector<uint32_t> vec1, vec2;
+	dig.roll_minimizer(1e6, vec1);
+	made->roll_minimizer(1e6, vec2);
+	CHECK(vec1 == vec2);
+}
+
+TEST_CASE("Factory Testing") {
+	setupStrings();
+	const digest::BadCharPolicy P = digest::BadCharPolicy::SKIPOVER;
+	for (uint i = 0; i < test_strs.size(); i++) {
+		for (int j = 0; j < 8; j += 3) {
+#define TEST_FACTORY_MAX(T, w, M)                                              \
+	{                                                                          \
+		digest::WindowMin<P, digest::ds::Adaptive> wind(test_strs[i], ks[j],   \
+														w);                    \
+		digest::Syncmer<P, digest::ds::Adaptive> sync(test_strs[i], ks[j], w); \
+		factory_comp<digest::WindowMin<P, T>>(                                 \
+			wind,                                                              \
+			digest::factory::window_min<P, 0, M>(test_strs[i], ks[j], w));    \
+		factory_comp<digest::Syncmer<P, T>>(                                   \
+			sync, digest::factory::syncmer<P, 0, M>(test_strs[i], ks[j], w));  \
+	}
+#define TEST_FACTORY(T, w)                                                     \
+	TEST_FACTORY_MAX(T, w, digest::factory::MAX_TABLE_WINDOW)
+
+			TEST_FACTORY(digest::ds::Naive<1>, 1)
+			TEST_FACTORY(digest::ds::Naive<2>, 2)
+			TEST_FACTORY(digest::ds::Naive<3>, 3)
+			TEST_FACTORY(digest::ds::Naive<4>, 4)
+			TEST_FACTORY(digest::ds::Naive<11>, 11)
+			TEST_FACTORY(digest::ds::SegmentTree<12>, 12)
+			TEST_FACTORY(digest::ds::SegmentTree<16>, 16)
+			TEST_FACTORY(digest::ds::Naive2<17>, 17)
+			TEST_FACTORY(digest::ds::Naive2<64>, 64)
+			TEST_FACTORY(digest::ds::Adaptive, 65)
+			TEST_FACTORY(digest::ds::Adaptive, 100)
+
+			// a smaller table falls back to Adaptive above its largest window
+			TEST_FACTORY_MAX(digest::ds::Naive<3>, 3, 8)
+			TEST_FACTORY_MAX(digest::ds::Naive<8>, 8, 8)
+			TEST_FACTORY_MAX(digest::ds::Adaptive, 9, 8)
+			TEST_FACTORY_MAX(digest::ds::Adaptive, 16, 8)
+		}
+	}
+
+	CHECK_THROWS_AS(digest::factory::window_min<P>(test_strs[0], 4, 0),
+					digest::BadWindowSizeException);
+	CHECK_THROWS_AS(digest::factory::syncmer<P>(test_strs[0], 4, 0),
+					digest::BadWindowSizeException);
+	CHECK_THROWS_AS((digest::factory::window_min<P, 0, 8>(test_strs[0], 4, 0)),
+					digest::BadWindowSizeException);
+}
+
+TEST_CASE("Calibration Testing") {
+	setupStrings();
+	const digest::BadCharPolicy P = digest::BadCharPolicy::SKIPOVER;
+	// forces Naive, Naive2 and MonoQueue
+	const digest::ds::AdaptiveThresholds modes[] = {
+		{UINT32_MAX, UINT32_MAX}, {0, UINT32_MAX}, {0, 0}};
+	const digest::ds::AdaptiveThresholds defaults =
+		digest::ds::adaptive_thresholds();
+
+	SECTION("Strategies") {
+		for (const auto &mode : modes) {
+			digest::ds::adaptive_thresholds() = mode;
+			for (uint i = 0; i < test_strs.size(); i++) {
+				for (int j = 0; j < 8; j += 3) {
+					for (uint32_t w : {4, 15, 16, 40}) {
+						digest::WindowMin<P, digest::ds::Adaptive> wind(
+							test_strs[i], ks[j], w);
+						digest::WindowMin<P, digest::ds::MonoQueue<>> ref(
+							test_strs[i], ks[j], w);
+						std::vector<uint32_t> vec1, vec2;
+						wind.roll_minimizer(1e6, vec1);
+						ref.roll_minimizer(1e6, vec2);
+						CHECK(vec1 == vec2);
+
+						digest::Syncmer<P, digest::ds::Adaptive> sync(
+							test_strs[i], ks[j], w);
+						digest::Syncmer<P, digest::ds::MonoQueue<>> sync_ref(
+							test_strs[i], ks[j], w);
+						std::vector<std::pair<uint32_t, uint32_t>> pairs1,
+							pairs2;
+						sync.roll_minimizer(1e6, pairs1);
+						sync_ref.roll_minimizer(1e6, pairs2);
+						CHECK(pairs1 == pairs2);
+					}
+				}
+			}
+		}
+		digest::ds::adaptive_thresholds() = defaults;
+
+		// few distinct hashes, so there are ties for the index to break
+		std::mt19937 gen(3);
+		for (uint32_t w : {4, 13, 33}) {
+			for (const auto &mode : modes) {
+				digest::ds::Adaptive ds(w, mode);
+				digest::ds::MonoQueue<> ref(w);
+				for (uint32_t j = 0; j < 2000; j++) {
+					uint32_t hash = gen() % 8;
+					ds.insert(j, hash);
+					ref.insert(j, hash);
+					if (j + 1 < w) {
+						continue;
+					}
+					CHECK(ds.min() == ref.min());
+					CHECK(ds.min_hash() == ref.min_hash());
+					std::vector<uint32_t> vec1, vec2;
+					ds.min_syncmer(vec1);
+					ref.min_syncmer(vec2);
+					CHECK(vec1 == vec2);
+				}
+			}
+		}
+	}
+
+	SECTION("Calibrate") {
+		std::mt19937 gen(5);
+		std::vector<uint32_t> hashes(1 << 12);
+		for (uint32_t &hash : hashes) {
+			hash = gen();
+		}
+		digest::ds::Calibration cal =
+			digest::ds::calibrate(hashes, {4, 16, 64});
+		CHECK(cal.windows == std::vector<uint32_t>{4, 16, 64});
+		CHECK(cal.naive.size() == 3);
+		CHECK(cal.naive2.size() == 3);
+		CHECK(cal.mono.size() == 3);
+		CHECK(cal.thresholds.naive2_from <= 65);
+		CHECK((cal.thresholds.mono_from == UINT32_MAX ||
+			   cal.thresholds.mono_from == 4 ||
+			   cal.thresholds.mono_from == 16 ||
+			   cal.thresholds.mono_from == 64));
+
+		digest::ds::Calibration parsed;
+		CHECK(parsed.from_string(cal.to_string()));
+		CHECK(parsed.to_string() == cal.to_string());
+		CHECK(parsed.windows == cal.windows);
+		CHECK(parsed.thresholds.naive2_from == cal.thresholds.naive2_from);
+		CHECK(parsed.thresholds.mono_from == cal.thresholds.mono_from);
+		CHECK_FALSE(parsed.from_string("not a calibration"));
+		CHECK(parsed.windows == cal.windows);
+
+		// configure_adaptive reads a cached calibration instead of measuring
+		cal.thresholds = {20, 50};
+		const char *path = "calibration_test.txt";
+		std::ofstream(path) << cal.to_string();
+		digest::ds::Calibration cached = digest::ds::configure_adaptive(path);
+		CHECK(cached.to_string() == cal.to_string());
+		CHECK(digest::ds::adaptive_thresholds().naive2_from == 20);
+		CHECK(digest::ds::adaptive_thresholds().mono_from == 50);
+		CHECK(digest::ds::Adaptive(19).mode ==
+			  digest::ds::Adaptive::Mode::NAIVE);
+		CHECK(digest::ds::Adaptive(20).mode ==
+			  digest::ds::Adaptive::Mode::NAIVE2);
+		CHECK(digest::ds::Adaptive(50).mode ==
+			  digest::ds::Adaptive::Mode::MONO);
+		std::remove(path);
+		digest::ds::adaptive_thresholds() = defaults;
+	}
+}
+
+// sized: amount is the size the vector may reach, as for ModMin, instead of
+// the number of minimizers added by the call
+template <class D, class R>
+void block_comp(const D &dig, const R &ref, bool sized = false) {
+	D dig1(dig), dig2(dig), dig3(dig);
+	R ref1(ref), ref2(ref);
+	std::vector<uint32_t> vec1, vec2;
+	std::vector<std::pair<uint32_t, uint32_t>> pairs1, pairs2;
+	dig1.roll_minimizer(1e6, vec1);
+	ref1.roll_minimizer(1e6, vec2);
+	CHECK(vec1 == vec2);
+	dig2.roll_minimizer(1e6, pairs1);
+	ref2.roll_minimizer(1e6, pairs2);
+	CHECK(pairs1 == pairs2);
+
+	// a few minimizers at a time, stopping in the middle of a block
+	std::vector<uint32_t> vec3;
+	size_t before;
+	do {
+		before = vec3.size();
+		dig3.roll_minimizer(sized ? before + 7 : 7, vec3);
+		CHECK(vec3.size() - before <= 7);
+	} while (vec3.size() != before);
+	CHECK(vec3 == vec2);
+}
+
+TEST_CASE("Block Window Minimizer Testing") {
+	setupStrings();
+	const digest::BadCharPolicy S = digest::BadCharPolicy::SKIPOVER;
+	const digest::BadCharPolicy W = digest::BadCharPolicy::WRITEOVER;
+
+	SECTION("Output matches WindowMin with Adaptive") {
+		for (uint i = 0; i < test_strs.size(); i++) {
+			for (int j = 0; j < 8; j += 3) {
+				for (unsigned w : {1u, 4u, 11u, 16u, 17u, 64u, 5000u}) {
+					for (int l = 0; l < 3; l++) {
+						digest::MinimizedHashType minimized_h =
+							static_cast<digest::MinimizedHashType>(l);
+						block_comp(digest::BlockWindowMin<S>(
+									   test_strs[i], ks[j], w, 0, minimized_h),
+								   digest::WindowMin<S, digest::ds::Adaptive>(
+									   test_strs[i], ks[j], w, 0, minimized_h));
+						block_comp(digest::BlockWindowMin<W>(
+									   test_strs[i], ks[j], w, 0, minimized_h),
+								   digest::WindowMin<W, digest::ds::Adaptive>(
+									   test_strs[i], ks[j], w, 0, minimized_h));
+					}
+					sink_comp(
+						digest::BlockWindowMin<S>(test_strs[i], ks[j], w));
+				}
+			}
+		}
+	}
+
+	SECTION("Appended sequences and new_seq") {
+		for (uint i = 0; i + 1 < test_strs.size(); i++) {
+			for (unsigned w : {4u, 17u}) {
+				digest::BlockWindowMin<S> dig(test_strs[i], 16, w);
+				digest::WindowMin<S, digest::ds::Adaptive> ref(test_strs[i], 16,
+															   w);
+				std::vector<uint32_t> vec1, vec2;
+				dig.roll_minimizer(1e6, vec1);
+				ref.roll_minimizer(1e6, vec2);
+				dig.append_seq(test_strs[i + 1]);
+				ref.append_seq(test_strs[i + 1]);
+				dig.roll_minimizer(1e6, vec1);
+				ref.roll_minimizer(1e6, vec2);
+				CHECK(vec1 == vec2);
+
+				dig.new_seq(test_strs[i + 1], 0);
+				digest::WindowMin<S, digest::ds::Adaptive> fresh(
+					test_strs[i + 1], 16, w);
+				vec1.clear(), vec2.clear();
+				dig.roll_minimizer(1e6, vec1);
+				fresh.roll_minimizer(1e6, vec2);
+				CHECK(vec1 == vec2);
+			}
+		}
+	}
+
+	SECTION("Sequences of several blocks") {
+		// random bases with a few runs of N and long repeats, so large
+		// windows span blocks and the minimum often leaves the window
+		std::mt19937 gen(11);
+		std::string str;
+		while (str.size() < 5 * digest::BlockWindowMin<S>::BLOCK) {
+			uint32_t r = gen() % 100;
+			if (r == 0) {
+				str.append(gen() % 50, 'N');
+			} else if (r == 1 && str.size() > 300) {
+				str.append(str, str.size() - 300, 300);
+			} else {
+				str.push_back("ACGT"[gen() % 4]);
+			}
+		}
+		for (unsigned w : {1u, 5u, 16u, 100u, 4095u, 4096u, 4097u, 9000u}) {
+			block_comp(digest::BlockWindowMin<S>(str, 16, w),
+					   digest::WindowMin<S, digest::ds::Adaptive>(str, 16, w));
+			block_comp(digest::BlockWindowMin<W>(str, 16, w),
+					   digest::WindowMin<W, digest::ds::Adaptive>(str, 16, w));
+		}
+	}
+
+	SECTION("Positions past 2^32") {
+		for (size_t shift : {(1ull << 32) - 7, 5ull << 32}) {
+			for (int i = 2; i < 6; i++) {
+				wide_comp(Shifted<digest::BlockWindowMin<S>>(test_strs[i], 16,
+															 11),
+						  shift);
+			}
+		}
+	}
+
+	CHECK_THROWS_AS(digest::BlockWindowMin<S>(test_strs[0], 4, 0),
+					digest::BadWindowSizeException);
+}
+
+// compares the minima reported by insert_many() to the ones found by
+// inserting one k-mer at a time, in blocks of random sizes
+template <class D> void insert_many_comp(uint32_t w) {
+	typedef std::tuple<size_t, uint64_t, uint64_t> Report;
+	std::mt19937 gen(17);
+	std::vector<uint32_t> indices(3000);
+	std::vector<uint64_t> hashes(indices.size());
+	for (size_t j = 0; j < indices.size(); j++) {
+		indices[j] = j;
+		// few distinct hashes, so there are ties for the index to break, and
+		// long runs of increasing hashes, so the minimum often leaves
+		hashes[j] = j % 500 < 250 ? gen() % 8 : j;
+	}
+
+	D ref(w);
+	std::vector<Report> vec1, vec2;
+	uint64_t prev = ref.min();
+	for (size_t j = 0; j < indices.size(); j++) {
+		ref.insert(indices[j], hashes[j]);
+		if (ref.min() != prev) {
+			prev = ref.min();
+			vec1.emplace_back(j, ref.min(), ref.min_hash());
+		}
+	}
+
+	D ds(w);
+	size_t j = 0;
+	while (j < indices.size()) {
+		size_t n = std::min<size_t>(gen() % 200, indices.size() - j);
+		ds.insert_many(indices.data() + j, hashes.data() + j, n,
+					   [&](size_t l, uint64_t index, uint64_t hash) {
+						   vec2.emplace_back(j + l, index, hash);
+					   });
+		j += n;
+	}
+	CHECK(vec1 == vec2);
+	CHECK(ds.min() == ref.min());
+	CHECK(ds.min_hash() == ref.min_hash());
+}
+
+template <class D> void select_comp() {
+	std::vector<digest::WindowMin<digest::BadCharPolicy::SKIPOVER, D>> winds;
+	std::vector<digest::Syncmer<digest::BadCharPolicy::SKIPOVER, D>> syncs;
+	for (uint i = 0; i < test_strs.size(); i++) {
+		winds.emplace_back(test_strs[i], 8, 11);
+		syncs.emplace_back(test_strs[i], 8, 11);
+	}
+	for (size_t block : {7, 4096}) {
+		multi_lane_comp<digest::BadCharPolicy::SKIPOVER>(winds, block);
+		multi_lane_comp<digest::BadCharPolicy::SKIPOVER>(syncs, block);
+	}
+}
+
+TEST_CASE("Batch Insert Testing") {
+	SECTION("insert_many() matches insert()") {
+		for (uint32_t w : {1, 4, 11, 16, 33, 200}) {
+			insert_many_comp<digest::ds::SegmentTree<>>(w);
+			insert_many_comp<digest::ds::SegmentTree64<>>(w);
+			insert_many_comp<digest::ds::MonoQueue<>>(w);
+			insert_many_comp<digest::ds::MonoQueue64<>>(w);
+			insert_many_comp<digest::ds::Adaptive64>(w);
+			for (digest::ds::AdaptiveThresholds thresholds :
+				 {digest::ds::AdaptiveThresholds{UINT32_MAX, UINT32_MAX},
+				  digest::ds::AdaptiveThresholds{0, UINT32_MAX},
+				  digest::ds::AdaptiveThresholds{0, 0}}) {
+				digest::ds::AdaptiveThresholds saved =
+					digest::ds::adaptive_thresholds();
+				digest::ds::adaptive_thresholds() = thresholds;
+				insert_many_comp<digest::ds::Adaptive>(w);
+				digest::ds::adaptive_thresholds() = saved;
+			}
+		}
+		insert_many_comp<digest::ds::Naive<1>>(1);
+		insert_many_comp<digest::ds::Naive<11>>(11);
+		insert_many_comp<digest::ds::Naive2<11>>(11);
+		insert_many_comp<digest::ds::Naive2<33>>(33);
+		insert_many_comp<digest::ds::SegmentTree<11>>(11);
+		insert_many_comp<digest::ds::MonoQueue<11>>(11);
+		insert_many_comp<digest::ds::Naive<11, uint64_t>>(11);
+		insert_many_comp<digest::ds::Naive2<33, uint64_t, uint32_t>>(33);
+	}
+
+	SECTION("select_minimizers() matches roll_minimizer()") {
+		setupStrings();
+		select_comp<digest::ds::Naive<11>>();
+		select_comp<digest::ds::Naive2<11>>();
+		select_comp<digest::ds::SegmentTree<11>>();
+		select_comp<digest::ds::SegmentTree<>>();
+		select_comp<digest::ds::MonoQueue<>>();
+		select_comp<digest::ds::Adaptive>();
+		select_comp<digest::ds::Adaptive64>();
+		select_comp<digest::ds::MonoQueue64<>>();
+	}
+}
+
+// 3000 random bases with runs of N
+std::string with_n_runs(unsigned seed) {
+	std::mt19937 gen(seed);
+	std::string str;
+	while (str.size() < 3000) {
+		if (gen() % 60 == 0) {
+			str.append(gen() % 20, 'N');
+		} else {
+			str.push_back("ACGT"[gen() % 4]);
+		}
+	}
+	return str;
+}
+
+// the selected hash of every k-mer of str by its position, from a ModMin that
+// keeps all of them
+template <digest::BadCharPolicy P>
+std::map<size_t, uint64_t>
+hashes_by_pos(const std::string &str, unsigned k,
+			  digest::MinimizedHashType minimized_h) {
+	std::map<size_t, uint64_t> hashes;
+	digest::ModMin<P> dig(str, k, 1, 0, 0, minimized_h);
+	std::vector<std::pair<uint64_t, uint64_t>> vec;
+	dig.roll_minimizer(1e7, vec);
+	for (auto &p : vec) {
+		hashes[p.first] = p.second;
+	}
+	return hashes;
+}
+
+// compares a SmerSyncmer to finding the minimal s-mer of every k-mer by
+// brute force
+template <digest::BadCharPolicy P, class D>
+void smer_comp(D &dig, const std::string &str, unsigned k, unsigned s,
+			   const std::vector<unsigned> &offsets,
+			   digest::MinimizedHashType minimized_h) {
+	std::map<size_t, uint64_t> kmers = hashes_by_pos<P>(str, k, minimized_h);
+	std::map<size_t, uint64_t> smers = hashes_by_pos<P>(str, s, minimized_h);
+	std::vector<std::pair<uint64_t, uint64_t>> expected, vec;
+	for (auto &kmer : kmers) {
+		// the ds compares the lower 32 bits, ties go to the rightmost s-mer
+		unsigned best = 0;
+		for (unsigned j = 1; j <= k - s; j++) {
+			if ((uint32_t)smers.at(kmer.first + j) <=
+				(uint32_t)smers.at(kmer.first + best)) {
+				best = j;
+			}
+		}
+		if (std::find(offsets.begin(), offsets.end(), best) != offsets.end()) {
+			expected.emplace_back(kmer.first, kmer.second);
+		}
+	}
+	dig.roll_minimizer(1e7, vec);
+	CHECK(vec == expected);
+}
+
+TEST_CASE("Smer Syncmer Testing") {
+	setupStrings();
+	const digest::BadCharPolicy S = digest::BadCharPolicy::SKIPOVER;
+	const digest::BadCharPolicy W = digest::BadCharPolicy::WRITEOVER;
+	// s-mers are skipped in the middle of the runs of N
+	std::vector<std::string> strs(test_strs);
+	strs.push_back(with_n_runs(5));
+
+	SECTION("Closed, open and parameterized syncmers") {
+		for (auto &str : strs) {
+			for (unsigned k : {8u, 16u, 25u}) {
+				for (unsigned s : {4u, 5u, 8u}) {
+					std::vector<std::vector<unsigned>> sets = {
+						digest::closed_offsets(k, s), digest::open_offsets(0),
+						digest::open_offsets((k - s) / 2)};
+					if (k - s >= 2) {
+						sets.push_back({1, 2, k - s});
+					}
+					for (auto &offsets : sets) {
+						for (int l = 0; l < 3; l++) {
+							auto minimized_h =
+								static_cast<digest::MinimizedHashType>(l);
+							digest::SmerSyncmer<S> dig(str, k, s, offsets, 0,
+													   minimized_h);
+							smer_comp<S>(dig, str, k, s, offsets, minimized_h);
+						}
+						digest::SmerSyncmer<W> dig(str, k, s, offsets);
+						smer_comp<W>(dig, str, k, s, offsets,
+									 digest::MinimizedHashType::CANON);
+					}
+				}
+			}
+		}
+	}
+
+	SECTION("Other data structures, and k known at compile time") {
+		for (auto &str : strs) {
+			auto offsets = digest::closed_offsets(16, 5);
+			std::vector<uint32_t> vec1, vec2, vec3, vec4;
+			digest::SmerSyncmer<S>(str, 16, 5, offsets)
+				.roll_minimizer(1e7, vec1);
+			digest::SmerSyncmer<S, digest::ds::Naive<12>>(str, 16, 5, offsets)
+				.roll_minimizer(1e7, vec2);
+			digest::SmerSyncmer<S, digest::ds::Adaptive>(str, 16, 5, offsets)
+				.roll_minimizer(1e7, vec3);
+			digest::SmerSyncmer<S, digest::ds::MonoQueue<>, 16>(str, 16, 5,
+																offsets)
+				.roll_minimizer(1e7, vec4);
+			CHECK(vec1 == vec2);
+			CHECK(vec1 == vec3);
+			CHECK(vec1 == vec4);
+		}
+	}
+
+	SECTION("Rolling in pieces, append_seq() and new_seq()") {
+		auto offsets = digest::closed_offsets(15, 5);
+		for (size_t i = 0; i + 1 < strs.size(); i++) {
+			std::string whole = strs[i] + strs[i + 1];
+			digest::SmerSyncmer<S> ref(whole, 15, 5, offsets);
+			std::vector<uint64_t> vec1, vec2;
+			ref.roll_minimizer(1e7, vec1);
+
+			digest::SmerSyncmer<S> dig(strs[i], 15, 5, offsets);
+			while (dig.get_is_valid_hash()) {
+				dig.roll_minimizer(3, vec2);
+			}
+			dig.append_seq(strs[i + 1]);
+			dig.roll_minimizer(1e7, vec2);
+			CHECK(vec1 == vec2);
+
+			dig.new_seq(whole, 0);
+			vec2.clear();
+			dig.roll_minimizer(1e7, vec2);
+			CHECK(vec1 == vec2);
+		}
+	}
+
+	SECTION("Packed sequences") {
+		auto offsets = digest::open_offsets(3);
+		for (auto &str : strs) {
+			std::vector<uint8_t> packed;
+			digest::NIntervals n_intervals;
+			digest::pack_bases(str.c_str(), str.size(), packed, n_intervals);
+			digest::SmerSyncmer<S> dig1(str, 16, 7, offsets);
+			digest::SmerSyncmer<S> dig2(packed.data(), str.size(), n_intervals,
+										16, 7, offsets);
+			std::vector<uint32_t> vec1, vec2;
+			dig1.roll_minimizer(1e7, vec1);
+			dig2.roll_minimizer(1e7, vec2);
+			CHECK(vec1 == vec2);
+		}
+	}
+
+	CHECK_THROWS_AS(digest::SmerSyncmer<S>(test_strs[0], 8, 9, {0}),
+					digest::BadSmerException);
+	CHECK_THROWS_AS(digest::SmerSyncmer<S>(test_strs[0], 8, 5, {4}),
+					digest::BadSmerException);
+	CHECK_THROWS_AS(digest::SmerSyncmer<S>(test_strs[0], 8, 3, {0}),
+					digest::BadConstructionException);
+}
+
+// compares a ModMinimizer to finding the minimal t-mer of every large window
+// by brute force
+template <digest::BadCharPolicy P, class D>
+void modmin_comp(D &dig, const std::string &str, unsigned k, unsigned w,
+				 digest::MinimizedHashType minimized_h) {
+	unsigned t = k < 4 ? k : 4 + (k - 4) % w;
+	REQUIRE(dig.get_t() == t);
+	std::map<size_t, uint64_t> kmers = hashes_by_pos<P>(str, k, minimized_h);
+	std::map<size_t, uint64_t> tmers = hashes_by_pos<P>(str, t, minimized_h);
+	std::vector<std::pair<uint64_t, uint64_t>> expected, vec;
+	for (auto &kmer : kmers) {
+		size_t i = kmer.first;
+		// only large windows without a skipped character pick a k-mer
+		bool consecutive = true;
+		for (size_t j = i; j < i + w + k - t; j++) {
+			consecutive = consecutive and tmers.count(j);
+		}
+		if (!consecutive) {
+			continue;
+		}
+		// the ds compares the lower 32 bits, ties go to the rightmost t-mer
+		size_t best = i;
+		for (size_t j = i + 1; j < i + w + k - t; j++) {
+			if ((uint32_t)tmers.at(j) <= (uint32_t)tmers.at(best)) {
+				best = j;
+			}
+		}
+		size_t pos = i + (best - i) % w;
+		if (expected.empty() or expected.back().first != pos) {
+			expected.emplace_back(pos, kmers.at(pos));
+		}
+	}
+	dig.roll_minimizer(1e7, vec);
+	CHECK(vec == expected);
+}
+
+TEST_CASE("Mod Minimizer Testing") {
+	setupStrings();
+	const digest::BadCharPolicy S = digest::BadCharPolicy::SKIPOVER;
+	const digest::BadCharPolicy W = digest::BadCharPolicy::WRITEOVER;
+	std::vector<std::string> strs(test_strs);
+	strs.push_back(with_n_runs(7));
+
+	SECTION("Against brute force") {
+		for (auto &str : strs) {
+			for (unsigned k : {4u, 8u, 15u, 31u}) {
+				for (unsigned w : {1u, 5u, 11u, 16u}) {
+					for (int l = 0; l < 3; l++) {
+						auto minimized_h =
+							static_cast<digest::MinimizedHashType>(l);
+						digest::ModMinimizer<S, digest::ds::Adaptive> dig(
+							str, k, w, 0, minimized_h);
+						modmin_comp<S>(dig, str, k, w, minimized_h);
+					}
+					digest::ModMinimizer<W, digest::ds::Adaptive> dig(str, k,
+																	  w);
+					modmin_comp<W>(dig, str, k, w,
+								   digest::MinimizedHashType::CANON);
+				}
+			}
+		}
+	}
+
+	SECTION("Other data structures, and k known at compile time") {
+		for (auto &str : strs) {
+			std::vector<uint32_t> vec1, vec2, vec3, vec4;
+			digest::ModMinimizer<S, digest::ds::Adaptive>(str, 31, 11)
+				.roll_minimizer(1e7, vec1);
+			digest::ModMinimizer<S, digest::ds::MonoQueue<>>(str, 31, 11)
+				.roll_minimizer(1e7, vec2);
+			digest::ModMinimizer<S, digest::ds::SegmentTree<>>(str, 31, 11)
+				.roll_minimizer(1e7, vec3);
+			digest::ModMinimizer<S, digest::ds::Adaptive, 31>(str, 31, 11)
+				.roll_minimizer(1e7, vec4);
+			CHECK(vec1 == vec2);
+			CHECK(vec1 == vec3);
+			CHECK(vec1 == vec4);
+		}
+	}
+
+	SECTION("Rolling in pieces, append_seq() and new_seq()") {
+		for (size_t i = 0; i + 1 < strs.size(); i++) {
+			std::string whole = strs[i] + strs[i + 1];
+			digest::ModMinimizer<S, digest::ds::Adaptive> ref(whole, 15, 8);
+			std::vector<uint64_t> vec1, vec2;
+			ref.roll_minimizer(1e7, vec1);
+
+			digest::ModMinimizer<S, digest::ds::Adaptive> dig(strs[i], 15, 8);
+			while (dig.get_is_valid_hash()) {
+				dig.roll_minimizer(3, vec2);
+			}
+			dig.append_seq(strs[i + 1]);
+			dig.roll_minimizer(1e7, vec2);
+			CHECK(vec1 == vec2);
+
+			dig.new_seq(whole, 0);
+			vec2.clear();
+			dig.roll_minimizer(1e7, vec2);
+			CHECK(vec1 == vec2);
+		}
+	}
+
+	SECTION("Packed sequences") {
+		for (auto &str : strs) {
+			std::vector<uint8_t> packed;
+			digest::NIntervals n_intervals;
+			digest::pack_bases(str.c_str(), str.size(), packed, n_intervals);
+			digest::ModMinimizer<S, digest::ds::Adaptive> dig1(str, 21, 10);
+			digest::ModMinimizer<S, digest::ds::Adaptive> dig2(
+				packed.data(), str.size(), n_intervals, 21, 10);
+			std::vector<uint32_t> vec1, vec2;
+			dig1.roll_minimizer(1e7, vec1);
+			dig2.roll_minimizer(1e7, vec2);
+			CHECK(vec1 == vec2);
+		}
+	}
+
+	SECTION("Density") {
+		// the t-mers of random bases pick every k-mer with about the same
+		// probability, so the density is close to 1 / w for large k, below
+		// the 2 / (w + 1) of window minimizers
+		std::mt19937 gen(11);
+		std::string str;
+		for (int i = 0; i < 200000; i++) {
+			str.push_back("ACGT"[gen() % 4]);
+		}
+		std::vector<uint32_t> mod, wind;
+		digest::ModMinimizer<S, digest::ds::Adaptive>(str, 31, 10)
+			.roll_minimizer(1e7, mod);
+		digest::WindowMin<S, digest::ds::Adaptive>(str, 31, 10)
+			.roll_minimizer(1e7, wind);
+		double kmers = str.size() - 31 + 1;
+		CHECK(mod.size() / kmers < 0.13);
+		CHECK(wind.size() / kmers > 0.17);
+	}
+
+	CHECK_THROWS_AS(
+		(digest::ModMinimizer<S, digest::ds::Adaptive>(test_strs[0], 8, 0)),
+		digest::BadWindowSizeException);
+	// t = 3 + (8 - 3) % 5 = 3
+	CHECK_THROWS_AS((digest::ModMinimizer<S, digest::ds::Adaptive>(
+						test_strs[0], 8, 5, 0,
+						digest::MinimizedHashType::CANON, 3)),
+					digest::BadConstructionException);
+}
+
+// the rank of the k-mer at pos under order::Miniception, from the hashes of
+// all c-mers of the sequence by position
+unsigned miniception_rank(const std::map<size_t, uint64_t> &cmers, size_t pos,
+						  unsigned k, unsigned c) {
+	uint32_t min = UINT32_MAX;
+	for (size_t j = pos; j <= pos + k - c; j++) {
+		min = std::min(min, (uint32_t)cmers.at(j));
+	}
+	bool closed = min == (uint32_t)cmers.at(pos) or
+				  min == (uint32_t)cmers.at(pos + k - c);
+	return closed ? 0 : 1;
+}
+
+// the rank of kmer under order::Decycling, from its weight and the weight of
+// its rotation by one
+unsigned decycling_rank(const std::string &kmer, bool dbl) {
+	const double pi = std::acos(-1.0);
+	double k = kmer.size(), im = 0, rot = 0;
+	for (size_t i = 0; i < kmer.size(); i++) {
+		double x = (kmer[i] >> 1) & 3;
+		im += x * std::sin(2 * pi * i / k);
+		rot += x * std::sin(2 * pi * (i - 1.0) / k);
+	}
+	if (im > 1e-9 and rot <= 1e-9) {
+		return 0;
+	}
+	if (dbl and im < -1e-9 and rot >= -1e-9) {
+		return 1;
+	}
+	return dbl ? 2 : 1;
+}
+
+// compares a WindowMin and a Syncmer with an order to the windows of keys, the
+// keys of the k-mers at positions found by brute force
+template <class D, class Sync>
+void order_comp(const std::string &str, unsigned k, unsigned w,
+				digest::MinimizedHashType minimized_h,
+				const std::vector<size_t> &positions,
+				const std::vector<uint64_t> &keys) {
+	std::vector<std::pair<uint32_t, uint32_t>> wind, sync, vec;
+	size_t prev = SIZE_MAX;
+	for (size_t i = 0; i + w <= keys.size(); i++) {
+		// the ds compares the lower 32 bits, ties go to the rightmost k-mer
+		size_t best = i;
+		for (size_t j = i + 1; j < i + w; j++) {
+			if ((uint32_t)keys[j] <= (uint32_t)keys[best]) {
+				best = j;
+			}
+		}
+		uint32_t min = keys[best];
+		if (best != prev) {
+			wind.emplace_back(positions[best], min);
+			prev = best;
+		}
+		if (min == (uint32_t)keys[i] or min == (uint32_t)keys[i + w - 1]) {
+			sync.emplace_back(positions[i], min);
+		}
+	}
+	D(str, k, w, 0, minimized_h).roll_minimizer(1e7, vec);
+	CHECK(vec == wind);
+	vec.clear();
+	Sync(str, k, w, 0, minimized_h).roll_minimizer(1e7, vec);
+	CHECK(vec == sync);
+}
+
+// the keys of every k-mer of str under Miniception and both decycling orders
+// by brute force, then compared to the schemes with those orders
+template <digest::BadCharPolicy P>
+void orders_comp(const std::string &str, unsigned k,
+				 digest::MinimizedHashType minimized_h) {
+	typedef digest::ds::Adaptive A;
+	using digest::order::ranked;
+	std::map<size_t, uint64_t> kmers = hashes_by_pos<P>(str, k, minimized_h);
+	std::vector<size_t> positions;
+	std::vector<uint64_t> dec, dec2;
+	for (auto &kmer : kmers) {
+		// WRITEOVER hashes non-ACTG characters as A
+		std::string chars = str.substr(kmer.first, k);
+		for (char &ch : chars) {
+			if (std::string("ACGTacgt").find(ch) == std::string::npos) {
+				ch = 'A';
+			}
+		}
+		positions.push_back(kmer.first);
+		dec.push_back(ranked(kmer.second, decycling_rank(chars, false), 1));
+		dec2.push_back(ranked(kmer.second, decycling_rank(chars, true), 2));
+	}
+	for (unsigned w : {1u, 7u, 16u}) {
+		// the default length of the c-mers, and a fixed one
+		unsigned c = std::min(k >= w + 4 ? k - w : 4, k);
+		std::map<size_t, uint64_t> cmers =
+			hashes_by_pos<P>(str, c, minimized_h);
+		std::map<size_t, uint64_t> cmers5 =
+			hashes_by_pos<P>(str, std::min(5u, k), minimized_h);
+		std::vector<uint64_t> mini, mini5;
+		for (auto &kmer : kmers) {
+			mini.push_back(ranked(
+				kmer.second, miniception_rank(cmers, kmer.first, k, c), 1));
+			mini5.push_back(ranked(
+				kmer.second,
+				miniception_rank(cmers5, kmer.first, k, std::min(5u, k)), 1));
+		}
+		order_comp<digest::WindowMin<P, A, 0, digest::order::Miniception<>>,
+				   digest::Syncmer<P, A, 0, digest::order::Miniception<>>>(
+			str, k, w, minimized_h, positions, mini);
+		order_comp<digest::WindowMin<P, A, 0, digest::order::Miniception<5>>,
+				   digest::Syncmer<P, A, 0, digest::order::Miniception<5>>>(
+			str, k, w, minimized_h, positions, mini5);
+		order_comp<digest::WindowMin<P, A, 0, digest::order::Decycling<false>>,
+				   digest::Syncmer<P, A, 0, digest::order::Decycling<false>>>(
+			str, k, w, minimized_h, positions, dec);
+		order_comp<digest::WindowMin<P, A, 0, digest::order::Decycling<>>,
+				   digest::Syncmer<P, A, 0, digest::order::Decycling<>>>(
+			str, k, w, minimized_h, positions, dec2);
+	}
+}
+
+TEST_CASE("Order Testing") {
+	setupStrings();
+	const digest::BadCharPolicy S = digest::BadCharPolicy::SKIPOVER;
+	const digest::BadCharPolicy W = digest::BadCharPolicy::WRITEOVER;
+	typedef digest::order::Miniception<> Mini;
+	typedef digest::order::Decycling<> Dec;
+	std::vector<std::string> strs(test_strs);
+	strs.push_back(with_n_runs(9));
+
+	SECTION("Against brute force") {
+		for (auto &str : strs) {
+			for (unsigned k : {4u, 8u, 15u, 31u}) {
+				for (int l = 0; l < 3; l++) {
+					orders_comp<S>(str, k,
+								   static_cast<digest::MinimizedHashType>(l));
+				}
+				orders_comp<W>(str, k, digest::MinimizedHashType::CANON);
+			}
+		}
+	}
+
+	SECTION("Other data structures, and k known at compile time") {
+		for (auto &str : strs) {
+			std::vector<uint32_t> vec1, vec2, vec3, vec4;
+			digest::WindowMin<S, digest::ds::Adaptive, 0, Dec>(str, 15, 11)
+				.roll_minimizer(1e7, vec1);
+			digest::WindowMin<S, digest::ds::MonoQueue<>, 0, Dec>(str, 15, 11)
+				.roll_minimizer(1e7, vec2);
+			digest::WindowMin<S, digest::ds::SegmentTree<>, 0, Dec>(str, 15,
+																   11)
+				.roll_minimizer(1e7, vec3);
+			digest::WindowMin<S, digest::ds::Adaptive, 15, Dec>(str, 15, 11)
+				.roll_minimizer(1e7, vec4);
+			CHECK(vec1 == vec2);
+			CHECK(vec1 == vec3);
+			CHECK(vec1 == vec4);
+		}
+	}
+
+	SECTION("Rolling in pieces, append_seq() and new_seq()") {
+		for (size_t i = 0; i + 1 < strs.size(); i++) {
+			std::string whole = strs[i] + strs[i + 1];
+			digest::WindowMin<S, digest::ds::Adaptive, 0, Mini> ref1(whole, 15,
+																	 8);
+			digest::Syncmer<S, digest::ds::Adaptive, 0, Dec> ref2(whole, 15, 8);
+			std::vector<uint64_t> vec1, vec2, vec3, vec4;
+			ref1.roll_minimizer(1e7, vec1);
+			ref2.roll_minimizer(1e7, vec3);
+
+			digest::WindowMin<S, digest::ds::Adaptive, 0, Mini> dig1(strs[i],
+																	 15, 8);
+			digest::Syncmer<S, digest::ds::Adaptive, 0, Dec> dig2(strs[i], 15,
+																  8);
+			while (dig1.get_is_valid_hash()) {
+				dig1.roll_minimizer(3, vec2);
+			}
+			while (dig2.get_is_valid_hash()) {
+				dig2.roll_minimizer(3, vec4);
+			}
+			dig1.append_seq(strs[i + 1]);
+			dig1.roll_minimizer(1e7, vec2);
+			dig2.append_seq(strs[i + 1]);
+			dig2.roll_minimizer(1e7, vec4);
+			CHECK(vec1 == vec2);
+			CHECK(vec3 == vec4);
+
+			// the orders start over, the large window is the same as in ref
+			ref1.new_seq(whole, 0);
+			ref2.new_seq(whole, 0);
+			dig1.new_seq(whole, 0);
+			dig2.new_seq(whole, 0);
+			vec1.clear();
+			vec2.clear();
+			vec3.clear();
+			vec4.clear();
+			ref1.roll_minimizer(1e7, vec1);
+			ref2.roll_minimizer(1e7, vec3);
+			dig1.roll_minimizer(1e7, vec2);
+			dig2.roll_minimizer(1e7, vec4);
+			CHECK(vec1 == vec2);
+			CHECK(vec3 == vec4);
+		}
+	}
+
+	SECTION("Packed sequences") {
+		for (auto &str : strs) {
+			std::vector<uint8_t> packed;
+			digest::NIntervals n_intervals;
+			digest::pack_bases(str.c_str(), str.size(), packed, n_intervals);
+			digest::WindowMin<S, digest::ds::Adaptive, 0, Mini> dig1(str, 21,
+																	 10);
+			digest::WindowMin<S, digest::ds::Adaptive, 0, Mini> dig2(
+				packed.data(), str.size(), n_intervals, 21, 10);
+			std::vector<uint32_t> vec1, vec2;
+			dig1.roll_minimizer(1e7, vec1);
+			dig2.roll_minimizer(1e7, vec2);
+			CHECK(vec1 == vec2);
+		}
+	}
+
+	SECTION("Density") {
+		// both orders pick fewer k-mers of random bases than ordering them by
+		// hash, which has a density close to 2 / (w + 1)
+		std::mt19937 gen(13);
+		std::string str;
+		for (int i = 0; i < 200000; i++) {
+			str.push_back("ACGT"[gen() % 4]);
+		}
+		std::vector<uint32_t> wind, mini, dec;
+		digest::WindowMin<S, digest::ds::Adaptive>(str, 15, 10)
+			.roll_minimizer(1e7, wind);
+		digest::WindowMin<S, digest::ds::Adaptive, 0, Mini>(str, 15, 10)
+			.roll_minimizer(1e7, mini);
+		digest::WindowMin<S, digest::ds::Adaptive, 0, Dec>(str, 15, 10)
+			.roll_minimizer(1e7, dec);
+		double kmers = str.size() - 15 + 1;
+		CHECK(wind.size() / kmers > 0.17);
+		CHECK(mini.size() / kmers < 0.17);
+		CHECK(dec.size() / kmers < 0.17);
+	}
+}
+
+// compares a Strobemer to picking the strobes of every k-mer by brute force,
+// H is the type the ds of minstrobes compares the hashes in
+template <digest::BadCharPolicy P, class H = uint32_t, class D>
+void strobe_comp(D &dig, const std::string &str, unsigned k, unsigned order,
+				 unsigned w_min, unsigned w_max, digest::StrobeType type,
+				 digest::MinimizedHashType minimized_h) {
+	auto rotl = [](uint64_t x, unsigned r) {
+		return x << r | x >> (64 - r);
+	};
+	std::map<size_t, uint64_t> kmers = hashes_by_pos<P>(str, k, minimized_h);
+	std::vector<digest::Strobes> expected, vec;
+	for (auto &kmer : kmers) {
+		size_t i = kmer.first;
+		// only strobemers without a skipped character
+		bool consecutive = true;
+		for (size_t j = i; j <= i + (order - 1) * w_max; j++) {
+			consecutive = consecutive and kmers.count(j);
+		}
+		if (!consecutive) {
+			continue;
+		}
+		digest::Strobes s;
+		s.pos = {i, 0, 0};
+		uint64_t base = kmer.second;
+		for (unsigned n = 1; n < order; n++) {
+			size_t first = i + (n - 1) * w_max + w_min;
+			size_t best = first;
+			for (size_t j = first + 1; j <= i + n * w_max; j++) {
+				// ties go to the rightmost k-mer
+				if (type == digest::StrobeType::MINSTROBE) {
+					if ((H)kmers.at(j) <= (H)kmers.at(best)) {
+						best = j;
+					}
+				} else if ((base ^ kmers.at(j)) <= (base ^ kmers.at(best))) {
+					best = j;
+				}
+			}
+			s.pos[n] = best;
+			base ^= kmers.at(best);
+		}
+		s.hash = kmers.at(i) ^ rotl(kmers.at(s.pos[1]), 21);
+		if (order == 3) {
+			s.hash ^= rotl(kmers.at(s.pos[2]), 42);
+		}
+		expected.push_back(s);
+	}
+	dig.roll_minimizer(1e7, vec);
+	CHECK(vec == expected);
+}
+
+TEST_CASE("Strobemer Testing") {
+	setupStrings();
+	const digest::BadCharPolicy S = digest::BadCharPolicy::SKIPOVER;
+	const digest::BadCharPolicy W = digest::BadCharPolicy::WRITEOVER;
+	const digest::StrobeType MIN = digest::StrobeType::MINSTROBE;
+	const digest::StrobeType RAND = digest::StrobeType::RANDSTROBE;
+	std::vector<std::string> strs(test_strs);
+	strs.push_back(with_n_runs(11));
+
+	SECTION("Against brute force") {
+		for (auto &str : strs) {
+			for (unsigned k : {4u, 15u, 20u}) {
+				for (unsigned order : {2u, 3u}) {
+					for (auto w : {std::make_pair(1u, 1u),
+								   std::make_pair(2u, 12u),
+								   std::make_pair(7u, 7u)}) {
+						for (auto type : {MIN, RAND}) {
+							for (int l = 0; l < 3; l++) {
+								auto minimized_h =
+									static_cast<digest::MinimizedHashType>(l);
+								digest::Strobemer<S> dig(str, k, order,
+														 w.first, w.second,
+														 type, 0, minimized_h);
+								strobe_comp<S>(dig, str, k, order, w.first,
+											   w.second, type, minimized_h);
+							}
+							digest::Strobemer<W> dig(str, k, order, w.first,
+													 w.second, type);
+							strobe_comp<W>(dig, str, k, order, w.first,
+										   w.second, type,
+										   digest::MinimizedHashType::CANON);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	SECTION("Other data structures, and k known at compile time") {
+		for (auto &str : strs) {
+			for (unsigned order : {2u, 3u}) {
+				std::vector<digest::Strobes> vec1, vec2, vec3, vec4;
+				digest::Strobemer<S>(str, 16, order, 3, 10, MIN)
+					.roll_minimizer(1e7, vec1);
+				digest::Strobemer<S, digest::ds::MonoQueue<>>(str, 16, order, 3,
+															  10, MIN)
+					.roll_minimizer(1e7, vec2);
+				digest::Strobemer<S, digest::ds::Naive<8>>(str, 16, order, 3,
+														   10, MIN)
+					.roll_minimizer(1e7, vec3);
+				digest::Strobemer<S, digest::ds::Adaptive, 16>(str, 16, order,
+															   3, 10, MIN)
+					.roll_minimizer(1e7, vec4);
+				CHECK(vec1 == vec2);
+				CHECK(vec1 == vec3);
+				CHECK(vec1 == vec4);
+
+				// the 64-bit data structures compare the whole hashes
+				digest::Strobemer<S, digest::ds::MonoQueue64<>> dig(
+					str, 16, order, 3, 10, MIN);
+				strobe_comp<S, uint64_t>(dig, str, 16, order, 3, 10, MIN,
+										 digest::MinimizedHashType::CANON);
+			}
+		}
+	}
+
+	SECTION("Positions and hashes") {
+		for (auto &str : strs) {
+			std::vector<digest::Strobes> strobes;
+			std::vector<std::pair<uint64_t, uint64_t>> vec1, vec2;
+			std::vector<std::pair<uint32_t, uint32_t>> vec3;
+			digest::Strobemer<S>(str, 15, 3, 4, 9).roll_minimizer(1e7, strobes);
+			digest::Strobemer<S>(str, 15, 3, 4, 9).roll_minimizer(1e7, vec2);
+			digest::Strobemer<S>(str, 15, 3, 4, 9).roll_minimizer(1e7, vec3);
+			for (auto &s : strobes) {
+				vec1.emplace_back(s.pos[0], s.hash);
+			}
+			CHECK(vec1 == vec2);
+			REQUIRE(vec2.size() == vec3.size());
+			for (size_t i = 0; i < vec2.size(); i++) {
+				CHECK(vec3[i].first == vec2[i].first);
+				CHECK(vec3[i].second == (uint32_t)vec2[i].second);
+			}
+		}
+	}
+
+	SECTION("Rolling in pieces, append_seq() and new_seq()") {
+		for (size_t i = 0; i + 1 < strs.size(); i++) {
+			std::string whole = strs[i] + strs[i + 1];
+			for (auto type : {MIN, RAND}) {
+				digest::Strobemer<S> ref(whole, 15, 3, 2, 8, type);
+				std::vector<digest::Strobes> vec1, vec2;
+				ref.roll_minimizer(1e7, vec1);
+
+				digest::Strobemer<S> dig(strs[i], 15, 3, 2, 8, type);
+				while (dig.get_is_valid_hash()) {
+					dig.roll_minimizer(3, vec2);
+				}
+				dig.append_seq(strs[i + 1]);
+				dig.roll_minimizer(1e7, vec2);
+				CHECK(vec1 == vec2);
+
+				dig.new_seq(whole, 0);
+				vec2.clear();
+				dig.roll_minimizer(1e7, vec2);
+				CHECK(vec1 == vec2);
+			}
+		}
+	}
+
+	SECTION("Packed sequences") {
+		for (auto &str : strs) {
+			std::vector<uint8_t> packed;
+			digest::NIntervals n_intervals;
+			digest::pack_bases(str.c_str(), str.size(), packed, n_intervals);
+			digest::Strobemer<S> dig1(str, 16, 2, 5, 11);
+			digest::Strobemer<S> dig2(packed.data(), str.size(), n_intervals,
+									  16, 2, 5, 11);
+			std::vector<digest::Strobes> vec1, vec2;
+			dig1.roll_minimizer(1e7, vec1);
+			dig2.roll_minimizer(1e7, vec2);
+			CHECK(vec1 == vec2);
+		}
+	}
+
+	CHECK_THROWS_AS(digest::Strobemer<S>(test_strs[0], 8, 4, 2, 8),
+					digest::BadStrobeException);
+	CHECK_THROWS_AS(digest::Strobemer<S>(test_strs[0], 8, 2, 0, 8),
+					digest::BadStrobeException);
+	CHECK_THROWS_AS(digest::Strobemer<S>(test_strs[0], 8, 3, 9, 8),
+					digest::BadStrobeException);
+}
+
+TEST_CASE("Fast Mod Testing") {
+	setupStrings();
+	const digest::BadCharPolicy S = digest::BadCharPolicy::SKIPOVER;
+	// powers of two, which are masked, and divisors close to them
+	std::vector<uint32_t> divisors = {
+		1,		 2,		   3,		   7,		   16,
+		17,		 1000,	   1024,	   65535,	   65536,
+		1000003, 1u << 31, 2147483647, 4294967294, 4294967295};
+
+	SECTION("Against the % operator") {
+		std::mt19937 gen(29);
+		std::vector<uint32_t> xs = {0, 1, 2, 65535, 65536, 4294967294,
+									4294967295};
+		for (int i = 0; i < 2000; i++) {
+			xs.push_back(gen());
+		}
+		for (int i = 0; i < 100; i++) {
+			divisors.push_back(gen() | 1);
+			divisors.push_back(gen() % 1000 + 1);
+		}
+		for (uint32_t d : divisors) {
+			digest::FastMod fast_mod(d);
+			CHECK(fast_mod.divisor() == d);
+			for (uint32_t x : xs) {
+				// around the multiples of d, where rounding errors would show
+				uint32_t q = x / d;
+				uint64_t near = (uint64_t)q * d;
+				for (uint64_t y : {(uint64_t)x, near, near - 1, near + d - 1}) {
+					if (y <= UINT32_MAX) {
+						CHECK(fast_mod((uint32_t)y) == (uint32_t)y % d);
+					}
+				}
+			}
+		}
+	}
+
+	SECTION("ModMin with any mod") {
+		for (auto &str : test_strs) {
+			std::map<size_t, uint64_t> kmers =
+				hashes_by_pos<S>(str, 15, digest::MinimizedHashType::CANON);
+			for (uint32_t d : divisors) {
+				uint32_t congruence = d / 3;
+				std::vector<std::pair<uint64_t, uint64_t>> expected, vec;
+				for (auto &kmer : kmers) {
+					if ((uint32_t)kmer.second % d == congruence) {
+						expected.emplace_back(kmer.first, kmer.second);
+					}
+				}
+				digest::ModMin<S>(str, 15, d, congruence)
+					.roll_minimizer(1e7, vec);
+				CHECK(vec == expected);
+
+				std::vector<std::pair<uint32_t, uint32_t>> vec32;
+				digest::ModMin<S>(str, 15, d, congruence)
+					.roll_minimizer(1e7, vec32);
+				REQUIRE(vec32.size() == expected.size());
+				for (size_t i = 0; i < vec32.size(); i++) {
+					CHECK(vec32[i].first == expected[i].first);
+				}
+			}
+		}
+	}
+}
+
+// compares a kernel of select_congruent(), with and without the hashes, to
+// filtering with the % operator, on n hashes of which many pass
+template <class Kernel>
+void select_congruent_comp(Kernel with_hashes, Kernel without_hashes,
+						   size_t n, uint32_t d, uint32_t c) {
+	std::mt19937_64 gen(n + d);
+	std::vector<uint64_t> hashes(n), out_hash(n);
+	std::vector<uint32_t> positions(n), out_pos(n), out_pos2(n);
+	std::vector<uint32_t> expected_pos;
+	std::vector<uint64_t> expected_hash;
+	for (size_t i = 0; i < n; i++) {
+		hashes[i] = gen() % 4 ? gen() : gen() / d * d + c;
+		positions[i] = gen();
+		if ((uint32_t)hashes[i] % d == c) {
+			expected_pos.push_back(positions[i]);
+			expected_hash.push_back(hashes[i]);
+		}
+	}
+	digest::CongruenceTest test(d, c);
+	size_t m = with_hashes(hashes.data(), positions.data(), n, test,
+						   out_pos.data(), out_hash.data());
+	REQUIRE(m == expected_pos.size());
+	out_pos.resize(m);
+	out_hash.resize(m);
+	CHECK(out_pos == expected_pos);
+	CHECK(out_hash == expected_hash);
+
+	m = without_hashes(hashes.data(), positions.data(), n, test,
+					   out_pos2.data(), nullptr);
+	REQUIRE(m == expected_pos.size());
+	out_pos2.resize(m);
+	CHECK(out_pos2 == expected_pos);
+}
+
+TEST_CASE("Block Mod Minimizer Testing") {
+	setupStrings();
+	const digest::BadCharPolicy S = digest::BadCharPolicy::SKIPOVER;
+	const digest::BadCharPolicy W = digest::BadCharPolicy::WRITEOVER;
+	uint32_t mods[] = {1, 2, 7, 16, 17, 1000003, 1u << 31, 4294967295};
+
+	SECTION("Kernels match the % operator") {
+		for (size_t n : {0, 1, 7, 8, 15, 16, 17, 33, 100, 5000}) {
+			for (uint32_t d : mods) {
+				for (uint32_t c : {0u, d / 2, d - 1}) {
+					select_congruent_comp(
+						digest::select_congruent_scalar<true>,
+						digest::select_congruent_scalar<false>, n, d, c);
+					if (__builtin_cpu_supports("avx2")) {
+						select_congruent_comp(
+							digest::select_congruent_avx2<true>,
+							digest::select_congruent_avx2<false>, n, d, c);
+					}
+					if (__builtin_cpu_supports("avx512f")) {
+						select_congruent_comp(
+							digest::select_congruent_avx512<true>,
+							digest::select_congruent_avx512<false>, n, d, c);
+					}
+				}
+			}
+		}
+	}
+
+	SECTION("Output matches ModMin") {
+		for (uint i = 0; i < test_strs.size(); i++) {
+			for (int j = 0; j < 8; j += 3) {
+				for (uint32_t mod : mods) {
+					uint32_t congruence = mod / 3;
+					for (int l = 0; l < 3; l++) {
+						digest::MinimizedHashType minimized_h =
+							static_cast<digest::MinimizedHashType>(l);
+						block_comp(digest::BlockModMin<S>(test_strs[i], ks[j],
+														  mod, congruence, 0,
+														  minimized_h),
+								   digest::ModMin<S>(test_strs[i], ks[j], mod,
+													 congruence, 0,
+													 minimized_h),
+								   true);
+						block_comp(digest::BlockModMin<W>(test_strs[i], ks[j],
+														  mod, congruence, 0,
+														  minimized_h),
+								   digest::ModMin<W>(test_strs[i], ks[j], mod,
+													 congruence, 0,
+													 minimized_h),
+								   true);
+					}
+					sink_comp(digest::BlockModMin<S>(test_strs[i], ks[j], mod,
+													 congruence));
+				}
+			}
+		}
+	}
+
+	SECTION("Appended sequences and new_seq") {
+		for (uint i = 0; i + 1 < test_strs.size(); i++) {
+			digest::BlockModMin<S> dig(test_strs[i], 16, 17, 3);
+			digest::ModMin<S> ref(test_strs[i], 16, 17, 3);
+			std::vector<uint64_t> vec1, vec2;
+			dig.roll_minimizer(1e6, vec1);
+			ref.roll_minimizer(1e6, vec2);
+			dig.append_seq(test_strs[i + 1]);
+			ref.append_seq(test_strs[i + 1]);
+			dig.roll_minimizer(1e6, vec1);
+			ref.roll_minimizer(1e6, vec2);
+			CHECK(vec1 == vec2);
+
+			dig.new_seq(test_strs[i + 1], 0);
+			digest::ModMin<S> fresh(test_strs[i + 1], 16, 17, 3);
+			vec1.clear(), vec2.clear();
+			dig.roll_minimizer(1e6, vec1);
+			fresh.roll_minimizer(1e6, vec2);
+			CHECK(vec1 == vec2);
+		}
+	}
+
+	SECTION("Sequences of several blocks") {
+		std::string str;
+		for (int i = 0; i < 5; i++) {
+			str += with_n_runs(i);
+		}
+		REQUIRE(str.size() > 3 * digest::BlockModMin<S>::BLOCK);
+		std::vector<std::pair<uint64_t, uint64_t>> vec1, vec2;
+		digest::BlockModMin<S>(str, 16, 5, 1).roll_minimizer(1e6, vec1);
+		digest::ModMin<S>(str, 16, 5, 1).roll_minimizer(1e6, vec2);
+		CHECK(vec1 == vec2);
+		block_comp(digest::BlockModMin<W>(str, 16, 5, 1),
+				   digest::ModMin<W>(str, 16, 5, 1), true);
+	}
+
+	SECTION("Amount counts what the vector already holds") {
+		for (uint i = 0; i < test_strs.size(); i++) {
+			for (uint32_t mod : {2u, 17u}) {
+				mod_amount_comp(digest::BlockModMin<S>(test_strs[i], 16, mod),
+								digest::ModMin<S>(test_strs[i], 16, mod));
+			}
+			// unlike ModMin, nothing is rolled into a full vector
+			digest::BlockModMin<S> dig(test_strs[i], 16, 2);
+			std::vector<uint32_t> vec1(5);
+			std::vector<uint64_t> vec2(5);
+			dig.roll_minimizer(3, vec1);
+			dig.roll_minimizer(3, vec2);
+			CHECK(vec1.size() == 5);
+			CHECK(vec2.size() == 5);
+		}
+	}
+
+	SECTION("Positions past 2^32") {
+		for (size_t shift : {(1ull << 32) - 7, 5ull << 32}) {
+			for (int i = 2; i < 6; i++) {
+				wide_comp(Shifted<digest::BlockModMin<S>>(test_strs[i], 16, 17),
+						  shift);
+			}
+		}
+	}
+
+	CHECK_THROWS_AS(digest::BlockModMin<S>(test_strs[0], 4, 17, 17),
+					digest::BadModException);
+}
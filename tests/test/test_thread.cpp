@@ -1,4 +1,5 @@
 #include "digest/thread_out.hpp"
+#include <algorithm>
 #include <catch2/catch_test_macros.hpp>
 #include <cstdint>
 #include <fstream>
@@ -38,6 +39,12 @@ std::vector<T> multi_to_single_vec(std::vector<std::vector<T>> vec) {
 	return ret_vec;
 }
 
+// sink used to check the thread functions that take sinks
+struct PushBack {
+	std::vector<uint32_t> *out;
+	void operator()(uint32_t pos) { out->push_back(pos); }
+};
+
 void test_thread_mod(unsigned thread_count, std::string str, unsigned k,
 					 uint64_t mod, uint64_t congruence, size_t start,
 					 digest::MinimizedHashType minimized_h) {
@@ -54,6 +61,22 @@ void test_thread_mod(unsigned thread_count, std::string str, unsigned k,
 	for (size_t i = 0; i < single_thread.size(); i++) {
 		CHECK(single_thread[i] == multi_thread[i]);
 	}
+
+	std::vector<std::vector<uint32_t>> sink_vec(thread_count);
+	std::vector<PushBack> sinks;
+	for (unsigned i = 0; i < thread_count; i++) {
+		sinks.push_back(PushBack{&sink_vec[i]});
+	}
+	digest::thread_out::thread_mod<digest::BadCharPolicy::SKIPOVER>(
+		thread_count, sinks, str, k, mod, congruence, start, minimized_h);
+	CHECK(multi_to_single_vec(sink_vec) == single_thread);
+
+	std::vector<std::vector<uint64_t>> vec64;
+	digest::thread_out::thread_mod<digest::BadCharPolicy::SKIPOVER>(
+		thread_count, vec64, str, k, mod, congruence, start, minimized_h);
+	std::vector<uint64_t> multi_thread64 = multi_to_single_vec(vec64);
+	CHECK(std::equal(multi_thread64.begin(), multi_thread64.end(),
+					 single_thread.begin(), single_thread.end()));
 }
 
 void test_thread_wind(unsigned thread_count, std::string str, unsigned k,
@@ -73,6 +96,24 @@ void test_thread_wind(unsigned thread_count, std::string str, unsigned k,
 	for (size_t i = 0; i < single_thread.size(); i++) {
 		CHECK(single_thread[i] == multi_thread[i]);
 	}
+
+	std::vector<std::vector<uint32_t>> sink_vec(thread_count);
+	std::vector<PushBack> sinks;
+	for (unsigned i = 0; i < thread_count; i++) {
+		sinks.push_back(PushBack{&sink_vec[i]});
+	}
+	digest::thread_out::thread_wind<digest::BadCharPolicy::SKIPOVER,
+									digest::ds::Adaptive>(
+		thread_count, sinks, str, k, large_wind_kmer_am, start, minimized_h);
+	CHECK(multi_to_single_vec(sink_vec) == single_thread);
+
+	std::vector<std::vector<uint64_t>> vec64;
+	digest::thread_out::thread_wind<digest::BadCharPolicy::SKIPOVER,
+									digest::ds::Adaptive>(
+		thread_count, vec64, str, k, large_wind_kmer_am, start, minimized_h);
+	std::vector<uint64_t> multi_thread64 = multi_to_single_vec(vec64);
+	CHECK(std::equal(multi_thread64.begin(), multi_thread64.end(),
+					 single_thread.begin(), single_thread.end()));
 }
 
 void test_thread_sync(unsigned thread_count, std::string str, unsigned k,
@@ -92,6 +133,81 @@ void test_thread_sync(unsigned thread_count, std::string str, unsigned k,
 	for (size_t i = 0; i < single_thread.size(); i++) {
 		CHECK(single_thread[i] == multi_thread[i]);
 	}
+
+	std::vector<std::vector<uint32_t>> sink_vec(thread_count);
+	std::vector<PushBack> sinks;
+	for (unsigned i = 0; i < thread_count; i++) {
+		sinks.push_back(PushBack{&sink_vec[i]});
+	}
+	digest::thread_out::thread_sync<digest::BadCharPolicy::SKIPOVER,
+									digest::ds::Adaptive>(
+		thread_count, sinks, str, k, large_wind_kmer_am, start, minimized_h);
+	CHECK(multi_to_single_vec(sink_vec) == single_thread);
+
+	std::vector<std::vector<uint64_t>> vec64;
+	digest::thread_out::thread_sync<digest::BadCharPolicy::SKIPOVER,
+									digest::ds::Adaptive>(
+		thread_count, vec64, str, k, large_wind_kmer_am, start, minimized_h);
+	std::vector<uint64_t> multi_thread64 = multi_to_single_vec(vec64);
+	CHECK(std::equal(multi_thread64.begin(), multi_thread64.end(),
+					 single_thread.begin(), single_thread.end()));
+}
+
+void test_thread_modmin(unsigned thread_count, std::string str, unsigned k,
+						unsigned large_wind_kmer_am, size_t start,
+						digest::MinimizedHashType minimized_h) {
+	std::vector<uint32_t> single_thread;
+	std::vector<std::vector<uint32_t>> vec;
+	digest::ModMinimizer<digest::BadCharPolicy::SKIPOVER, digest::ds::Adaptive>
+		dig(str, k, large_wind_kmer_am, start, minimized_h);
+	dig.roll_minimizer(str.size(), single_thread);
+	digest::thread_out::thread_modmin<digest::BadCharPolicy::SKIPOVER,
+									  digest::ds::Adaptive>(
+		thread_count, vec, str, k, large_wind_kmer_am, start, minimized_h);
+	CHECK(multi_to_single_vec(vec) == single_thread);
+
+	std::vector<std::vector<uint32_t>> sink_vec(thread_count);
+	std::vector<PushBack> sinks;
+	for (unsigned i = 0; i < thread_count; i++) {
+		sinks.push_back(PushBack{&sink_vec[i]});
+	}
+	digest::thread_out::thread_modmin<digest::BadCharPolicy::SKIPOVER,
+									  digest::ds::Adaptive>(
+		thread_count, sinks, str, k, large_wind_kmer_am, start, minimized_h);
+	CHECK(multi_to_single_vec(sink_vec) == single_thread);
+}
+
+// sink of the strobemers with the positions of all of their strobes
+struct PushStrobes {
+	std::vector<digest::Strobes> *out;
+	void operator()(const digest::Strobes &s) { out->push_back(s); }
+};
+
+void test_thread_strobe(unsigned thread_count, std::string str, unsigned k,
+						unsigned order, unsigned w_min, unsigned w_max,
+						digest::StrobeType type, size_t start,
+						digest::MinimizedHashType minimized_h) {
+	std::vector<digest::Strobes> single_thread;
+	std::vector<std::vector<digest::Strobes>> vec;
+	digest::Strobemer<digest::BadCharPolicy::SKIPOVER, digest::ds::Adaptive>
+		dig(str, k, order, w_min, w_max, type, start, minimized_h);
+	dig.roll_minimizer(str.size(), single_thread);
+	digest::thread_out::thread_strobe<digest::BadCharPolicy::SKIPOVER,
+									  digest::ds::Adaptive>(
+		thread_count, vec, str, k, order, w_min, w_max, type, start,
+		minimized_h);
+	CHECK(multi_to_single_vec(vec) == single_thread);
+
+	std::vector<std::vector<digest::Strobes>> sink_vec(thread_count);
+	std::vector<PushStrobes> sinks;
+	for (unsigned i = 0; i < thread_count; i++) {
+		sinks.push_back(PushStrobes{&sink_vec[i]});
+	}
+	digest::thread_out::thread_strobe<digest::BadCharPolicy::SKIPOVER,
+									  digest::ds::Adaptive>(
+		thread_count, sinks, str, k, order, w_min, w_max, type, start,
+		minimized_h);
+	CHECK(multi_to_single_vec(sink_vec) == single_thread);
 }
 
 TEST_CASE("thread_mod function testing") {
@@ -365,3 +481,93 @@ TEST_CASE("thread_sync function testing") {
 		}
 	}
 }
+
+TEST_CASE("thread_modmin function testing") {
+	setupStrings();
+	// t is 4 + (15 - 4) % 8 = 7, so the minimal t-mers are not the k-mers
+	unsigned k = 15;
+	const uint32_t large_wind_kmer_am = 8;
+	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON;
+
+	SECTION("Special Cases") {
+		for (int i = 0; i < 4; i += 2) {
+			std::string str = test_strs[i].substr(0, 99);
+			// only 1 thread, each thread gets 1 lwind, and some threads get 2
+			for (unsigned thread_count : {1, 78, 50}) {
+				test_thread_modmin(thread_count, str, k, large_wind_kmer_am, 0,
+								   minimized_h);
+			}
+		}
+	}
+
+	SECTION("Full Testing") {
+		for (int i = 0; i < 4; i += 2) {
+			for (unsigned thread_count = 4; thread_count <= 64;
+				 thread_count += 4) {
+				for (size_t start = 0; start <= 96; start += 13) {
+					test_thread_modmin(thread_count, test_strs[i], k,
+									   large_wind_kmer_am, start,
+									   minimized_h);
+				}
+			}
+		}
+	}
+
+	std::string str = "ACTGACTGACTGACTGACTG";
+	std::vector<std::vector<uint32_t>> vec;
+	CHECK_THROWS_AS((digest::thread_out::thread_modmin<
+						digest::BadCharPolicy::SKIPOVER, digest::ds::Adaptive>(
+						8, vec, str, k, large_wind_kmer_am)),
+					digest::thread_out::BadThreadOutParams);
+}
+
+TEST_CASE("thread_strobe function testing") {
+	setupStrings();
+	unsigned k = 15;
+	digest::MinimizedHashType minimized_h = digest::MinimizedHashType::CANON;
+	const digest::StrobeType MIN = digest::StrobeType::MINSTROBE;
+	const digest::StrobeType RAND = digest::StrobeType::RANDSTROBE;
+
+	SECTION("Special Cases") {
+		for (int i = 0; i < 4; i += 2) {
+			// 20 order 3 strobemers of 15 + 2 * 10 bases
+			std::string str = test_strs[i].substr(0, 54);
+			// only 1 thread, each thread gets 1 strobemer, and some threads
+			// get 2
+			for (unsigned thread_count : {1, 20, 13}) {
+				for (auto type : {MIN, RAND}) {
+					test_thread_strobe(thread_count, str, k, 3, 2, 10, type, 0,
+									   minimized_h);
+				}
+			}
+		}
+	}
+
+	SECTION("Full Testing") {
+		for (int i = 0; i < 4; i += 2) {
+			for (unsigned thread_count = 4; thread_count <= 64;
+				 thread_count += 12) {
+				for (size_t start = 0; start <= 96; start += 19) {
+					for (unsigned order : {2, 3}) {
+						for (auto type : {MIN, RAND}) {
+							test_thread_strobe(thread_count, test_strs[i], k,
+											   order, 3, 12, type, start,
+											   minimized_h);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	std::string str = "ACTGACTGACTGACTGACTGACTG";
+	std::vector<std::vector<digest::Strobes>> vec;
+	CHECK_THROWS_AS((digest::thread_out::thread_strobe<
+						digest::BadCharPolicy::SKIPOVER, digest::ds::Adaptive>(
+						8, vec, str, k, 2, 2, 5)),
+					digest::thread_out::BadThreadOutParams);
+	CHECK_THROWS_AS((digest::thread_out::thread_strobe<
+						digest::BadCharPolicy::SKIPOVER, digest::ds::Adaptive>(
+						2, vec, str, k, 4, 2, 5)),
+					digest::BadStrobeException);
+}